@@ -0,0 +1,51 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "allocation_counter.h"
+
+/**
+ * Replaces the global operator new so benchmarks can report allocations per
+ * operation and tests can check code doesn't allocate. Only linked into
+ * pool-bench and pool-core-test.
+ */
+
+namespace {
+std::atomic<size_t> num_allocations(0);
+}  // namespace
+
+void *operator new(size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  // malloc(0) may return null, which operator new can't
+  void *memory = std::malloc(size == 0 ? 1 : size);
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept {
+  std::free(memory);
+}
+
+namespace pool {
+size_t GetAllocationCount() {
+  return num_allocations.load(std::memory_order_relaxed);
+}
+}  // namespace pool
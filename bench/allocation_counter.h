@@ -0,0 +1,11 @@
+#pragma once
+#include <cstddef>
+namespace pool {
+
+/**
+ * Get number of allocations made through operator new since the program
+ * started, counted by allocation_counter.cc.
+ * @return number of allocations.
+ */
+size_t GetAllocationCount();
+}  // namespace pool
@@ -0,0 +1,16 @@
+#include <cstdio>
+
+#include "benchmark.h"
+
+/**
+ * Runs every benchmark, or only the ones whose names contain the first
+ * argument, e.g. `pool-bench shot/` for the whole shot benchmarks. Build
+ * with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+ */
+int main(int argc, char **argv) {
+  const char *filter = argc > 1 ? argv[1] : "";
+  pool::RunPhysicsBenchmarks(filter);
+  std::printf("\n");
+  pool::RunCollisionBenchmarks(filter);
+  return 0;
+}
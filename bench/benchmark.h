@@ -0,0 +1,90 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+#include "allocation_counter.h"
+namespace pool {
+
+/**
+ * How long an operation took, from RunBenchmark.
+ */
+struct BenchmarkResult {
+  // median time of one operation over the runs
+  double ns_per_op;
+  // allocations made by one operation, averaged over every run
+  double allocs_per_op;
+  // operations in each run
+  size_t ops_per_run;
+};
+
+// runs that are timed, the median is reported so one slow run (another
+// process, a page fault) doesn't move the result
+constexpr size_t kBenchmarkRuns = 5;
+// each run repeats the operation until it takes at least this long
+constexpr double kMinRunSeconds = 0.05;
+
+/**
+ * Times an operation. One untimed run finds how many operations take
+ * kMinRunSeconds, then kBenchmarkRuns runs of that many operations are
+ * timed.
+ * @param op callable taking the operation's index (size_t), it has to set
+ * up anything it changes itself so every run does the same work.
+ * @return median time and allocations per operation.
+ */
+template <typename Op>
+BenchmarkResult RunBenchmark(Op op) {
+  size_t ops_per_run = 1;
+  while (true) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ops_per_run; i++) {
+      op(i);
+    }
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    if (seconds >= kMinRunSeconds) {
+      break;
+    }
+    ops_per_run *= 2;
+  }
+  std::vector<double> run_ns;
+  run_ns.reserve(kBenchmarkRuns);
+  size_t allocations_before = GetAllocationCount();
+  for (size_t run = 0; run < kBenchmarkRuns; run++) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ops_per_run; i++) {
+      op(i);
+    }
+    run_ns.push_back(std::chrono::duration<double, std::nano>(
+                         std::chrono::steady_clock::now() - start)
+                         .count());
+  }
+  size_t allocations = GetAllocationCount() - allocations_before;
+  std::sort(run_ns.begin(), run_ns.end());
+  BenchmarkResult result;
+  result.ns_per_op = run_ns[kBenchmarkRuns / 2] / ops_per_run;
+  result.allocs_per_op =
+      (double)allocations / (kBenchmarkRuns * ops_per_run);
+  result.ops_per_run = ops_per_run;
+  return result;
+}
+
+/**
+ * Runs the micro benchmarks of the single physics functions and the macro
+ * benchmarks of whole shots.
+ * @param filter only benchmarks with names containing it are run, empty
+ * for all.
+ */
+void RunPhysicsBenchmarks(const char *filter);
+
+/**
+ * Compares a plain touching pair loop against the double and float
+ * BallSystem kernels and times the computer player at each difficulty.
+ * @param filter only benchmarks with names containing it are run, empty
+ * for all.
+ */
+void RunCollisionBenchmarks(const char *filter);
+}  // namespace pool
@@ -0,0 +1,164 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "ball_system.h"
+#include "benchmark.h"
+#include "computer_player.h"
+using glm::dvec2;
+using pool::Ball;
+using pool::BallSystem;
+using pool::BasicBall;
+using pool::BasicBallSystem;
+using pool::Board;
+using pool::ComputerPlayer;
+using std::pair;
+using std::vector;
+
+/**
+ * Compares a plain all pairs loop finding touching balls against the
+ * BallSystem pair kernel, in double and in float, for different numbers of
+ * balls, then reports how many shots per second the computer player
+ * simulates from the break at each difficulty.
+ */
+
+namespace {
+constexpr size_t kRepetitions = 2000;
+
+/**
+ * Balls at random positions packed densely enough that some touch.
+ * @param num_balls number of balls to make.
+ * @return balls with random positions and velocities.
+ */
+vector<Ball> MakeRandomBalls(size_t num_balls) {
+  std::mt19937 generator(42);
+  double side = Ball::GetDiameter() * 2 * std::sqrt((double)num_balls);
+  std::uniform_real_distribution<double> position(0, side);
+  std::uniform_real_distribution<double> velocity(-5, 5);
+  vector<Ball> balls;
+  for (size_t i = 0; i < num_balls; i++) {
+    balls.push_back(Ball(i, Ball::solid,
+                         {position(generator), position(generator)},
+                         {velocity(generator), velocity(generator)}));
+  }
+  return balls;
+}
+
+double NanosecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+/**
+ * Times finding the touching pairs of the balls with a ball system.
+ * @param system to load the balls into.
+ * @param initial balls, loaded again every repetition.
+ * @param num_pairs set to the number of pairs found.
+ * @return nanoseconds all repetitions took.
+ */
+template <typename Scalar>
+double TimeBallSystem(BasicBallSystem<Scalar> &system,
+                      const vector<BasicBall<Scalar>> &initial,
+                      size_t &num_pairs) {
+  vector<pair<size_t, size_t>> pairs;
+  Scalar diameter = static_cast<Scalar>(Ball::GetDiameter());
+  auto start = std::chrono::steady_clock::now();
+  for (size_t repetition = 0; repetition < kRepetitions; repetition++) {
+    system.Load(initial);
+    system.FindTouchingPairs(pairs, diameter);
+  }
+  num_pairs = pairs.size();
+  return NanosecondsSince(start);
+}
+
+/**
+ * Times the pair loop over Ball against the BallSystem kernel.
+ */
+void ComparePairSearch() {
+  std::printf("instruction set: %s\n", BallSystem::GetInstructionSet());
+  std::printf("%6s %16s %16s %16s %10s %10s\n", "balls", "ball ns/pair",
+              "system ns/pair", "float ns/pair", "touching", "float");
+  size_t sizes[] = {16, 64, 256};
+  for (size_t num_balls : sizes) {
+    vector<Ball> initial = MakeRandomBalls(num_balls);
+    double num_pairs = num_balls * (num_balls - 1) / 2.0;
+    double diameter = Ball::GetDiameter();
+
+    // same squared distance test the kernel does, one pair at a time
+    vector<pair<size_t, size_t>> pairs;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t repetition = 0; repetition < kRepetitions; repetition++) {
+      pairs.clear();
+      for (size_t i = 0; i < initial.size(); i++) {
+        for (size_t j = i + 1; j < initial.size(); j++) {
+          dvec2 difference =
+              initial[j].GetPosition() - initial[i].GetPosition();
+          if (glm::dot(difference, difference) <= diameter * diameter) {
+            pairs.push_back(std::make_pair(i, j));
+          }
+        }
+      }
+    }
+    double ball_time = NanosecondsSince(start);
+
+    BallSystem system;
+    size_t num_touching = 0;
+    double system_time = TimeBallSystem(system, initial, num_touching);
+
+    // float lanes are twice as wide, the count shows if rounding changed
+    // which pairs touch
+    vector<BasicBall<float>> float_initial(initial.begin(), initial.end());
+    BasicBallSystem<float> float_system;
+    size_t num_float_touching = 0;
+    double float_time =
+        TimeBallSystem(float_system, float_initial, num_float_touching);
+
+    std::printf("%6zu %16.3f %16.3f %16.3f %10zu %10zu\n", num_balls,
+                ball_time / kRepetitions / num_pairs,
+                system_time / kRepetitions / num_pairs,
+                float_time / kRepetitions / num_pairs, num_touching,
+                num_float_touching);
+  }
+}
+
+/**
+ * Times choosing a shot from the break at each difficulty on one thread.
+ */
+void TimeComputerPlayer() {
+  Board board = Board(1000);
+  board.CreatePoolBalls();
+  std::printf("\n%10s %8s %14s %12s %10s\n", "difficulty", "threads",
+              "shots tried", "shots/s", "seconds");
+  ComputerPlayer::Difficulty difficulties[] = {
+      ComputerPlayer::easy, ComputerPlayer::medium, ComputerPlayer::hard};
+  const char *names[] = {"easy", "medium", "hard"};
+  for (size_t i = 0; i < 3; i++) {
+    ComputerPlayer::Settings settings =
+        ComputerPlayer::GetDifficultySettings(difficulties[i]);
+    size_t total_shots = settings.num_angles * settings.num_powers *
+                         settings.samples_per_shot;
+    auto start = std::chrono::steady_clock::now();
+    ComputerPlayer::Shot shot = ComputerPlayer(settings, 1).ChooseShot(board);
+    double seconds = NanosecondsSince(start) * 1e-9;
+    std::printf("%10s %8u %7zu/%-6zu %12.0f %10.3f\n", names[i],
+                std::thread::hardware_concurrency(), shot.shots_simulated,
+                total_shots, shot.shots_per_second, seconds);
+  }
+}
+}  // namespace
+
+namespace pool {
+void RunCollisionBenchmarks(const char *filter) {
+  if (std::strstr("pair search", filter) != nullptr) {
+    ComparePairSearch();
+  }
+  if (std::strstr("computer player", filter) != nullptr) {
+    TimeComputerPlayer();
+  }
+}
+}  // namespace pool
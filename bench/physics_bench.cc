@@ -0,0 +1,254 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "benchmark.h"
+#include "board.h"
+#include "board_state.h"
+using glm::dvec2;
+using pool::Ball;
+using pool::Board;
+using pool::BoardState;
+using pool::Player;
+using std::vector;
+
+/**
+ * Micro benchmarks of the functions every frame spends its time in and
+ * macro benchmarks of whole shots. Inputs come from fixed seeds so every run
+ * measures the same work.
+ */
+
+namespace {
+// inputs each micro benchmark cycles through, a power of two so the index
+// can be masked
+constexpr size_t kNumInputs = 1024;
+// frames run from the break before the board is put back, so frame
+// benchmarks measure the busy start of a shot
+constexpr size_t kFramesPerRestore = 64;
+// shots each random shot benchmark cycles through
+constexpr size_t kNumShots = 64;
+
+// results are added here so the compiler can't drop the work
+volatile double sink;
+
+bool Matches(const char *name, const char *filter) {
+  return std::strstr(name, filter) != nullptr;
+}
+
+/**
+ * Prints one benchmark's result.
+ * @param frames_per_op frames (or steps) one operation simulates, 0 if it
+ * isn't a simulation.
+ */
+void PrintResult(const char *name, const pool::BenchmarkResult &result,
+                 double frames_per_op) {
+  if (frames_per_op > 0) {
+    std::printf("%-44s %12.1f %10.2f %12.0f %10.1f\n", name, result.ns_per_op,
+                result.allocs_per_op, frames_per_op * 1e9 / result.ns_per_op,
+                frames_per_op);
+  } else {
+    std::printf("%-44s %12.1f %10.2f %12s %10s\n", name, result.ns_per_op,
+                result.allocs_per_op, "-", "-");
+  }
+}
+
+/**
+ * Pairs of balls that overlap and move towards each other.
+ */
+vector<Ball> MakeTouchingPairs(std::mt19937 &generator) {
+  std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+  std::uniform_real_distribution<double> speed(0.5, 10);
+  vector<Ball> balls;
+  for (size_t i = 0; i < kNumInputs; i++) {
+    double direction = angle(generator);
+    dvec2 offset = dvec2(std::cos(direction), std::sin(direction)) *
+                   (Ball::GetDiameter() - 0.5);
+    balls.push_back(Ball(1, Ball::solid, {500, 500},
+                         offset * 0.1 * speed(generator)));
+    balls.push_back(Ball(2, Ball::striped, dvec2(500, 500) + offset,
+                         -offset * 0.1 * speed(generator)));
+  }
+  return balls;
+}
+}  // namespace
+
+namespace pool {
+void RunPhysicsBenchmarks(const char *filter) {
+  // frames are frames of game time simulated, for event driven shots the
+  // number the same shot takes frame stepping
+  std::printf("%-44s %12s %10s %12s %10s\n", "benchmark", "ns/op", "allocs/op",
+              "frames/s", "frames/op");
+  // every input set has its own seed so running only some benchmarks
+  // doesn't change the inputs of the others
+  std::mt19937 pair_generator(42);
+  vector<Ball> touching = MakeTouchingPairs(pair_generator);
+  if (Matches("ball/collide touching pair", filter)) {
+    PrintResult("ball/collide touching pair", RunBenchmark([&](size_t i) {
+                  size_t index = (i & (kNumInputs - 1)) * 2;
+                  Ball first = touching[index];
+                  Ball second = touching[index + 1];
+                  Ball::HandlePoolBallsColliding(first, second);
+                  sink = first.GetVelocity().x + second.GetVelocity().x;
+                }),
+                0);
+  }
+  if (Matches("ball/collide distant pair", filter)) {
+    PrintResult("ball/collide distant pair", RunBenchmark([&](size_t i) {
+                  size_t index = (i & (kNumInputs - 1)) * 2;
+                  Ball first = touching[index];
+                  // second ball of the next pair is somewhere else
+                  Ball second = touching[(index + 3) % touching.size()];
+                  second.SetPosition(second.GetPosition() + dvec2(200, 0));
+                  Ball::HandlePoolBallsColliding(first, second);
+                  sink = first.GetVelocity().x + second.GetVelocity().x;
+                }),
+                0);
+  }
+  if (Matches("ball/decrease velocity", filter)) {
+    PrintResult("ball/decrease velocity", RunBenchmark([&](size_t i) {
+                  Ball ball = touching[(i & (kNumInputs - 1)) * 2];
+                  ball.DecreaseVelocity();
+                  sink = ball.GetVelocity().x;
+                }),
+                0);
+  }
+
+  Board board = Board(1000);
+  board.CreatePoolBalls();
+  if (Matches("board/check if in hole", filter)) {
+    // positions anywhere on the table, a few of them over holes
+    std::uniform_real_distribution<double> x(75, 900);
+    std::uniform_real_distribution<double> y(225, 750);
+    std::mt19937 generator(43);
+    vector<Ball> balls;
+    for (size_t i = 0; i < kNumInputs; i++) {
+      balls.push_back(
+          Ball(1, Ball::solid, {x(generator), y(generator)}, {0, 0}));
+    }
+    PrintResult("board/check if in hole", RunBenchmark([&](size_t i) {
+                  sink = board.CheckIfInHole(balls[i & (kNumInputs - 1)]);
+                }),
+                0);
+  }
+
+  // board just after the break shot
+  double break_angle = board.GetShotAngle();
+  BoardState start = board.Save();
+  board.HitCueBall(break_angle, Board::GetMaxShotPower());
+  BoardState break_hit = board.Save();
+  const char *frame_names[] = {"board/advance one frame brute force",
+                               "board/advance one frame uniform grid",
+                               "board/advance one frame simd all pairs",
+                               "board/advance one frame event driven"};
+  Board::BroadPhase broad_phases[] = {Board::brute_force, Board::uniform_grid,
+                                      Board::simd_all_pairs,
+                                      Board::brute_force};
+  for (size_t phase = 0; phase < 4; phase++) {
+    if (!Matches(frame_names[phase], filter)) {
+      continue;
+    }
+    board.SetBroadPhase(broad_phases[phase]);
+    board.SetSimulationMode(phase == 3 ? Board::event_driven
+                                       : Board::frame_stepping);
+    PrintResult(frame_names[phase], RunBenchmark([&](size_t i) {
+                  if (i % kFramesPerRestore == 0) {
+                    board.Restore(break_hit);
+                  }
+                  board.AdvanceOneFrame();
+                }),
+                1);
+  }
+  board.SetBroadPhase(Board::brute_force);
+
+  // runs a shot frame by frame until every ball stops, like the game does
+  auto play_until_rest = [&board](double angle, double power) {
+    board.HitCueBall(angle, power);
+    size_t frames = 0;
+    while (!board.GetStickVisibility() &&
+           board.GetPlayerState() == Player::playing) {
+      board.AdvanceOneFrame();
+      frames += 1;
+    }
+    return frames;
+  };
+
+  board.SetSimulationMode(Board::frame_stepping);
+  board.Restore(start);
+  double break_frames =
+      play_until_rest(break_angle, Board::GetMaxShotPower());
+  if (Matches("shot/break until rest frame stepping", filter)) {
+    PrintResult("shot/break until rest frame stepping",
+                RunBenchmark([&](size_t) {
+                  board.Restore(start);
+                  play_until_rest(break_angle, Board::GetMaxShotPower());
+                }),
+                break_frames);
+  }
+  board.SetSimulationMode(Board::event_driven);
+  if (Matches("shot/break until rest event driven", filter)) {
+    PrintResult("shot/break until rest event driven",
+                RunBenchmark([&](size_t) {
+                  board.Restore(start);
+                  board.HitCueBall(break_angle, Board::GetMaxShotPower());
+                  sink = board.SimulateUntilRest();
+                }),
+                break_frames);
+  }
+  // fixed point rounds differently, so the break can take other frames
+  board.SetSimulationMode(Board::fixed_point);
+  board.Restore(start);
+  double fixed_break_frames =
+      play_until_rest(break_angle, Board::GetMaxShotPower());
+  if (Matches("shot/break until rest fixed point", filter)) {
+    PrintResult("shot/break until rest fixed point",
+                RunBenchmark([&](size_t) {
+                  board.Restore(start);
+                  play_until_rest(break_angle, Board::GetMaxShotPower());
+                }),
+                fixed_break_frames);
+  }
+
+  // layout after the break with random shots from it
+  board.SetSimulationMode(Board::frame_stepping);
+  board.Restore(start);
+  play_until_rest(break_angle, Board::GetMaxShotPower());
+  if (board.IsCueInHole()) {
+    board.RepositionCueBall(board.GetPoolBalls()[0].GetPosition());
+  }
+  BoardState mid_game = board.Save();
+  std::mt19937 generator(44);
+  std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+  std::uniform_real_distribution<double> power(Board::GetMinShotPower(),
+                                               Board::GetMaxShotPower());
+  vector<dvec2> shots;
+  double shot_frames = 0;
+  for (size_t i = 0; i < kNumShots; i++) {
+    shots.push_back({angle(generator), power(generator)});
+    board.Restore(mid_game);
+    shot_frames += play_until_rest(shots[i].x, shots[i].y);
+  }
+  shot_frames /= kNumShots;
+  if (Matches("shot/random mid-game frame stepping", filter)) {
+    PrintResult("shot/random mid-game frame stepping",
+                RunBenchmark([&](size_t i) {
+                  board.Restore(mid_game);
+                  const dvec2 &shot = shots[i % kNumShots];
+                  play_until_rest(shot.x, shot.y);
+                }),
+                shot_frames);
+  }
+  // SimulateShot restores the scratch board from the saved board each shot
+  Board scratch = Board(1000);
+  board.Restore(mid_game);
+  if (Matches("shot/random mid-game simulate shot", filter)) {
+    PrintResult("shot/random mid-game simulate shot",
+                RunBenchmark([&](size_t i) {
+                  const dvec2 &shot = shots[i % kNumShots];
+                  sink = board.SimulateShot(shot.x, shot.y, scratch).num_events;
+                }),
+                shot_frames);
+  }
+}
+}  // namespace pool
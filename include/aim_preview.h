@@ -0,0 +1,120 @@
+#pragma once
+#include <vector>
+
+#include "board.h"
+namespace pool {
+using glm::dvec2;
+using pool::Ball;
+using pool::BallPool;
+using pool::BasicBoard;
+using std::vector;
+
+/**
+ * Works out where the cue ball will go for the current stick angle to draw
+ * the aim line: along a straight line, bouncing off the sides of the board,
+ * until it reaches the first ball, a hole or the end of the preview. Paths
+ * are found with ray against circle and ray against side tests instead of
+ * simulating the shot, and are only worked out again when the stick or the
+ * balls have changed since the last update.
+ * Friction is ignored so the path is straight between bounces.
+ */
+template <typename Spec>
+class BasicAimPreview {
+ public:
+  // board of the table the preview is for
+  typedef BasicBoard<Spec> Board;
+
+  /**
+   * Path the cue ball is expected to take. All positions are ball centers.
+   */
+  struct Path {
+    // where the cue ball starts, bounces off sides and ends
+    vector<dvec2> points;
+    // if the path ends touching another ball
+    bool hits_ball;
+    // number of the ball that is hit
+    size_t object_ball_number;
+    // cue ball position when it touches the ball that is hit, the last point
+    dvec2 ghost_position;
+    // unit direction the ball that is hit moves off in
+    dvec2 object_ball_direction;
+    // unit direction the cue ball moves off in after the hit, zero for a
+    // straight on hit
+    dvec2 cue_ball_direction;
+    // if the path ends in a hole
+    bool cue_pocketed;
+  };
+
+  /**
+   * Constructor for preview following the cue ball through up to
+   * kDefaultMaxBounces sides.
+   */
+  BasicAimPreview();
+
+  /**
+   * Constructor with the number of sides the path can bounce off.
+   * @param max_bounces sides bounced off before the path ends.
+   */
+  explicit BasicAimPreview(size_t max_bounces);
+
+  /**
+   * Works out the path for the board's stick and balls if either changed
+   * since the last call, otherwise keeps the last path.
+   * @param board with a cue ball to aim from.
+   * @return path, stays valid until the next call.
+   */
+  const Path &Update(const Board &board);
+
+  /**
+   * Get the path from the last Update.
+   * @return path of the cue ball.
+   */
+  const Path &GetPath() const;
+
+  /**
+   * Get how many times the path was worked out, used to check unchanged
+   * boards are not traced again.
+   * @return number of times the path was traced.
+   */
+  size_t GetTraceCount() const;
+
+  /**
+   * Get length of the path, it grows with the aim line as the stick is
+   * pulled back.
+   * @param board to get aim line length from.
+   * @return total length of the path.
+   */
+  static double GetPathLength(const Board &board);
+
+  // sides bounced off by the default constructor
+  constexpr static const size_t kDefaultMaxBounces = 2;
+
+ private:
+  /**
+   * Checks the board against what the last path was traced for and
+   * remembers it.
+   * @return true if the stick, aim line length, table or balls changed.
+   */
+  bool CheckChanged(const Board &board);
+
+  /**
+   * Works out the path from scratch.
+   */
+  void Trace(const Board &board);
+
+  size_t max_bounces_;
+  Path path_;
+  size_t trace_count_ = 0;
+  // what the path was traced for
+  bool traced_ = false;
+  double shot_angle_ = 0;
+  double path_length_ = 0;
+  dvec2 table_top_;
+  dvec2 table_bottom_;
+  vector<Ball> balls_;
+  // path length for each unit of aim line length
+  constexpr static const double kPathLengthScale = 3;
+};
+
+typedef BasicAimPreview<ClassicTable> AimPreview;
+}  // namespace pool
@@ -0,0 +1,125 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+namespace pool {
+using std::string;
+using std::vector;
+
+/**
+ * Loads assets (decoded images) by path on worker threads and keeps them so
+ * they are only ever loaded once. Preload starts loading a set of assets in
+ * parallel, Get hands out an asset, waiting for it if it is still loading.
+ * Preload and Get are called from one thread, the loader runs on the
+ * workers and has to be safe to call from several threads at once.
+ * @tparam Asset type of asset the loader makes.
+ */
+template <typename Asset>
+class AssetCache {
+ public:
+  typedef std::function<Asset(const string &path)> Loader;
+
+  /**
+   * Constructor for empty cache.
+   * @param loader makes the asset stored at a path.
+   * @param num_threads most workers loading at once, 0 for one per
+   * hardware thread.
+   */
+  explicit AssetCache(const Loader &loader, size_t num_threads = 0)
+      : loader_(loader), num_threads_(num_threads) {
+    if (num_threads_ == 0) {
+      num_threads_ = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+  }
+
+  AssetCache(const AssetCache &) = delete;
+  AssetCache &operator=(const AssetCache &) = delete;
+
+  /**
+   * Waits for the workers to finish loading.
+   */
+  ~AssetCache() {
+    for (std::thread &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /**
+   * Starts loading assets on worker threads, paths already cached or
+   * loading are skipped.
+   * @param paths of the assets.
+   */
+  void Preload(const vector<string> &paths) {
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+    for (const string &path : paths) {
+      if (assets_.count(path) > 0) {
+        continue;
+      }
+      std::packaged_task<Asset()> task([this, path]() {
+        return loader_(path);
+      });
+      assets_[path] = task.get_future().share();
+      batch->tasks.push_back(std::move(task));
+    }
+    size_t num_threads = std::min(num_threads_, batch->tasks.size());
+    for (size_t i = 0; i < num_threads; i++) {
+      workers_.push_back(std::thread(&AssetCache::RunTasks, batch));
+    }
+  }
+
+  /**
+   * Get an asset, waiting for it if it is being loaded and loading it on
+   * this thread if it was never preloaded.
+   * @param path of the asset.
+   * @return the asset, valid as long as the cache.
+   */
+  const Asset &Get(const string &path) {
+    auto found = assets_.find(path);
+    if (found == assets_.end()) {
+      std::promise<Asset> loaded;
+      loaded.set_value(loader_(path));
+      found = assets_.emplace(path, loaded.get_future().share()).first;
+    }
+    return found->second.get();
+  }
+
+  /**
+   * Checks if an asset is loaded or being loaded.
+   * @param path of the asset.
+   * @return true if Get won't call the loader.
+   */
+  bool IsCached(const string &path) const {
+    return assets_.count(path) > 0;
+  }
+
+ private:
+  /**
+   * Assets from one Preload, the workers take the next task until none are
+   * left.
+   */
+  struct Batch {
+    vector<std::packaged_task<Asset()>> tasks;
+    std::atomic<size_t> next_task{0};
+  };
+
+  static void RunTasks(std::shared_ptr<Batch> batch) {
+    for (size_t i = batch->next_task++; i < batch->tasks.size();
+         i = batch->next_task++) {
+      batch->tasks[i]();
+    }
+  }
+
+  Loader loader_;
+  size_t num_threads_;
+  // every asset loaded or loading, by path
+  std::map<string, std::shared_future<Asset>> assets_;
+  vector<std::thread> workers_;
+};
+}  // namespace pool
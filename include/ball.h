@@ -2,15 +2,22 @@
 // Created by neha konjeti on 4/16/21.
 //
 #pragma once
-#include "cinder/gl/gl.h"
+#include <glm/glm.hpp>
 namespace pool {
 using glm::dvec2;
 
 /**
  * Class to update velocities and positions of pool balls during game.
+ * Positions, velocities and the physics are in Scalar, float or double.
+ * Ball is the double ball the game is played with, a float ball has half
+ * the state for batches of simulations that can give up some accuracy.
  */
-class Ball {
+template <typename Scalar>
+class BasicBall {
  public:
+  // position or velocity of a ball
+  typedef glm::vec<2, Scalar> Vec2;
+
   /**
    * Enum for pool ball types.
    * Used for calculating points and determining if player hit correct balls
@@ -25,17 +32,27 @@ class Ball {
    * @param position of pool ball on board.
    * @param velocity of pool ball.
    */
-  Ball(size_t number, Type type, const dvec2& position, const dvec2& velocity);
+  BasicBall(size_t number, Type type, const Vec2& position,
+            const Vec2& velocity);
 
   /**
    * Empty constructor.
    */
-  Ball();
+  BasicBall();
 
   /**
-   * Method to draw pool ball.
+   * Converts a ball with another scalar type, rounding its position,
+   * velocity and velocity boost to Scalar.
+   * @param ball to convert.
    */
-  void Display(ci::gl::Texture2dRef image) const;
+  template <typename OtherScalar>
+  explicit BasicBall(const BasicBall<OtherScalar>& ball)
+      : number_(ball.GetBallNumber()),
+        position_(ball.GetPosition()),
+        velocity_(ball.GetVelocity()),
+        type_(static_cast<Type>(ball.GetBallType())),
+        velocity_boost_(static_cast<Scalar>(ball.GetVelocityBoost())) {
+  }
 
   /**
    * Method to update velocity of pool ball after collision with board.
@@ -46,8 +63,8 @@ class Ball {
    * @return if board collided with board (if contact with any of the
    * boundaries)
    */
-  bool HandleBoardCollision(double right_boundary, double left_boundary,
-                            double top_boundary, double bottom_boundary);
+  bool HandleBoardCollision(Scalar right_boundary, Scalar left_boundary,
+                            Scalar top_boundary, Scalar bottom_boundary);
 
   /**
    * Method to update velocities of pool balls if collision between them
@@ -56,7 +73,8 @@ class Ball {
    * @param ball_two other ball in collision.
    * @return bool if collision occurred between balls.
    */
-  static bool HandlePoolBallsColliding(Ball& ball_one, Ball& ball_two);
+  static bool HandlePoolBallsColliding(BasicBall& ball_one,
+                                       BasicBall& ball_two);
 
   /**
    * Getter for ball diameter (used for positioning stick)
@@ -75,13 +93,13 @@ class Ball {
    * Getter for position of pool ball.
    * @return current position of pool ball.
    */
-  dvec2 GetPosition() const;
+  Vec2 GetPosition() const;
 
   /**
    * Getter for velocity of pool ball.
    * @return current velocity of pool ball.
    */
-  dvec2 GetVelocity() const;
+  Vec2 GetVelocity() const;
 
   /**
    * Trigger velocity increase in cue ball from stick hitting the cue ball.
@@ -98,18 +116,55 @@ class Ball {
    */
   void DecreaseVelocity();
 
+  /**
+   * Closed form of Move and DecreaseVelocity over a span of time: each
+   * velocity component slows down at the friction deceleration until it
+   * reaches zero, so the position follows a parabola per axis.
+   * @param frames amount of time to move ball for, measured in frames.
+   */
+  void MoveFor(Scalar frames);
+
+  /**
+   * Get position the ball will be at after moving for given time without
+   * colliding with anything.
+   * @param frames amount of time measured in frames.
+   * @return position of pool ball after that time.
+   */
+  Vec2 GetPositionAfter(Scalar frames) const;
+
+  /**
+   * Get velocity the ball will have after moving for given time without
+   * colliding with anything.
+   * @param frames amount of time measured in frames.
+   * @return velocity of pool ball after that time.
+   */
+  Vec2 GetVelocityAfter(Scalar frames) const;
+
+  /**
+   * Get time until the velocity component on the given axis reaches zero.
+   * @param axis 0 for x, 1 for y.
+   * @return number of frames until that velocity component stops.
+   */
+  Scalar GetTimeUntilStopped(size_t axis) const;
+
+  /**
+   * Get amount velocity components are reduced by each frame from friction.
+   * @return deceleration of ball per frame.
+   */
+  static Scalar GetFrictionDeceleration();
+
   /**
    * Used to change position of ball when ball goes in hole.
    */
-  void SetPosition(dvec2 position);
+  void SetPosition(Vec2 position);
 
   /**
    * Get ball type for when it is hit into hole.
    * @return enum Ball type
    */
-  Ball::Type GetBallType() const;
+  Type GetBallType() const;
 
-  void SetVelocity(dvec2 velocity);
+  void SetVelocity(Vec2 velocity);
   /**
    * Get number of ball used to determine which image to use.
    * @return size_t number of ball
@@ -120,13 +175,13 @@ class Ball {
    * Set velocity boost to determine power the cue ball is hit with.
    * @param velocity increase for cue ball when hit with cue stick.
    */
-  void SetVelocityBoost(double velocity_boost);
+  void SetVelocityBoost(Scalar velocity_boost);
 
   /**
    * Get current velocity boost of ball calculated from pull distance power.
    * @return velocity boost used when cue ball is hit.
    */
-  double GetVelocityBoost() const;
+  Scalar GetVelocityBoost() const;
 
   // physics constants used to calculate velocity to slow balls
   // down after collisions
@@ -143,12 +198,14 @@ class Ball {
   // the eight ball
   size_t number_;
   // current position of ball
-  dvec2 position_;
+  Vec2 position_;
   // current velocity of ball
-  dvec2 velocity_;
+  Vec2 velocity_;
   // ball type: cue, eight, striped, solid
   Type type_;
   // depending on power of hit velocity boost changes
-  double velocity_boost_;
+  Scalar velocity_boost_;
 };
+
+typedef BasicBall<double> Ball;
 }  // namespace pool
@@ -0,0 +1,160 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "ball.h"
+namespace pool {
+using pool::Ball;
+using std::vector;
+
+/**
+ * Balls in play, each kept in a fixed slot given by its ball number, so a
+ * ball's slot and references to it stay valid across frames and removals
+ * until the balls are replaced with Assign or Clear. Removing a ball only
+ * takes its number off the list of balls in play, nothing is moved. Loops
+ * go through that list, so they only touch balls still on the table, in
+ * the order the balls were put in (the order erasing from a vector kept).
+ * The capacity is fixed when the pool is made and storage never grows.
+ * Every slot also has a sleep flag for the physics to skip balls at rest.
+ * Balls put into the pool start awake.
+ * Ball numbers have to be unique and below the capacity.
+ */
+class BallPool {
+ public:
+  /**
+   * Empty pool.
+   * @param capacity one more than the highest ball number it can hold.
+   */
+  explicit BallPool(size_t capacity);
+
+  /**
+   * Replaces the balls, in the given order.
+   * @param first ball to copy in.
+   * @param last one past the last ball to copy in.
+   */
+  void Assign(const Ball *first, const Ball *last);
+
+  /**
+   * Replaces the balls, in the given order.
+   * @param balls to copy in.
+   */
+  void Assign(const vector<Ball> &balls);
+
+  /**
+   * Puts a ball in its slot after the others, only used while setting up
+   * the table.
+   * @param ball to copy in, its number must not be in play.
+   */
+  void Add(const Ball &ball);
+
+  /**
+   * Removes every ball.
+   */
+  void Clear();
+
+  /**
+   * Takes a ball off the table, leaving every other ball in its slot.
+   * @param ball_number of the ball, which has to be in play.
+   */
+  void Remove(size_t ball_number);
+
+  /**
+   * Get if a ball is on the table.
+   * @param ball_number of the ball.
+   * @return true if it is in play.
+   */
+  bool IsInPlay(size_t ball_number) const;
+
+  /**
+   * Get number of balls in play.
+   * @return number of balls.
+   */
+  size_t GetCount() const;
+
+  /**
+   * Get number of slots.
+   * @return one more than the highest ball number the pool can hold.
+   */
+  size_t GetCapacity() const;
+
+  /**
+   * Get the balls in play to loop over them.
+   * @return numbers of the balls in play in the order they were put in.
+   */
+  const vector<size_t> &GetNumbers() const;
+
+  /**
+   * Copies the balls in play, packed in the order they were put in.
+   * @param balls cleared and filled with the balls.
+   */
+  void GetBalls(vector<Ball> &balls) const;
+
+  /**
+   * Copies balls back into their slots, for balls moved as a packed copy.
+   * @param balls that are all in play.
+   */
+  void Update(const vector<Ball> &balls);
+
+  /**
+   * Get a ball by number.
+   * @param ball_number of a ball in play.
+   * @return the ball.
+   */
+  Ball &operator[](size_t ball_number) {
+    return slots_[ball_number];
+  }
+  const Ball &operator[](size_t ball_number) const {
+    return slots_[ball_number];
+  }
+
+  /**
+   * Get if a ball is asleep, meaning it is at rest and the physics skips it
+   * until something wakes it.
+   * @param ball_number of a ball in play.
+   * @return true if asleep.
+   */
+  bool IsAsleep(size_t ball_number) const {
+    return asleep_[ball_number] != 0;
+  }
+
+  /**
+   * Puts a ball to sleep or wakes it.
+   * @param ball_number of a ball in play.
+   * @param asleep true to put it to sleep.
+   */
+  void SetAsleep(size_t ball_number, bool asleep) {
+    if ((asleep_[ball_number] != 0) != asleep) {
+      asleep_[ball_number] = asleep;
+      sleep_version_ += 1;
+    }
+  }
+
+  /**
+   * Get a number that changes whenever a ball falls asleep or wakes, or the
+   * balls in play change, so a copy of the sleeping balls can tell if it is
+   * still current. Sleeping balls don't move, whatever moves one wakes it.
+   * @return version of the sleeping balls.
+   */
+  size_t GetSleepVersion() const {
+    return sleep_version_;
+  }
+
+  /**
+   * Wakes every ball, for when balls may have been moved by something that
+   * doesn't keep the sleep flags.
+   */
+  void WakeAll();
+
+ private:
+  // ball of each number, only meaningful for numbers in play
+  vector<Ball> slots_;
+  // if each slot holds a ball in play, and its sleep flag, bytes rather than
+  // vector<bool> so setting one is a plain store
+  vector<unsigned char> in_play_;
+  vector<unsigned char> asleep_;
+  size_t sleep_version_ = 0;
+  // numbers of the balls in play in the order they were put in, removing
+  // one shifts the numbers after it but no ball
+  vector<size_t> numbers_;
+};
+}  // namespace pool
@@ -0,0 +1,142 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "ball.h"
+namespace pool {
+using pool::BasicBall;
+using std::pair;
+using std::vector;
+
+/**
+ * Allocator that returns memory aligned for SIMD loads and stores.
+ * @tparam T type of element.
+ * @tparam Alignment alignment in bytes, must be a power of two.
+ */
+template <typename T, size_t Alignment>
+class AlignedAllocator {
+ public:
+  typedef T value_type;
+
+  template <typename U>
+  struct rebind {
+    typedef AlignedAllocator<U, Alignment> other;
+  };
+
+  AlignedAllocator() {
+  }
+
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) {
+  }
+
+  T *allocate(size_t count) {
+    // room to move the start forward to an aligned address and to store the
+    // original pointer right before it
+    size_t bytes = count * sizeof(T) + Alignment + sizeof(void *);
+    char *memory = static_cast<char *>(::operator new(bytes));
+    uintptr_t start = reinterpret_cast<uintptr_t>(memory + sizeof(void *));
+    uintptr_t aligned = (start + Alignment - 1) & ~(uintptr_t)(Alignment - 1);
+    void **header = reinterpret_cast<void **>(aligned) - 1;
+    *header = memory;
+    return reinterpret_cast<T *>(aligned);
+  }
+
+  void deallocate(T *pointer, size_t) {
+    if (pointer != nullptr) {
+      ::operator delete(*(reinterpret_cast<void **>(pointer) - 1));
+    }
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment> &) const {
+    return false;
+  }
+};
+
+/**
+ * Structure of arrays storage for the ball positions, with a kernel that
+ * tests one ball against several others at once using SSE2/AVX when
+ * compiled for it and a plain loop otherwise. It is the board's
+ * simd_all_pairs broad phase.
+ * Arrays are aligned and padded to a whole number of SIMD registers.
+ * Positions are top left corners like Ball::GetPosition.
+ * Arrays hold Scalar, float fits twice as many balls in a register as
+ * double. BallSystem is the double one the board uses.
+ */
+template <typename Scalar>
+class BasicBallSystem {
+ public:
+  /**
+   * Empty constructor.
+   */
+  BasicBallSystem();
+
+  /**
+   * Copies positions of the balls into the arrays.
+   * @param balls to copy from.
+   */
+  void Load(const vector<BasicBall<Scalar>> &balls);
+
+  /**
+   * Finds pairs of balls whose centers are within contact_distance of each
+   * other, testing one ball against kLaneWidth others at once with squared
+   * distances so no square roots are taken.
+   * @param pairs cleared and filled with pairs (i, j), i < j, in loop order.
+   * @param contact_distance max distance between centers.
+   */
+  void FindTouchingPairs(vector<pair<size_t, size_t>> &pairs,
+                         Scalar contact_distance) const;
+
+  /**
+   * Get number of balls loaded.
+   * @return number of balls, not counting padding.
+   */
+  size_t GetSize() const;
+
+  /**
+   * Get length of the arrays including padding.
+   * @return number of balls rounded up to a multiple of kLaneWidth.
+   */
+  size_t GetPaddedSize() const;
+
+  // getters for the arrays, each has GetPaddedSize elements
+  const Scalar *GetX() const;
+  const Scalar *GetY() const;
+
+  /**
+   * Get name of the SIMD instructions the kernel was compiled with.
+   * @return "avx", "sse2" or "scalar".
+   */
+  static const char *GetInstructionSet();
+
+  // alignment of arrays in bytes, enough for aligned AVX loads
+  constexpr static const size_t kAlignment = 32;
+  // number of Scalars in the widest register used, arrays are padded to this
+  constexpr static const size_t kLaneWidth = kAlignment / sizeof(Scalar);
+
+ private:
+  typedef vector<Scalar, AlignedAllocator<Scalar, kAlignment>> AlignedArray;
+
+  size_t size_;
+  // arrays are a lane longer than GetPaddedSize so unaligned loads starting
+  // at any ball stay in bounds
+  AlignedArray x_;
+  AlignedArray y_;
+};
+
+template <typename Scalar>
+constexpr const size_t BasicBallSystem<Scalar>::kAlignment;
+template <typename Scalar>
+constexpr const size_t BasicBallSystem<Scalar>::kLaneWidth;
+
+typedef BasicBallSystem<double> BallSystem;
+}  // namespace pool
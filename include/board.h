@@ -2,41 +2,128 @@
 // Created by neha konjeti on 4/16/21.
 //
 #pragma once
+#include <array>
+#include <string>
 #include <vector>
 
 #include "ball.h"
-#include "cinder/gl/gl.h"
+#include "ball_pool.h"
+#include "ball_system.h"
+#include "board_state.h"
+#include "event_simulator.h"
+#include "fixed_point.h"
 #include "player.h"
+#include "spatial_grid.h"
 #include "stick.h"
+#include "table_spec.h"
 namespace pool {
 using glm::dvec2;
 using pool::Ball;
+using pool::BallPool;
+using pool::BallSystem;
+using pool::BoardState;
+using pool::BasicEventSimulator;
+using pool::Fixed;
+using pool::FixedBall;
+using pool::FixedVec2;
 using pool::Player;
+using pool::SpatialGrid;
 using pool::Stick;
 using std::string;
 using std::vector;
 
 /**
  * Class to initialize pool balls and stick and direct actions between these.
+ * The table's size, pockets and balls come from Spec and are constants in
+ * table units, so loops over the pockets have a trip count fixed when
+ * compiling and the pocket test compares against constants.
  */
-class Board {
+template <typename Spec>
+class BasicBoard {
  public:
-  /**
-   * Initializes vectors for outline and inside of board.
-   * @param window_size size_t to scale the board respective to window size.
-   */
-  Board(double window_size);
+  // finds events on this table in event driven mode
+  typedef BasicEventSimulator<Spec> EventSimulator;
+  // positions of every pocket's center
+  typedef typename EventSimulator::HolePositions HolePositions;
+
+  /**
+   * Enum for how ball motion is simulated.
+   * frame_stepping : balls are moved by their velocity every frame and
+   * collisions are checked after the move.
+   * event_driven : balls jump straight to the time of the next collision,
+   * pocket or stop using the closed form of the friction model.
+   * fixed_point : frame stepping with positions and velocities in fixed
+   * point (see fixed_point.h) and touching balls resolved together in ball
+   * number order. No physics decision is made in floating point, so a shot
+   * comes out as the same bits on every compiler and machine, for lockstep
+   * play and replays kept for a long time. Sleeping balls are skipped and
+   * pairs come from the broad phase like frame_stepping, the contact solver
+   * doesn't apply. Configuring with POOL_FIXED_POINT_PHYSICS makes it the
+   * mode boards start in.
+   */
+  enum SimulationMode { frame_stepping, event_driven, fixed_point };
+
+  /**
+   * Enum for how pairs of balls are picked to check for collisions when frame
+   * stepping.
+   * brute_force : every pair of balls is checked.
+   * uniform_grid : only balls in the same or neighbouring grid cells are
+   * checked.
+   * simd_all_pairs : every pair is tested for overlap with the vectorized
+   * BallSystem kernel and only overlapping pairs are checked.
+   */
+  enum BroadPhase { brute_force, uniform_grid, simd_all_pairs };
+
+  /**
+   * Enum for how touching balls are resolved when frame stepping.
+   * sequential : each ball is stepped in turn and resolves its pairs with
+   * the balls after it, so the result depends on the order of the balls.
+   * The default, it skips the gathering and sweeps and the break comes to
+   * rest no later than with simultaneous.
+   * simultaneous : every touching pair is gathered first and all of them
+   * are resolved together, sweeping them in ball number order until none
+   * are moving into each other, at most kMaxContactIterations sweeps. The
+   * result doesn't depend on where balls are stored and a push through the
+   * rack reaches every ball in the frame it starts, for when that matters
+   * more than the extra sweeps.
+   */
+  enum ContactSolver { sequential, simultaneous };
+
+  /**
+   * What a shot ends up doing once every ball has stopped (or the game
+   * ended), from SimulateShot or PlayShot.
+   */
+  struct ShotResult {
+    // balls left on the board, cue ball is put back if it went in a hole
+    vector<Ball> balls;
+    // numbers of balls that went into holes in the order they went in, the
+    // cue ball is 0
+    vector<size_t> pocketed_ball_numbers;
+    Player::GameState game_state;
+    // ball type player has to score after the shot
+    Ball::Type ball_type_to_score;
+    // balls the player has scored after the shot
+    size_t player_score;
+    // if cue ball has to be placed by the player
+    bool cue_in_hole;
+    // collisions, pockets and stops simulated in event_driven mode, frames
+    // in the others
+    size_t num_events;
+  };
+
+  /**
+   * Initializes vectors for outline and inside of board. The table is the
+   * same size in table units whatever the window.
+   * @param window_size size of the window the board is drawn in, sets the
+   * aim line lengths and GetViewScale.
+   */
+  BasicBoard(double window_size);
 
   /**
    * Method to create billiard balls in board.
    */
   void CreatePoolBalls();
 
-  /**
-   * Method to display billiard board.
-   */
-  void Display(const vector<ci::gl::Texture2dRef> &images);
-
   /**
    * Method to rotate stick when right arrow is clicked.
    */
@@ -53,11 +140,185 @@ class Board {
    */
   void HitCueBall();
 
+  /**
+   * Hits the cue ball with a shot that doesn't come from the stick, used by
+   * the computer player. Unlike HitCueBall the stick doesn't have to be
+   * visible.
+   * @param angle (in radians) cue ball travels in, same as GetShotAngle.
+   * @param power velocity the cue ball is hit with, from GetMinShotPower to
+   * GetMaxShotPower.
+   */
+  void HitCueBall(double angle, double power);
+
+  /**
+   * Checks if ball went into hole from position on board.
+   * @param ball used to check if ball position is in hole.
+   * @return if ball position was in hole circle.
+   */
+  bool CheckIfInHole(const Ball &ball) const;
+
   /**
    * Method to update ball positions on billiard board.
+   * Moves balls forward one frame of time using the current simulation mode.
+   * When frame stepping, balls that came to rest sleep and are skipped until
+   * a moving ball touches them or their island of touching balls, which
+   * gives the same result as stepping every ball since nothing else can
+   * change a ball at rest.
    */
   void AdvanceOneFrame();
 
+  /**
+   * Moves balls forward by a fixed physics step that can be more or less
+   * than a frame. Event driven mode simulates exactly that much time, frame
+   * stepping carries fractions of a frame over to the next call so the same
+   * frames are run whatever the step length is.
+   * Balls before the step are kept for GetInterpolatedPoolBalls.
+   * @param frames length of the step measured in frames.
+   */
+  void Advance(double frames);
+
+  /**
+   * Get balls with positions between where they were before and after the
+   * last Advance, used to draw smoothly when the display runs faster than
+   * the physics. Balls that jumped (cue ball put back on the board) are not
+   * interpolated.
+   * @param interpolation_factor 0 for the previous positions, 1 for the
+   * current ones.
+   * @return copy of balls with interpolated positions.
+   */
+  vector<Ball> GetInterpolatedPoolBalls(double interpolation_factor) const;
+
+  /**
+   * Same as GetInterpolatedPoolBalls, writing into a vector the caller keeps
+   * so drawing every frame doesn't allocate.
+   * @param interpolation_factor 0 for the previous positions, 1 for the
+   * current ones.
+   * @param balls replaced by the balls with interpolated positions.
+   */
+  void GetInterpolatedPoolBalls(double interpolation_factor,
+                                vector<Ball> &balls) const;
+
+  /**
+   * Runs the shot in the board's simulation mode until all balls stop (or
+   * the game is over), so it ends where playing the shot out would. Event
+   * driven mode jumps between events, the other modes step frames.
+   * @return number of events that were processed in event_driven mode,
+   * frames stepped in the others.
+   */
+  size_t SimulateUntilRest();
+
+  /**
+   * Works out what a shot from the current board does without changing the
+   * board, jumping between events with the closed form motion instead of
+   * stepping frames, whatever the board's simulation mode. The shot is run
+   * on a scratch board restored from Save, so nothing is copied but the
+   * saved state and the scratch board's buffers are reused between calls.
+   * @param angle (in radians) cue ball travels in, same as GetShotAngle.
+   * @param power velocity the cue ball is hit with, from GetMinShotPower to
+   * GetMaxShotPower.
+   * @param scratch board of the same table and window size to run the shot
+   * on, whatever was on it is replaced.
+   * @return balls at rest, balls pocketed and game state after the shot.
+   */
+  ShotResult SimulateShot(double angle, double power,
+                          BasicBoard &scratch) const;
+
+  /**
+   * Same as SimulateShot with a scratch board made for the call, for shots
+   * worked out once.
+   */
+  ShotResult SimulateShot(double angle, double power) const;
+
+  /**
+   * Same as SimulateShot, run in the board's simulation mode, broad phase
+   * and contact solver with SimulateUntilRest, so the result is exactly
+   * where playing the shot out on this board ends. Frames are stepped in
+   * every mode but event_driven.
+   * @param angle (in radians) cue ball travels in, same as GetShotAngle.
+   * @param power velocity the cue ball is hit with.
+   * @param scratch board of the same table and window size to run the shot
+   * on, whatever was on it is replaced.
+   * @return balls at rest, balls pocketed and game state after the shot.
+   */
+  ShotResult PlayShot(double angle, double power, BasicBoard &scratch) const;
+
+  /**
+   * Get power of a shot with the stick not pulled back.
+   * @return velocity cue ball is hit with.
+   */
+  static double GetMinShotPower();
+
+  /**
+   * Get power of a shot with the stick pulled back all the way.
+   * @return velocity cue ball is hit with.
+   */
+  static double GetMaxShotPower();
+
+  /**
+   * Get numbers of balls that went in holes since the cue ball was last hit.
+   * @return ball numbers in the order they went in.
+   */
+  const vector<size_t> &GetBallsPocketedThisShot() const;
+
+  /**
+   * Copies everything that changes during play into a fixed size state
+   * without allocating. Only the first BoardState::kMaxBalls balls are
+   * saved.
+   * @return state to pass to Restore.
+   */
+  BoardState Save() const;
+
+  /**
+   * Puts the board back to a saved state, reusing the storage the board
+   * already has so it doesn't allocate once the board has held as many balls
+   * as the state does. Interpolation starts over from the restored balls.
+   * @param state from Save, can be from another board of the same size.
+   */
+  void Restore(const BoardState &state);
+
+  /**
+   * Set how ball motion is simulated by AdvanceOneFrame.
+   * @param mode frame_stepping, event_driven or fixed_point.
+   */
+  void SetSimulationMode(SimulationMode mode);
+
+  /**
+   * Get how ball motion is simulated by AdvanceOneFrame.
+   * @return current simulation mode.
+   */
+  SimulationMode GetSimulationMode() const;
+
+  /**
+   * Set how pairs of balls are picked to check for collisions.
+   * @param broad_phase brute_force or uniform_grid.
+   */
+  void SetBroadPhase(BroadPhase broad_phase);
+
+  /**
+   * Get how pairs of balls are picked to check for collisions.
+   * @return current broad phase.
+   */
+  BroadPhase GetBroadPhase() const;
+
+  /**
+   * Set how touching balls are resolved when frame stepping.
+   * @param contact_solver sequential or simultaneous.
+   */
+  void SetContactSolver(ContactSolver contact_solver);
+
+  /**
+   * Get how touching balls are resolved when frame stepping.
+   * @return current contact solver.
+   */
+  ContactSolver GetContactSolver() const;
+
+  /**
+   * Get number of ball pairs that were checked for collisions in the last
+   * frame, used to compare broad phases.
+   * @return number of candidate pairs checked.
+   */
+  size_t GetCandidatePairCount() const;
+
   /**
    * Get the left x position for ball with left side of board collision.
    * @return double of left x position of pool board.
@@ -90,28 +351,69 @@ class Board {
 
   /**
    * Getter for balls vector used in testing to check balls velocities are
-   * updating.
+   * updating, and to draw the balls.
+   * @return copy of the balls on the board, in the order they were set.
+   */
+  vector<Ball> GetPoolBalls() const;
+
+  /**
+   * Same as GetPoolBalls, writing into a vector the caller keeps so its
+   * memory is reused.
+   * @param balls replaced with the balls on the board.
    */
-  vector<Ball> GetPoolBalls();
+  void GetPoolBalls(vector<Ball> &balls) const;
+
+  /**
+   * Getter for the balls in their slots, to read them without copying.
+   * @return pool of the balls on the board, valid until the board changes.
+   */
+  const BallPool &GetBallPool() const;
 
   /**
    * Getter for radius of all the holes.
    * @return double radius of hole.
    */
-  double GetHoleRadius();
+  double GetHoleRadius() const;
+
+  /**
+   * Getter for center positions of all the holes used to draw them.
+   * @return hole center positions.
+   */
+  const HolePositions &GetHolePositions() const;
+
+  /**
+   * Getter for top left corner of board outline used to draw the board.
+   * @return top left position of outline rectangle.
+   */
+  dvec2 GetOuterRectTopPosition() const;
+
+  /**
+   * Getter for bottom right corner of board outline used to draw the board.
+   * @return bottom right position of outline rectangle.
+   */
+  dvec2 GetOuterRectBottomPosition() const;
+
+  /**
+   * Get how much to scale the table by to draw it in the window the board
+   * was made for, leaving the same margin right and below the outline as to
+   * its left.
+   * @return 1 for tables that fit at one table unit a pixel, less for longer
+   * ones.
+   */
+  double GetViewScale() const;
 
   /**
    * Getter for stick visibility to test if stick is visible during shot.
    * @return boolean if stick is visible.
    */
-  bool GetStickVisibility();
+  bool GetStickVisibility() const;
 
   /**
    * Getter for variable which keeps track if cue ball is currently in any
    * of the holes so cue ball can be dragged to new point.
    * @return boolean if cue ball was hit into hole.
    */
-  bool IsCueInHole();
+  bool IsCueInHole() const;
 
   /**
    * Changes cue ball position after getting hit into hole.
@@ -140,18 +442,6 @@ class Board {
    */
   Player::GameState GetPlayerState() const;
 
-  /**
-   * If player won, a winning message is shown on pool board prompting player
-   * to play again.
-   */
-  void DisplayWinningMessage() const;
-
-  /**
-   * If player lost, a losing message is shown on pool board prompting player to
-   * play again.
-   */
-  void DisplayLosingMessage() const;
-
   /**
    * Board pieces are reset like the balls, player, and stick
    * to original positions and initial game setting.
@@ -165,19 +455,30 @@ class Board {
    */
   double GetAimLineLength() const;
 
+  /**
+   * Get the angle the cue ball travels in when hit, which is the stick angle
+   * with the initial stick angle added.
+   * @return angle (in radians) of shot used for aim line.
+   */
+  double GetShotAngle() const;
+
   /**
    * Get player object with information pertaining to player : ball type, score,
    * number of balls scored by player.
    * @return player that is playing pool game.
    */
-  Player GetPlayer() const;
+  const Player &GetPlayer() const;
 
   /**
    * Get Stick object with information pertaining to cue stick such as current
    * angle.
    * @return Stick object used in game.
    */
-  Stick GetStick() const;
+  const Stick &GetStick() const;
+
+  // limit on sweeps over the contacts each frame for the simultaneous
+  // contact solver
+  constexpr static size_t const kMaxContactIterations = 32;
 
  private:
   /**
@@ -201,19 +502,96 @@ class Board {
   void MakeEightBall();
 
   /**
-   * Helper method to draw the holes on the board.
+   * Applies the game rules for a ball that went into a hole: repositions the
+   * cue ball, scores the ball or ends the game.
+   * @param ball_number of the ball in balls_ that is in a hole.
+   * @return true if the ball was scored and has to be taken off the table,
+   * it is left in balls_ so the caller can remove it once the frame is done.
    */
-  void DrawHoles() const;
+  bool HandleBallInHole(size_t ball_number);
 
   /**
-   * Checks if ball went into hole from position on board.
-   * @param ball used to check if ball position is in hole.
-   * @return if ball position was in hole circle.
+   * Runs a shot on a scratch board restored from Save for SimulateShot and
+   * PlayShot.
+   * @param mode to simulate the shot in.
+   * @return balls at rest, balls pocketed and game state after the shot.
+   */
+  ShotResult RunShot(double angle, double power, SimulationMode mode,
+                     BasicBoard &scratch) const;
+
+  /**
+   * Moves balls forward by jumping between events.
+   * @param frames amount of time to simulate, can be infinite to run until
+   * balls stop.
+   * @return number of events that were processed.
+   */
+  size_t AdvanceByEvents(double frames);
+
+  /**
+   * Finds the pairs of awake balls that could be touching into
+   * candidate_pairs_ with the uniform_grid or simd_all_pairs broad phase.
+   */
+  void FindCandidatePairs();
+
+  /**
+   * Steps the awake balls one at a time for the sequential contact solver.
+   * @return number of balls still moving.
+   */
+  size_t StepBallsInOrder();
+
+  /**
+   * Steps the awake balls together for the simultaneous contact solver.
+   * @return number of balls still moving.
+   */
+  size_t StepBallsTogether();
+
+  /**
+   * Steps the awake balls in fixed point for fixed_point mode, resolving
+   * touching pairs together like StepBallsTogether.
+   * @return number of balls still moving.
+   */
+  size_t StepBallsFixed();
+
+  /**
+   * Fills contacts_ with the pairs of awake balls touching now, from the
+   * broad phase or every pair for brute_force, skipping balls marked in
+   * in_hole_. Pairs have the lower ball number first and are sorted, so
+   * sweeping them doesn't depend on the order balls were set in or on the
+   * broad phase.
+   * @param touching called with two ball numbers, true if they touch.
    */
-  bool CheckIfInHole(const Ball &ball);
+  template <typename Touching>
+  void FindContacts(Touching touching);
 
   /**
-   * Change balls positions to make beginning triangle formation.
+   * Runs HandleBallInHole for every ball marked in in_hole_, in ball number
+   * order, queueing the ones scored for removal.
+   */
+  void HandleBallsInHoles();
+
+  /**
+   * Hits the cue ball with the stick at an angle with its velocity boost,
+   * in fixed point in fixed_point mode.
+   */
+  void StickHitCueBall(double angle);
+
+  /**
+   * Wakes every sleeping ball touching an awake ball, then the ones touching
+   * those, so whole islands of touching balls wake together. Sleeping balls
+   * near each awake ball are looked up in sleeping_grid_. The awake balls
+   * end up first in ball_order_, in the pool's order.
+   */
+  void WakeTouchingBalls();
+
+  /**
+   * Builds sleeping_grid_ again from the sleeping balls at the back of
+   * ball_order_ unless no ball fell asleep or woke since the last build.
+   */
+  void UpdateSleepingGrid();
+
+  /**
+   * Change balls positions to make beginning triangle formation, packed so
+   * every ball touches its neighbours.
    */
   void MakeTriangle();
 
@@ -225,39 +603,62 @@ class Board {
    */
   bool CheckOverlap(dvec2 center_pos);
 
-  /**
-   * Draws line for shooting cue ball,
-   * helps player with aim and uses stick angle to be drawn.
-   */
-  void DrawLine() const;
-
-  // vector of all the balls on the board
+  // all the balls on the board, in slots by ball number
   // balls_[0] is the cue ball
-  vector<Ball> balls_;
+  BallPool balls_ = BallPool(kNumberOfBalls + 1);
   // stores angle of stick and hits cue ball
   Stick cue_stick_;
   // player keeps track of balls scored and game state
   Player player_;
   // number of balls in a pool game
   // excluding the cue ball
-  size_t const kNumberOfBalls = 15;
+  constexpr static size_t const kNumberOfBalls = Spec::kNumberOfBalls;
   // number of striped or solid balls
-  size_t const kNumberOfBallsPerType = 7;
+  constexpr static size_t const kNumberOfBallsPerType =
+      Spec::kNumberOfBallsPerType;
+  static_assert(kNumberOfBalls + 1 <= BoardState::kMaxBalls,
+                "every ball on the table has to fit in a BoardState");
+  // size of the window the board was made for
+  double window_size_;
+  // edges of the playing area in table units
+  constexpr static double const kFeltLeft =
+      Spec::kOuterLeft + Spec::kCushionWidth;
+  constexpr static double const kFeltTop =
+      Spec::kOuterTop + Spec::kCushionWidth;
+  constexpr static double const kFeltRight =
+      Spec::kOuterRight - Spec::kCushionWidth;
+  constexpr static double const kFeltBottom =
+      Spec::kOuterBottom - Spec::kCushionWidth;
+  // a ball is in a hole once its center is closer than the radius to the
+  // hole's center, compared squared
+  constexpr static double const kHoleRadiusSquared =
+      Spec::kPocketRadius * Spec::kPocketRadius;
+  static_assert(Ball::kDiameter == kBallTableUnits,
+                "table specs are sized to the ball");
+
+  /**
+   * Get a hole's center, worked out from the spec when compiling.
+   * @param pocket index into the spec's pockets.
+   */
+  constexpr static double GetHoleX(size_t pocket) {
+    return kFeltLeft * (1 - Spec::kPocketX[pocket]) +
+           kFeltRight * Spec::kPocketX[pocket];
+  }
+  constexpr static double GetHoleY(size_t pocket) {
+    return kFeltTop * (1 - Spec::kPocketY[pocket]) +
+           kFeltBottom * Spec::kPocketY[pocket];
+  }
+
   // outline of board positions
-  dvec2 outer_rect_bottom_pos_;
-  dvec2 outer_rect_top_pos_;
-  // width between outline of board and playing space
-  double board_outline_width_;
+  dvec2 outer_rect_bottom_pos_ = {Spec::kOuterRight, Spec::kOuterBottom};
+  dvec2 outer_rect_top_pos_ = {Spec::kOuterLeft, Spec::kOuterTop};
   // inside rectangle of board positions
-  dvec2 inner_rect_top_pos_;
-  dvec2 inner_rect_bottom_pos_;
-  size_t const kEightBallNumber = 8;
-  // colors to draw board
-  ci::Color const kPoolBoardColor = "green";
-  ci::Color const kPoolBoardOutlineColor = "sienna";
-  double hole_radius_;
-  // stores all the hole center positions
-  vector<dvec2> hole_positions_;
+  dvec2 inner_rect_top_pos_ = {kFeltLeft, kFeltTop};
+  dvec2 inner_rect_bottom_pos_ = {kFeltRight, kFeltBottom};
+  constexpr static size_t const kEightBallNumber = kNumberOfBallsPerType + 1;
+  // stores all the hole center positions, for drawing and the event
+  // simulator
+  HolePositions hole_positions_;
   // if the stick is visible on board
   // false during shots (when balls on board are moving)
   bool stick_visible_ = true;
@@ -265,19 +666,92 @@ class Board {
   bool cue_in_hole_ = false;
   // initial angle taken into account for the ball moving in angle direction
   // of stick
-  double const kInitialStickAngle = M_PI / 2;
+  constexpr static double const kInitialStickAngle = M_PI / 2;
   // velocity power with pull back distance of stick
   // is used to calculate velocity boost
-  double const kVelocityPower = 6.0;
+  constexpr static double const kVelocityPower = 6.0;
   // starting line length of aim
   double min_line_length_;
   // current line length of aim
   double aim_line_length_;
   // how much line length extends when the pull distance of stick changes
   double extend_line_length_;
-  // position not in screen to temporarily assign position to ball
-  // that got hit into holes
-  // use this position to find those balls and remove from balls_ vector
-  dvec2 const kOutsideOfView = {-100.0, -100.0};
+  // numbers of balls scored this frame, removed once the frame is done
+  vector<size_t> balls_to_remove_;
+  // numbers of balls that went in holes since the last hit
+  vector<size_t> pocketed_this_shot_;
+  // how ball motion is simulated each frame
+#ifdef POOL_FIXED_POINT_PHYSICS
+  SimulationMode simulation_mode_ = fixed_point;
+#else
+  SimulationMode simulation_mode_ = frame_stepping;
+#endif
+  // finds next collision, pocket or stop for event driven mode
+  EventSimulator event_simulator_;
+  // safety limit so a shot can never get stuck processing events
+  constexpr static size_t const kMaxEventsPerAdvance = 100000;
+  // how pairs of balls are picked to check for collisions
+  BroadPhase broad_phase_ = brute_force;
+  // grid with ball sized cells for uniform_grid broad phase
+  SpatialGrid grid_;
+  // copy of ball positions in arrays for the simd_all_pairs broad phase
+  BallSystem ball_system_;
+  // contact distance for simd_all_pairs is a little bigger than a ball so
+  // rounding in the squared distance can't drop a pair that
+  // Ball::HandlePoolBallsColliding would find touching
+  constexpr static double const kOverlapTolerance = 1e-6;
+  // balls before the last Advance for interpolation
+  BallPool previous_balls_ = BallPool(kNumberOfBalls + 1);
+  // part of a frame not yet run by Advance in frame_stepping mode
+  double frame_remainder_ = 0;
+  // length of the last Advance in frames
+  double last_advance_frames_ = 0;
+  // steps within this much of a whole frame count as whole frames so
+  // rounding in the step length doesn't skip a frame
+  constexpr static double const kFrameTolerance = 1e-9;
+  // pairs of awake balls found by the broad phase as positions in
+  // ball_order_, kept to reuse storage
+  vector<std::pair<size_t, size_t>> candidate_pairs_;
+  // number of every ball, the first num_awake_ are the balls stepped this
+  // frame in order, then the sleeping ones
+  vector<size_t> ball_order_;
+  size_t num_awake_ = 0;
+  // copies of the awake balls for the broad phase when some are asleep
+  vector<Ball> awake_balls_;
+  // copies of the sleeping balls and a grid of them for waking balls, kept
+  // across frames since sleeping balls don't move, and the pool's sleep
+  // version they were made at. The copies are the first num_sleeping_balls_
+  // of a vector sized to the pool so copies of the board don't allocate.
+  vector<Ball> sleeping_balls_;
+  size_t num_sleeping_balls_ = 0;
+  SpatialGrid sleeping_grid_;
+  size_t sleeping_grid_version_ = 0;
+  // how touching balls are resolved
+  ContactSolver contact_solver_ = sequential;
+  // pairs of awake balls touching at the start of the frame and if each
+  // ball went in a hole, for the simultaneous contact solver and fixed_point
+  // mode. Both are emptied once the frame is done so copies of the board
+  // don't copy them.
+  vector<std::pair<size_t, size_t>> contacts_;
+  vector<unsigned char> in_hole_;
+  // fixed point copies of the awake balls while a fixed_point frame is
+  // stepped, emptied like contacts_
+  vector<FixedBall> fixed_balls_;
+  // felt edges, hole centers, hole radius and ball diameter rounded to
+  // fixed point once when the board is made
+  Fixed fixed_felt_left_;
+  Fixed fixed_felt_top_;
+  Fixed fixed_felt_right_;
+  Fixed fixed_felt_bottom_;
+  std::array<FixedVec2, Spec::kNumPockets> fixed_hole_positions_;
+  Fixed fixed_hole_radius_;
+  Fixed fixed_diameter_;
+  // packed copy of the balls the event simulator moves in event_driven
+  // mode, emptied like contacts_
+  vector<Ball> event_balls_;
+  // number of pairs checked for collisions in the last frame
+  size_t candidate_pair_count_ = 0;
 };
+
+typedef BasicBoard<ClassicTable> Board;
 }  // namespace pool
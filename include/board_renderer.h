@@ -0,0 +1,217 @@
+#pragma once
+#include <vector>
+
+#include "aim_preview.h"
+#include "board.h"
+#include "profiler.h"
+#include "sprite_atlas.h"
+#include "cinder/Surface.h"
+#include "cinder/gl/TextureFont.h"
+#include "cinder/gl/gl.h"
+namespace pool {
+using pool::BasicAimPreview;
+using pool::BasicBoard;
+using pool::Profiler;
+using pool::SpriteAtlas;
+using std::vector;
+
+/**
+ * Class to draw the board, balls, stick and messages with Cinder.
+ * Keeps all the rendering out of the simulation classes so they can be run
+ * without a display.
+ * Tables too long for the window are drawn scaled down by
+ * Board::GetViewScale, mouse positions are scaled back with
+ * ToBoardPosition.
+ */
+template <typename Spec>
+class BasicBoardRenderer {
+ public:
+  // board drawn and the aim line traced on it
+  typedef BasicBoard<Spec> Board;
+  typedef BasicAimPreview<Spec> AimPreview;
+
+  /**
+   * Packs the pool ball images into one atlas texture and sets up the
+   * instanced batch every ball is drawn with. Needs the GL context, so call
+   * it from setup.
+   * @param images of the pool balls, indexed by ball number, one for each of
+   * the spec's kNumberOfBalls balls and the cue ball.
+   */
+  void LoadBallImages(const vector<ci::SurfaceRef> &images);
+
+  /**
+   * Method to display billiard board with balls, stick, aim line and the balls
+   * scored by the player. The balls on the board and the scored balls are
+   * drawn together with one instanced draw call.
+   * @param board to draw.
+   * @param interpolation_factor how far between the last two physics steps
+   * to draw the balls, from FixedTimestep::GetInterpolationFactor.
+   */
+  void Display(const Board &board, double interpolation_factor) const;
+
+  /**
+   * If player won, a winning message is shown on pool board prompting player
+   * to play again.
+   */
+  void DisplayWinningMessage(const Board &board) const;
+
+  /**
+   * If player lost, a losing message is shown on pool board prompting player to
+   * play again.
+   */
+  void DisplayLosingMessage(const Board &board) const;
+
+  /**
+   * Displays the profiler's rolling numbers over the top right of the
+   * window: time each scope took in the last frame, on average and in the
+   * worst frame, and the same for each counter.
+   * @param stats from Profiler::GetStats.
+   */
+  void DisplayProfiler(const vector<Profiler::Stats> &stats) const;
+
+  /**
+   * Converts a position in the window, like the mouse's, to the board's
+   * table units, undoing the board's view scale.
+   * @param board being drawn.
+   * @param window_position in pixels.
+   * @return position on the board.
+   */
+  static dvec2 ToBoardPosition(const Board &board,
+                               const ci::ivec2 &window_position);
+
+ private:
+  /**
+   * Position, size and atlas texture coordinates of one ball, read by the
+   * ball shader once per instance.
+   */
+  struct BallInstance {
+    // left, top, width and height on screen
+    ci::vec4 rect;
+    // left, top, right and bottom texture coordinates in the atlas
+    ci::vec4 uv_rect;
+  };
+
+  /**
+   * Everything the table batch is built from, so it is only built again
+   * when the table changes.
+   */
+  struct TableShape {
+    dvec2 outer_bottom;
+    dvec2 outer_top;
+    dvec2 felt_bottom;
+    dvec2 felt_top;
+    typename Board::HolePositions hole_positions;
+    double hole_radius;
+
+    /**
+     * Checks if a board's table still has this shape, without copying it.
+     */
+    bool Matches(const Board &board) const;
+  };
+
+  /**
+   * Get the shape of a board's table.
+   */
+  static TableShape GetTableShape(const Board &board);
+
+  /**
+   * Tessellates the outline, felt and holes into one colored mesh and
+   * uploads it as table_batch_.
+   */
+  void BuildTableBatch(const TableShape &shape) const;
+
+  /**
+   * Draws the table, building its batch first if the table changed.
+   */
+  void DrawTable(const Board &board) const;
+
+  /**
+   * Gets a font with its glyphs kept in a texture, made the first time it
+   * is used.
+   * @param font cached font, set if null.
+   * @param name of the system font.
+   * @param size in points.
+   * @return the cached font.
+   */
+  static const ci::gl::TextureFontRef &GetFont(ci::gl::TextureFontRef &font,
+                                               const std::string &name,
+                                               float size);
+
+  /**
+   * Adds a ball to the ones drawn by the next DrawBalls.
+   * @param position top left corner of the ball.
+   * @param diameter size to draw the ball at.
+   * @param ball_number picks the image.
+   */
+  void AddBall(const dvec2 &position, double diameter,
+               size_t ball_number) const;
+
+  /**
+   * Draws every ball added since the last call with one instanced draw.
+   */
+  void DrawBalls() const;
+
+  /**
+   * Display stick on board next to cue ball.
+   */
+  void DrawStick(const Stick &stick, const Ball &cue_ball) const;
+
+  /**
+   * Draws the path the cue ball will take for the stick angle, bouncing off
+   * sides, with the ghost ball and the directions both balls leave in when
+   * it hits another ball. Helps player with aim.
+   */
+  void DrawLine(const Board &board) const;
+
+  /**
+   * Adds the balls scored by player above game board
+   * so they remember which ones they need to win.
+   */
+  void AddScoredBalls(const Player &player) const;
+
+  /**
+   * Helper to draw a message in the center of the board.
+   */
+  void DrawMessage(const Board &board, const std::string &message) const;
+
+  // shape the table batch was built for
+  mutable TableShape table_shape_;
+  // outline, felt and holes drawn with one draw call, null until first drawn
+  mutable ci::gl::BatchRef table_batch_;
+  // triangles each hole is drawn with
+  const size_t kHoleSegments = 32;
+  // fonts of the messages over the board and the profiler overlay, glyphs
+  // are rasterized once and drawn from a texture after that
+  mutable ci::gl::TextureFontRef message_font_;
+  mutable ci::gl::TextureFontRef profiler_font_;
+  // colors to draw board
+  ci::Color const kPoolBoardColor = "green";
+  ci::Color const kPoolBoardOutlineColor = "sienna";
+  ci::Color const kStickColor = "chocolate";
+  // set space between balls the player scored in display above pool board
+  double const kSpaceBetweenBalls = 100;
+  // path of the aim line, only traced again when the stick or balls change,
+  // so it is kept between draws
+  mutable AimPreview aim_preview_;
+  // where each ball image is in ball_atlas_, indexed by ball number
+  SpriteAtlas ball_layout_;
+  // every ball image in one texture so balls need a single bind
+  ci::gl::Texture2dRef ball_atlas_;
+  // per instance data of the balls being drawn, grown when there are more
+  ci::gl::VboRef ball_instance_vbo_;
+  // unit quad drawn once per ball, placed and textured by the instance data
+  ci::gl::BatchRef ball_batch_;
+  // balls to draw, kept between frames so its memory is reused
+  mutable vector<BallInstance> ball_instances_;
+  // balls at their interpolated positions, reused the same way
+  mutable vector<Ball> interpolated_balls_;
+  // length of the lines showing where balls go after a hit
+  double const kDeflectionLineLength = 60;
+  // profiler overlay position, width and height of each line
+  ci::vec2 const kProfilerPosition = {560, 10};
+  float const kProfilerWidth = 430;
+  float const kProfilerLineHeight = 16;
+};
+
+typedef BasicBoardRenderer<ClassicTable> BoardRenderer;
+}  // namespace pool
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+
+#include "ball.h"
+#include "player.h"
+#include "stick.h"
+namespace pool {
+using pool::Ball;
+using pool::Player;
+using pool::Stick;
+
+/**
+ * Everything about a game in progress that changes during play, saved by
+ * Board::Save and put back by Board::Restore. It has no pointers so it can be
+ * copied with memcpy and kept in plain arrays, which makes branching from a
+ * board (searching shots, undo) cost a copy instead of allocations.
+ * Table size, simulation mode and broad phase are not part of the state.
+ */
+struct BoardState {
+  // cue ball and the numbered balls of the table spec with the most, the
+  // 21 of SnookerTable
+  constexpr static const size_t kMaxBalls = 22;
+
+  // balls on the board, balls[0] is the cue ball
+  Ball balls[kMaxBalls];
+  size_t num_balls;
+  // numbers of balls the player scored in the order they went in
+  size_t ball_numbers_scored[kMaxBalls];
+  size_t num_ball_numbers_scored;
+  size_t player_score;
+  Ball::Type ball_type_to_score;
+  Player::GameState game_state;
+  // numbers of balls that went in holes since the cue ball was last hit
+  size_t pocketed_this_shot[kMaxBalls];
+  size_t num_pocketed_this_shot;
+  // angle and pull back of the stick
+  Stick stick;
+  bool stick_visible;
+  bool cue_in_hole;
+  double aim_line_length;
+  // part of a frame not yet run by Board::Advance
+  double frame_remainder;
+};
+
+static_assert(std::is_trivially_copyable<BoardState>::value,
+              "BoardState has to be copyable without allocating");
+}  // namespace pool
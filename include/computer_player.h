@@ -0,0 +1,158 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "board.h"
+#include "board_state.h"
+namespace pool {
+using pool::BasicBoard;
+using pool::BoardState;
+using std::vector;
+
+/**
+ * Computer opponent that picks a shot by trying many (angle, power) shots on
+ * copies of the board. Each shot is simulated several times with the angle
+ * and power nudged by random execution noise, and the shot with the best
+ * average outcome under the game rules is chosen. Shots are spread over
+ * worker threads and the search stops when the time budget runs out.
+ */
+template <typename Spec>
+class BasicComputerPlayer {
+ public:
+  // board of the table the player shoots on
+  typedef BasicBoard<Spec> Board;
+
+  /**
+   * Enum for preset strengths of the computer player.
+   * easy : few shots tried, large noise and a short time budget.
+   * medium : more shots and less noise.
+   * hard : many shots, small noise and the longest time budget.
+   */
+  enum Difficulty { easy, medium, hard };
+
+  /**
+   * How hard the computer player searches.
+   */
+  struct Settings {
+    // angles tried, evenly spaced around the cue ball
+    size_t num_angles;
+    // powers tried, evenly spaced from Board::GetMinShotPower to
+    // Board::GetMaxShotPower
+    size_t num_powers;
+    // noisy simulations averaged for each shot
+    size_t samples_per_shot;
+    // standard deviation of the angle (radians) and power the shot is
+    // actually played with
+    double angle_noise;
+    double power_noise;
+    // wall clock time allowed for one ChooseShot
+    double time_budget_seconds;
+    // worker threads, 0 uses every core
+    size_t num_threads;
+  };
+
+  /**
+   * Shot picked by ChooseShot and how the search went.
+   */
+  struct Shot {
+    // angle (in radians) the cue ball travels in, same as
+    // Board::GetShotAngle
+    double angle;
+    // velocity the cue ball is hit with
+    double power;
+    // average score of the shot's samples, higher is better
+    double expected_score;
+    // simulations run, including every sample of every shot tried
+    size_t shots_simulated;
+    // candidate shots that were tried before the budget ran out
+    size_t candidates_tried;
+    // simulations per second of wall clock time across all threads
+    double shots_per_second;
+  };
+
+  /**
+   * Constructor using the preset settings for a difficulty.
+   * @param difficulty easy, medium or hard.
+   */
+  explicit BasicComputerPlayer(Difficulty difficulty);
+
+  /**
+   * Constructor with custom settings.
+   * @param settings how many shots to try and how long to search.
+   * @param seed for the execution noise, the same seed and board give the
+   * same shot as long as the budget doesn't run out.
+   */
+  BasicComputerPlayer(const Settings &settings, unsigned seed);
+
+  /**
+   * Get the preset settings for a difficulty.
+   * @param difficulty easy, medium or hard.
+   * @return settings used by the difficulty constructor.
+   */
+  static Settings GetDifficultySettings(Difficulty difficulty);
+
+  /**
+   * Searches for the best shot from the board, which should have every ball
+   * at rest. The board isn't changed.
+   * @param board to shoot on.
+   * @return best shot found within the time budget.
+   */
+  Shot ChooseShot(const Board &board) const;
+
+  /**
+   * Scores how good a board is for the player after a shot: winning and
+   * losing outweigh everything, then balls scored, then not having to place
+   * the cue ball.
+   * @param before state the shot was played from.
+   * @param after state once the shot is over.
+   * @return score, higher is better.
+   */
+  static double ScoreOutcome(const BoardState &before, const BoardState &after);
+
+  /**
+   * Get the settings the player searches with.
+   * @return settings.
+   */
+  const Settings &GetSettings() const;
+
+ private:
+  /**
+   * Shot to try and its result.
+   */
+  struct Candidate {
+    double angle;
+    double power;
+    double total_score;
+    size_t samples;
+  };
+
+  /**
+   * Runs on each worker thread, taking candidates in order until they run
+   * out or the deadline passes.
+   * @param board copy owned by this worker, restored before every sample.
+   * @param state the search starts from.
+   * @param candidates shared between workers, each is only written by the
+   * worker that took it.
+   * @param next_candidate index of the next candidate nobody has taken.
+   * @param deadline steady clock time to stop taking candidates.
+   */
+  void SearchCandidates(Board &board, const BoardState &state,
+                        vector<Candidate> &candidates,
+                        std::atomic<size_t> &next_candidate,
+                        std::chrono::steady_clock::time_point deadline) const;
+
+  Settings settings_;
+  unsigned seed_;
+  // seed used by the difficulty constructor
+  constexpr static const unsigned kDefaultSeed = 8;
+  // scores for outcomes, a win or loss outweighs any number of balls
+  constexpr static const double kWinScore = 1000;
+  constexpr static const double kLoseScore = -1000;
+  constexpr static const double kBallScore = 10;
+  constexpr static const double kCueInHoleScore = -15;
+};
+
+typedef BasicComputerPlayer<ClassicTable> ComputerPlayer;
+}  // namespace pool
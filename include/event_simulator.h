@@ -0,0 +1,133 @@
+#pragma once
+#include <array>
+#include <vector>
+
+#include "ball.h"
+#include "table_spec.h"
+namespace pool {
+using glm::dvec2;
+using pool::Ball;
+using std::vector;
+
+/**
+ * Class to simulate pool balls by jumping from one event to the next instead
+ * of stepping every frame. Between events every ball follows the closed form
+ * of the friction model (see Ball::MoveFor), so the time of the next
+ * ball-ball, ball-cushion and ball-pocket contact can be solved for exactly.
+ * Time is measured in frames so velocities keep the same units as the frame
+ * stepping simulation.
+ */
+template <typename Spec>
+class BasicEventSimulator {
+ public:
+  typedef std::array<dvec2, Spec::kNumPockets> HolePositions;
+
+  /**
+   * Kinds of events that change how balls are moving.
+   * ball_collision : two balls touch while moving towards each other.
+   * cushion_collision : ball touches a side of the board moving towards it.
+   * pocketed : ball center enters a hole.
+   * came_to_rest : a velocity component of a ball reaches zero.
+   * no_event : nothing happens before the time limit.
+   */
+  enum EventType {
+    ball_collision,
+    cushion_collision,
+    pocketed,
+    came_to_rest,
+    no_event
+  };
+
+  /**
+   * Next thing that happens on the board.
+   * time is measured in frames from the current state.
+   * first is the index of the ball involved, second is the other ball for a
+   * ball collision, or the axis (0 for x, 1 for y) for a cushion collision.
+   */
+  struct Event {
+    EventType type;
+    double time;
+    size_t first;
+    size_t second;
+  };
+
+  /**
+   * Empty constructor.
+   */
+  BasicEventSimulator();
+
+  /**
+   * Constructor for simulator of a board.
+   * @param left_boundary x position of left side of board.
+   * @param right_boundary x position of right side of board.
+   * @param top_boundary y position of top side of board.
+   * @param bottom_boundary y position of bottom side of board.
+   * @param hole_positions center positions of the spec's holes.
+   * @param hole_radius radius of all the holes.
+   */
+  BasicEventSimulator(double left_boundary, double right_boundary,
+                      double top_boundary, double bottom_boundary,
+                      const HolePositions &hole_positions,
+                      double hole_radius);
+
+  /**
+   * Finds the earliest event that happens to the balls within the time limit.
+   * @param balls on the board.
+   * @param time_limit max number of frames to look ahead.
+   * @return next event, no_event with time set to time_limit if nothing
+   * happens before it.
+   */
+  Event FindNextEvent(const vector<Ball> &balls, double time_limit) const;
+
+  /**
+   * Moves all the balls forward in time without any collisions, used to jump
+   * to the time of the next event.
+   * @param balls to move.
+   * @param frames amount of time to move balls for.
+   */
+  static void AdvanceBalls(vector<Ball> &balls, double frames);
+
+  /**
+   * Updates velocities of the balls involved in a collision event. Pocketed
+   * events are left for the board since they depend on the game rules.
+   * @param balls on the board.
+   * @param event that happened at the current time.
+   */
+  static void ResolveEvent(vector<Ball> &balls, const Event &event);
+
+ private:
+  /**
+   * Earliest time the ball touches any side of board while moving towards it.
+   */
+  void FindCushionEvent(const vector<Ball> &balls, size_t index,
+                        Event &event) const;
+
+  /**
+   * Earliest time the ball center enters any of the holes.
+   */
+  void FindPocketEvent(const vector<Ball> &balls, size_t index,
+                       Event &event) const;
+
+  /**
+   * Earliest time two balls touch while moving towards each other.
+   */
+  void FindBallEvent(const vector<Ball> &balls, size_t first, size_t second,
+                     Event &event) const;
+
+  double left_boundary_;
+  double right_boundary_;
+  double top_boundary_;
+  double bottom_boundary_;
+  HolePositions hole_positions_;
+  double hole_radius_;
+  // contact distance is shrunk by this so the balls are guaranteed to
+  // overlap at a collision event, which Ball::HandlePoolBallsColliding needs
+  constexpr static const double kContactTolerance = 1e-6;
+  // touching balls pushing into each other slower than this (center
+  // distance times normal speed, so 1e-3 per frame) are rolling along each
+  // other rather than colliding
+  constexpr static const double kApproachTolerance = 0.025;
+};
+
+typedef BasicEventSimulator<ClassicTable> EventSimulator;
+}  // namespace pool
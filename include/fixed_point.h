@@ -0,0 +1,267 @@
+#pragma once
+#include <cstdint>
+
+#include "ball.h"
+namespace pool {
+using glm::dvec2;
+using pool::Ball;
+
+/**
+ * Signed fixed point number, a 64 bit integer counting 2^-kFractionBits
+ * steps. Every operation is integer arithmetic with the rounding spelled out,
+ * so results are the same bits whatever the compiler, its optimization flags
+ * or the machine, unlike floating point where contraction into fused
+ * multiply adds and library sin/cos can differ.
+ * Values up to 2^43 can be stored, products and quotients have to stay below
+ * 2^23 (a few million) to not overflow. Converting to double is exact.
+ */
+class Fixed {
+ public:
+  // fraction bits, steps are about a millionth of a unit
+  constexpr static int const kFractionBits = 20;
+  constexpr static int64_t const kOne = int64_t(1) << kFractionBits;
+  // pi rounded to the nearest step
+  constexpr static int64_t const kPiRaw = 3294199;
+
+  /**
+   * Zero.
+   */
+  Fixed() : raw_(0) {
+  }
+
+  /**
+   * Nearest fixed point number to a double, halfway cases away from zero.
+   * @param value to convert.
+   * @return rounded value.
+   */
+  static Fixed FromDouble(double value);
+
+  /**
+   * Fixed point number with the given steps.
+   * @param raw number of 2^-kFractionBits steps.
+   * @return number with those steps.
+   */
+  static Fixed FromRaw(int64_t raw) {
+    Fixed fixed;
+    fixed.raw_ = raw;
+    return fixed;
+  }
+
+  /**
+   * Exact double of the number.
+   * @return value as a double.
+   */
+  double ToDouble() const {
+    return (double)raw_ / (double)kOne;
+  }
+
+  /**
+   * Get number of 2^-kFractionBits steps.
+   * @return raw integer.
+   */
+  int64_t GetRaw() const {
+    return raw_;
+  }
+
+  /**
+   * Sine of an angle in radians, from a series evaluated in fixed point.
+   * @param angle in radians, any size.
+   * @return sine to within a few steps.
+   */
+  static Fixed Sin(Fixed angle);
+
+  /**
+   * Cosine of an angle in radians, from a series evaluated in fixed point.
+   * @param angle in radians, any size.
+   * @return cosine to within a few steps.
+   */
+  static Fixed Cos(Fixed angle);
+
+  Fixed operator+(Fixed other) const {
+    return FromRaw(raw_ + other.raw_);
+  }
+  Fixed operator-(Fixed other) const {
+    return FromRaw(raw_ - other.raw_);
+  }
+  Fixed operator-() const {
+    return FromRaw(-raw_);
+  }
+  // products and quotients round to the nearest step, halfway cases away
+  // from zero
+  Fixed operator*(Fixed other) const {
+    return FromRaw(DivideRounded(raw_ * other.raw_, kOne));
+  }
+  Fixed operator/(Fixed other) const {
+    return FromRaw(DivideRounded(raw_ * kOne, other.raw_));
+  }
+  Fixed &operator+=(Fixed other) {
+    raw_ += other.raw_;
+    return *this;
+  }
+  Fixed &operator-=(Fixed other) {
+    raw_ -= other.raw_;
+    return *this;
+  }
+  bool operator==(Fixed other) const {
+    return raw_ == other.raw_;
+  }
+  bool operator!=(Fixed other) const {
+    return raw_ != other.raw_;
+  }
+  bool operator<(Fixed other) const {
+    return raw_ < other.raw_;
+  }
+  bool operator<=(Fixed other) const {
+    return raw_ <= other.raw_;
+  }
+  bool operator>(Fixed other) const {
+    return raw_ > other.raw_;
+  }
+  bool operator>=(Fixed other) const {
+    return raw_ >= other.raw_;
+  }
+
+ private:
+  /**
+   * Integer division rounding to nearest, halfway cases away from zero.
+   */
+  static int64_t DivideRounded(int64_t numerator, int64_t denominator) {
+    int64_t half = (denominator < 0 ? -denominator : denominator) / 2;
+    // division truncates towards zero, so moving the numerator half a
+    // denominator away from zero rounds
+    return (numerator < 0 ? numerator - half : numerator + half) /
+           denominator;
+  }
+
+  int64_t raw_;
+};
+
+/**
+ * Position or velocity in fixed point.
+ */
+struct FixedVec2 {
+  Fixed x;
+  Fixed y;
+
+  /**
+   * Nearest fixed point vector to a double one.
+   */
+  static FixedVec2 FromDouble(const dvec2 &value) {
+    FixedVec2 vector;
+    vector.x = Fixed::FromDouble(value.x);
+    vector.y = Fixed::FromDouble(value.y);
+    return vector;
+  }
+
+  /**
+   * Exact double vector.
+   */
+  dvec2 ToDouble() const {
+    return dvec2(x.ToDouble(), y.ToDouble());
+  }
+};
+
+/**
+ * Frame stepping physics of a Ball in fixed point: the same cushion,
+ * friction, collision and movement rules, with the ball's position and
+ * velocity rounded to Fixed. A ball stored back into a Ball and loaded again
+ * is unchanged, so a board can keep its balls as Balls between frames.
+ * Distances are compared squared, so no square roots are taken.
+ */
+class FixedBall {
+ public:
+  /**
+   * Empty constructor.
+   */
+  FixedBall();
+
+  /**
+   * Rounds the ball's position and velocity to fixed point.
+   * @param ball to load.
+   */
+  explicit FixedBall(const Ball &ball);
+
+  /**
+   * Puts the position and velocity back into a ball, exactly.
+   * @param ball to store into.
+   */
+  void Store(Ball &ball) const;
+
+  /**
+   * Same as Ball::HandleBoardCollision.
+   * @return if ball touched a side.
+   */
+  bool HandleBoardCollision(Fixed right_boundary, Fixed left_boundary,
+                            Fixed top_boundary, Fixed bottom_boundary);
+
+  /**
+   * Same as Ball::DecreaseVelocity, each velocity component moves towards
+   * zero by the friction deceleration and stops at zero.
+   */
+  void DecreaseVelocity();
+
+  /**
+   * Same as Ball::HandlePoolBallsColliding, balls touching and moving into
+   * each other swap the parts of their velocities along the line between
+   * their centers. Centers so close that the squared distance rounds to
+   * zero have no line between them, so they don't collide.
+   * @return if the balls collided.
+   */
+  static bool HandlePoolBallsColliding(FixedBall &ball_one,
+                                       FixedBall &ball_two);
+
+  /**
+   * Same as Ball::Move.
+   */
+  void Move();
+
+  /**
+   * Same as Ball::StickHit with fixed point sine and cosine.
+   * @param angle stick angle in radians.
+   * @param velocity_boost speed given to the ball.
+   */
+  void StickHit(Fixed angle, Fixed velocity_boost);
+
+  /**
+   * Checks if the ball's center is closer than a radius to a point.
+   * @param point to check.
+   * @param radius around the point.
+   * @return if the center is strictly inside.
+   */
+  bool IsCenterWithin(const FixedVec2 &point, Fixed radius) const;
+
+  /**
+   * Checks if two balls' top left corners are within a distance.
+   * @return if they are at most distance apart.
+   */
+  static bool AreWithin(const FixedBall &ball_one, const FixedBall &ball_two,
+                        Fixed distance);
+
+  /**
+   * Get velocity of ball.
+   * @return velocity in fixed point.
+   */
+  const FixedVec2 &GetVelocity() const;
+
+  /**
+   * Checks if the ball has any velocity.
+   * @return if either component isn't zero.
+   */
+  bool IsMoving() const;
+
+ private:
+  /**
+   * Checks if both components of a difference are at most distance and
+   * its squared length is too, the first check keeps the squares small.
+   */
+  static bool IsWithin(Fixed dx, Fixed dy, Fixed distance);
+
+  // Ball's constants rounded once, FromDouble is too slow to call per ball
+  static const Fixed kDiameter;
+  static const Fixed kRadius;
+  static const Fixed kFrictionDeceleration;
+
+  FixedVec2 position_;
+  FixedVec2 velocity_;
+};
+}  // namespace pool
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+namespace pool {
+
+/**
+ * Accumulator that turns the variable time between display frames into a
+ * whole number of fixed length physics steps, so the simulation does the
+ * same thing whatever the refresh rate is.
+ * Time left over that is not enough for a step is carried to the next update
+ * and used to interpolate between the last two physics states when drawing.
+ */
+class FixedTimestep {
+ public:
+  /**
+   * Empty constructor, one step per Ball frame and kDefaultMaxStepsPerUpdate
+   * steps per update at most.
+   */
+  FixedTimestep();
+
+  /**
+   * Constructor for a given physics rate.
+   * @param steps_per_second how many physics steps make up one second.
+   * @param max_steps_per_update most steps run for a single update, time that
+   * would need more steps is dropped so a slow frame can't make the next
+   * frame slower (spiral of death).
+   */
+  FixedTimestep(double steps_per_second, size_t max_steps_per_update);
+
+  /**
+   * Adds time that passed since the last update.
+   * @param elapsed_seconds time since the last update, negative time is
+   * ignored.
+   * @return number of physics steps to run now.
+   */
+  size_t Update(double elapsed_seconds);
+
+  /**
+   * Get how far the leftover time is into the next step, used to draw
+   * positions between the previous and current physics states.
+   * @return value from 0 (previous state) to 1 (current state).
+   */
+  double GetInterpolationFactor() const;
+
+  /**
+   * Get length of one physics step.
+   * @return seconds per step.
+   */
+  double GetStepSeconds() const;
+
+  /**
+   * Get most steps run for a single update.
+   * @return max steps per update.
+   */
+  size_t GetMaxStepsPerUpdate() const;
+
+  /**
+   * Get total time thrown away because an update needed more steps than
+   * allowed.
+   * @return seconds dropped since constructed or reset.
+   */
+  double GetDroppedSeconds() const;
+
+  /**
+   * Clears leftover and dropped time, used when the game restarts.
+   */
+  void Reset();
+
+  constexpr static const size_t kDefaultMaxStepsPerUpdate = 8;
+
+ private:
+  double step_seconds_;
+  size_t max_steps_per_update_;
+  // time not yet simulated, less than one step after each update
+  double accumulator_ = 0;
+  double dropped_seconds_ = 0;
+};
+}  // namespace pool
@@ -3,8 +3,9 @@
 //
 
 #pragma once
+#include <vector>
+
 #include "ball.h"
-#include "cinder/gl/gl.h"
 namespace pool {
 using pool::Ball;
 using std::vector;
@@ -34,13 +35,6 @@ class Player {
    */
   void AddBallScore();
 
-  /**
-   * Displays balls scored by player above game board
-   * so they remember which ones they need to win.
-   * @param images to draw each ball player scored.
-   */
-  void DisplayBalls(vector<ci::gl::Texture2dRef> images) const;
-
   /**
    * Adds the number of the ball that the player scored to vector
    * which keeps track of these numbers to display above game board.
@@ -54,7 +48,7 @@ class Player {
    * should be empty at start of game.
    * @return vector of ball numbers the player scored.
    */
-  vector<size_t> GetBallNumbers() const;
+  const vector<size_t> &GetBallNumbers() const;
 
   /**
    * The ball type that is determined when the player first scores
@@ -78,6 +72,13 @@ class Player {
    */
   size_t GetPlayerScore() const;
 
+  /**
+   * Set the number of balls the player has scored, used when a saved board is
+   * restored.
+   * @param score number of balls scored.
+   */
+  void SetPlayerScore(size_t score);
+
   /**
    * Set the game state of the player, used to change game state of player after
    * winning or losing.
@@ -113,8 +114,6 @@ class Player {
   // so player can play again after losing/ winning
   // and have access to controls when in playing state
   GameState state_;
-  // set space between balls the player scored in display above pool board
-  double const kSpaceBetweenBalls = 100;
 };
 
 }  // namespace pool
\ No newline at end of file
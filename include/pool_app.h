@@ -6,13 +6,31 @@
 #define FINAL_PROJECT_NKONJETI_POOL_APP_H
 
 #endif  // FINAL_PROJECT_NKONJETI_POOL_APP_H
+#include <future>
+
+#include "asset_cache.h"
 #include "board.h"
+#include "board_renderer.h"
+#include "computer_player.h"
+#include "fixed_timestep.h"
+#include "profiler.h"
+#include "replay.h"
+#include "replay_writer.h"
+#include "simulation_thread.h"
 #include "cinder/app/App.h"
 #include "cinder/app/RendererGl.h"
 #include "cinder/gl/Texture.h"
 #include "cinder/gl/gl.h"
 namespace pool {
+using pool::AssetCache;
 using pool::Board;
+using pool::BoardRenderer;
+using pool::ComputerPlayer;
+using pool::FixedTimestep;
+using pool::Profiler;
+using pool::Replay;
+using pool::ReplayWriter;
+using pool::SimulationThread;
 /**
  * An app for playing pool.
  */
@@ -21,20 +39,20 @@ class PoolApp : public ci::app::App {
   PoolApp();
 
   /**
-   * Balls are created in this method.
+   * Ball images are uploaded to the renderer and the simulation thread
+   * started in this method. A replay file passed as the first command line
+   * argument is played back instead of starting a new game.
    */
   void setup() override;
 
   /**
-   * Balls, board, stick, holes are drawn.
+   * Balls, board, stick, holes are drawn from the latest board published by
+   * the simulation thread. A shot the computer player has finished choosing
+   * is sent to the simulation thread. Ends the profiler's frame and draws
+   * its overlay when it is recording.
    */
   void draw() override;
 
-  /**
-   * Ball positions and stick angle are updated.
-   */
-  void update() override;
-
   /**
    * Method used to drag cue ball by changing its position
    * after getting hit into hole.
@@ -48,26 +66,65 @@ class PoolApp : public ci::app::App {
   void mouseUp(ci::app::MouseEvent event) override;
 
   /**
-   * Method used to determine stick action
+   * Method used to send stick action to the simulation thread
    * RIGHT ARROW -> rotate to the right
    * LEFT ARROW -> rotate to the left
    * UP ARROW -> shoot cue ball
    * DOWN ARROW -> to pull cue stick back for more power
-   * SPACE -> restart game when game ends
+   * C -> computer player takes the shot
+   * R -> replay the current game from the start
+   * P -> start or stop profiling and show the profiler overlay
+   * T -> write the profiler's trace to kTracePath while profiling
+   * SPACE -> restart game when game ends, keeping the loaded images
    * @param event to determine stick action.
    */
   void keyDown(ci::app::KeyEvent event) override;
 
   const int kWindowSize = 1000;
+  // physics rate, lower it on slow machines, outcomes don't depend on it in
+  // frame stepping mode
+  const double kPhysicsStepsPerSecond = 1.0 / Ball::kSecondsPerFrame;
+  // most physics steps run at once when the simulation falls behind, before
+  // time is dropped
+  const size_t kMaxPhysicsStepsPerUpdate = 8;
+  // every game is recorded to this path followed by its number
+  const string kReplayPathPrefix = "replay_";
+  // Chrome trace written by the T key, open in chrome://tracing
+  const string kTracePath = "pool_trace.json";
 
  private:
-  Board board_;
-  // image paths for loading images
-  vector<string> kBallImagePaths = {
+  /**
+   * Sends a command to the simulation thread after any that are still
+   * waiting. Commands that don't fit in its queue are kept and sent again
+   * every frame until they do, so input is never dropped.
+   * @param command to send.
+   */
+  void SendCommand(const SimulationThread::Command &command);
+
+  /**
+   * Sends the waiting commands in order until the queue is full.
+   */
+  void SendUnsentCommands();
+
+  // decoded ball images, decoding starts on worker threads as soon as the
+  // app is made
+  AssetCache<ci::SurfaceRef> images_;
+  // writes the recorded games, outlives the simulation thread that feeds it
+  ReplayWriter replay_writer_;
+  // steps the board on its own thread, input is sent to it as commands
+  SimulationThread simulation_;
+  // draws the board state each frame
+  BoardRenderer renderer_;
+  // chooses shots when the player asks the computer to play
+  ComputerPlayer computer_;
+  // shot being chosen on another thread, invalid when none is
+  std::future<ComputerPlayer::Shot> computer_shot_;
+  // commands the simulation thread's queue had no room for, oldest first
+  vector<SimulationThread::Command> unsent_commands_;
+  // image paths for loading images, indexed by ball number
+  const vector<string> kBallImagePaths = {
       "cue_ball.png", "1.png", "2.png", "3.png", "4.png", "5.png",
       "6.png", "7.png",  "8.png", "9.png", "10.png", "11.png",
       "12.png", "13.png", "14.png", "15.png"};
-  // contains images of all the pool balls
-  vector<ci::gl::Texture2dRef> images_;
 };
 }  // namespace pool
@@ -0,0 +1,273 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <vector>
+namespace pool {
+using std::vector;
+
+/**
+ * Collects how long scopes of the update and draw take and counts things per
+ * frame (collision pairs, draw calls), for the profiler overlay and for
+ * Chrome trace files (chrome://tracing or https://ui.perfetto.dev).
+ * Recording is off until enabled, then every scope takes a lock, so leave it
+ * off when not looking at the numbers. While off a scope costs one relaxed
+ * atomic load, and building with POOL_DISABLE_PROFILER removes the scopes.
+ * Scopes can be recorded from any thread, and a thread can pause its own
+ * recording with ScopedProfilerPause.
+ */
+class Profiler {
+ public:
+  /**
+   * Rolling numbers for a scope or counter over the last kHistoryFrames
+   * frames.
+   */
+  struct Stats {
+    // name given to the scope or counter
+    const char *name;
+    // true for counters, false for scopes timed in milliseconds
+    bool is_counter;
+    // total for the last frame that ended
+    double last;
+    // average of the frame totals
+    double average;
+    // highest frame total
+    double worst;
+  };
+
+  /**
+   * Profiler that isn't recording.
+   */
+  Profiler();
+
+  /**
+   * Get the profiler the POOL_PROFILE macros record to.
+   * @return profiler shared by the whole program.
+   */
+  static Profiler &GetInstance();
+
+  /**
+   * Turns recording on or off, what was recorded is kept.
+   * @param enabled true to record.
+   */
+  void SetEnabled(bool enabled);
+
+  /**
+   * Get if scopes and counts are being recorded.
+   * @return true if recording.
+   */
+  bool IsEnabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Get if scopes and counts from the calling thread are recorded, which
+   * they aren't while it is paused.
+   * @return true if enabled and the thread isn't paused.
+   */
+  bool IsRecording() const {
+    return IsEnabled() && !IsThreadPaused();
+  }
+
+  /**
+   * Get if the calling thread is in a ScopedProfilerPause.
+   * @return true if paused.
+   */
+  static bool IsThreadPaused();
+
+  /**
+   * Get time since the profiler was made.
+   * @return nanoseconds.
+   */
+  uint64_t GetNanoseconds() const;
+
+  /**
+   * Records a timed scope, does nothing if not recording on this thread.
+   * @param name string literal naming the scope, "area/what" by convention.
+   * @param start_ns start from GetNanoseconds.
+   * @param end_ns end from GetNanoseconds.
+   */
+  void RecordScope(const char *name, uint64_t start_ns, uint64_t end_ns);
+
+  /**
+   * Adds to a counter for the current frame if recording on this thread.
+   * @param name string literal naming the counter.
+   * @param value added to this frame's total.
+   */
+  void AddCount(const char *name, double value) {
+    if (IsRecording()) {
+      AddCountRecording(name, value);
+    }
+  }
+
+  /**
+   * Ends the frame, adding each scope's and counter's frame total to its
+   * history and to the trace.
+   */
+  void EndFrame();
+
+  /**
+   * Get the rolling numbers of everything recorded, scopes first, each
+   * sorted by name.
+   * @return stats of every scope and counter.
+   */
+  vector<Stats> GetStats() const;
+
+  /**
+   * Writes the last kMaxTraceEvents scopes and frame counters in the Chrome
+   * trace event format.
+   * @param output stream to write the JSON to.
+   */
+  void WriteChromeTrace(std::ostream &output) const;
+
+  /**
+   * Forgets everything recorded.
+   */
+  void Clear();
+
+  // frames the rolling numbers are taken over
+  constexpr static const size_t kHistoryFrames = 120;
+  // events kept for the trace, older ones are overwritten
+  constexpr static const size_t kMaxTraceEvents = 1 << 16;
+
+ private:
+  /**
+   * Scope or counter value in the trace.
+   */
+  struct TraceEvent {
+    const char *name;
+    bool is_counter;
+    uint32_t thread;
+    uint64_t start_ns;
+    // for scopes
+    uint64_t duration_ns;
+    // for counters
+    double value;
+  };
+
+  /**
+   * Frame totals of a scope or counter.
+   */
+  struct Series {
+    bool is_counter = false;
+    // total of the frame not ended yet
+    double current = 0;
+    // totals of the last frames, history[frames % kHistoryFrames] is next
+    double history[kHistoryFrames] = {};
+  };
+
+  /**
+   * Orders names by their text, literals with the same text can have
+   * different addresses.
+   */
+  struct NameLess {
+    bool operator()(const char *first, const char *second) const {
+      return std::strcmp(first, second) < 0;
+    }
+  };
+
+  /**
+   * AddCount when recording.
+   */
+  void AddCountRecording(const char *name, double value);
+
+  /**
+   * Adds an event to the trace, overwriting the oldest once full.
+   */
+  void AddTraceEvent(const TraceEvent &event);
+
+  std::atomic<bool> enabled_;
+  // steady clock time the profiler was made, in nanoseconds
+  uint64_t epoch_ns_;
+
+  mutable std::mutex mutex_;
+  std::map<const char *, Series, NameLess> series_;
+  // frames ended, at most kHistoryFrames of them are in the history
+  size_t num_frames_ = 0;
+  vector<TraceEvent> trace_;
+  size_t next_trace_event_ = 0;
+};
+
+/**
+ * Times the scope it is declared in, use POOL_PROFILE_SCOPE.
+ */
+class ScopedTimer {
+ public:
+  /**
+   * Starts timing if the profiler is recording.
+   * @param name string literal naming the scope.
+   * @param profiler to record to.
+   */
+  explicit ScopedTimer(const char *name,
+                       Profiler &profiler = Profiler::GetInstance())
+      : profiler_(profiler),
+        name_(name),
+        active_(profiler.IsRecording()),
+        start_ns_(active_ ? profiler.GetNanoseconds() : 0) {
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+  /**
+   * Records the scope.
+   */
+  ~ScopedTimer() {
+    if (active_) {
+      profiler_.RecordScope(name_, start_ns_, profiler_.GetNanoseconds());
+    }
+  }
+
+ private:
+  Profiler &profiler_;
+  const char *name_;
+  bool active_;
+  uint64_t start_ns_;
+};
+
+/**
+ * Stops the calling thread recording to any profiler while it is in scope,
+ * use POOL_PROFILE_PAUSE. Meant for work that isn't part of the frame, like
+ * simulating shots that are never played, which would otherwise swamp the
+ * frame's numbers and the trace. Pauses can be nested.
+ */
+class ScopedProfilerPause {
+ public:
+  /**
+   * Pauses recording on the calling thread.
+   */
+  ScopedProfilerPause();
+
+  ScopedProfilerPause(const ScopedProfilerPause &) = delete;
+  ScopedProfilerPause &operator=(const ScopedProfilerPause &) = delete;
+
+  /**
+   * Resumes recording unless an outer pause is still in scope.
+   */
+  ~ScopedProfilerPause();
+};
+}  // namespace pool
+
+#define POOL_PROFILE_CONCAT_INNER(first, second) first##second
+#define POOL_PROFILE_CONCAT(first, second) \
+  POOL_PROFILE_CONCAT_INNER(first, second)
+
+#ifdef POOL_DISABLE_PROFILER
+#define POOL_PROFILE_SCOPE(name)
+#define POOL_PROFILE_COUNT(name, value)
+#define POOL_PROFILE_PAUSE()
+#else
+// times the rest of the enclosing scope
+#define POOL_PROFILE_SCOPE(name) \
+  pool::ScopedTimer POOL_PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+// adds value to a counter for the current frame
+#define POOL_PROFILE_COUNT(name, value) \
+  pool::Profiler::GetInstance().AddCount(name, value)
+// stops this thread recording for the rest of the enclosing scope
+#define POOL_PROFILE_PAUSE() \
+  pool::ScopedProfilerPause POOL_PROFILE_CONCAT(profile_pause_, __LINE__)
+#endif
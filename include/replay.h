@@ -0,0 +1,280 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "board.h"
+#include "board_state.h"
+namespace pool {
+using glm::dvec2;
+using pool::Ball;
+using pool::BasicBoard;
+using pool::BoardState;
+using std::vector;
+
+/**
+ * Record of a game as the balls it started with and the inputs that changed
+ * the board, each tagged with the physics step it was applied before.
+ * Playing the inputs back at the same steps with the same step length runs
+ * the exact same calculations, so the game is reproduced bit for bit without
+ * storing any ball motion.
+ * Keyframes of the whole board every so many steps let a viewer seek to any
+ * step by restoring the keyframe before it and simulating only the rest, so
+ * seeking costs at most one keyframe interval of steps however long the game
+ * is.
+ *
+ * File format, numbers are little endian:
+ *   header : "PREP", version (u8), simulation mode (u8), frames per step
+ *   (f64), number of balls (u8), then for each ball its number (u8), type
+ *   (u8) and position (2 x f64)
+ *   records until the end of the file : type (u8), steps since the last
+ *   record (u32), then
+ *     shot : angle and power (2 x f64)
+ *     cue_position, cue_placement : position of the cue ball (2 x f64)
+ *     keyframe : number of balls (u8), for each ball its number (u8), type
+ *     (u8), position, velocity (4 x f64) and velocity boost (f64), number of
+ *     balls scored (u8) and their numbers (u8 each), score (u32), ball type
+ *     to score (u8), game state (u8), number of balls pocketed this shot
+ *     (u8) and their numbers (u8 each), stick visible (u8), cue ball in hole
+ *     (u8), frame remainder (f64)
+ * Version 1 files have no keyframes and are read the same way. Version 3
+ * added the fixed_point simulation mode, the format is otherwise the same as
+ * version 2, so older readers reject those files instead of misreading the
+ * mode.
+ * The table isn't stored, a replay is read and played by the BasicReplay of
+ * the table spec it was recorded on.
+ */
+template <typename Spec>
+class BasicReplay {
+ public:
+  // board of the table the game is played on
+  typedef BasicBoard<Spec> Board;
+
+  /**
+   * Enum for inputs that change the board.
+   * shot : cue ball is hit at angle with power.
+   * cue_position : cue ball is dragged to position after being pocketed.
+   * cue_placement : cue ball is dropped at position after being pocketed.
+   */
+  enum InputType { shot, cue_position, cue_placement };
+
+  /**
+   * Input applied to the board.
+   */
+  struct Input {
+    InputType type;
+    // physics steps run since the game started when the input was applied
+    uint64_t step;
+    // used by shot
+    double angle;
+    double power;
+    // used by cue_position and cue_placement
+    dvec2 position;
+  };
+
+  /**
+   * Board state at a step, saved so playing back can start from it.
+   */
+  struct Keyframe {
+    // physics steps run since the game started, inputs of this step haven't
+    // been applied yet
+    uint64_t step;
+    // stick and aim line aren't kept since playing back doesn't change them
+    BoardState state;
+  };
+
+  /**
+   * Empty replay with no balls, filled in by Read.
+   */
+  BasicReplay();
+
+  /**
+   * Starts a replay of a game from the board's current balls.
+   * @param board at the start of the game.
+   * @param frames_per_step length of the physics steps the game runs at.
+   */
+  BasicReplay(const Board &board, double frames_per_step);
+
+  /**
+   * Adds an input after the ones already recorded.
+   * @param input applied to the board, its step can't be before the last
+   * input's.
+   */
+  void AddInput(const Input &input);
+
+  /**
+   * Adds a keyframe after the ones already recorded.
+   * @param keyframe of the board, its step has to be after the last
+   * keyframe's and can't be before the last input's.
+   */
+  void AddKeyframe(const Keyframe &keyframe);
+
+  /**
+   * Makes room for inputs and keyframes so adding up to these many doesn't
+   * allocate.
+   * @param num_inputs inputs to make room for in total.
+   * @param num_keyframes keyframes to make room for in total.
+   */
+  void Reserve(size_t num_inputs, size_t num_keyframes);
+
+  /**
+   * Get the balls the game started with.
+   * @return balls at the start of the game.
+   */
+  const vector<Ball> &GetInitialBalls() const;
+
+  /**
+   * Get the recorded inputs in the order they were applied.
+   * @return inputs.
+   */
+  const vector<Input> &GetInputs() const;
+
+  /**
+   * Get the keyframes in step order, the index used for seeking.
+   * @return keyframes.
+   */
+  const vector<Keyframe> &GetKeyframes() const;
+
+  /**
+   * Get how the game's ball motion was simulated.
+   * @return simulation mode.
+   */
+  typename Board::SimulationMode GetSimulationMode() const;
+
+  /**
+   * Get the length of the physics steps the game ran at.
+   * @return step length in frames.
+   */
+  double GetFramesPerStep() const;
+
+  /**
+   * Writes the whole replay in the file format, stopping at the first
+   * record with a value too big for its field.
+   * @param output stream opened in binary mode.
+   * @return false if a value didn't fit, the records before it are written.
+   */
+  bool Write(std::ostream &output) const;
+
+  /**
+   * Replaces this replay with one read from a stream. A file cut short while
+   * being written keeps the inputs before the cut.
+   * @param input stream opened in binary mode.
+   * @return false if the header is missing or not a replay, or a record
+   * has an unknown type or a value out of range.
+   */
+  bool Read(std::istream &input);
+
+  /**
+   * Writes the header for a game, used to write a replay as it is
+   * recorded.
+   * @param output stream opened in binary mode.
+   * @param mode simulation mode of the game.
+   * @param frames_per_step length of the physics steps.
+   * @param balls at the start of the game.
+   * @return false and nothing is written if there are more than 255 balls
+   * or a ball number doesn't fit in a byte.
+   */
+  static bool WriteHeader(std::ostream &output,
+                          typename Board::SimulationMode mode,
+                          double frames_per_step, const vector<Ball> &balls);
+
+  /**
+   * Writes an input after the header or the last input.
+   * @param output stream opened in binary mode.
+   * @param input to write.
+   * @param previous_step step of the last input written, 0 for the first.
+   * @return false and nothing is written if the input is before the
+   * previous step or more than 2^32 - 1 steps after it.
+   */
+  static bool WriteInput(std::ostream &output, const Input &input,
+                         uint64_t previous_step);
+
+  /**
+   * Writes a keyframe after the header or the last record.
+   * @param output stream opened in binary mode.
+   * @param keyframe to write.
+   * @param previous_step step of the last record written, 0 for the first.
+   * @return false and nothing is written if the step is out of range like
+   * for WriteInput, or a count, ball number or the score doesn't fit.
+   */
+  static bool WriteKeyframe(std::ostream &output, const Keyframe &keyframe,
+                            uint64_t previous_step);
+
+  /**
+   * Resets the board to the start of the game.
+   * @param board to reset, set to the game's simulation mode.
+   */
+  void Begin(Board &board) const;
+
+  /**
+   * Applies an input the same way as when it was recorded.
+   * @param board to change.
+   * @param input to apply.
+   */
+  static void Apply(Board &board, const Input &input);
+
+  /**
+   * Plays the whole game without a display: resets the board, steps it,
+   * applies every input at its step and runs on until the balls stop after
+   * the last one.
+   * @param board to play on.
+   * @return number of physics steps run.
+   */
+  uint64_t Play(Board &board) const;
+
+  /**
+   * Puts the board in the state it was in after a number of physics steps,
+   * before the inputs of that step. Starts from the last keyframe at or
+   * before the step so at most one keyframe interval is simulated.
+   * @param board to put in the state, set to the game's simulation mode.
+   * @param step physics steps since the game started.
+   * @return number of physics steps simulated to get there.
+   */
+  uint64_t Seek(Board &board, uint64_t step) const;
+
+  /**
+   * Replaces the keyframes by playing the game through, used for replays
+   * recorded without them or to change how often they are kept.
+   * @param board to play on, the table the game was played on.
+   * @param interval physics steps between keyframes, 0 for none.
+   */
+  void BuildKeyframes(Board &board, uint64_t interval);
+
+  // physics steps between keyframes when recording, a keyframe takes about
+  // 700 bytes and seeking simulates up to this many steps
+  constexpr static const uint64_t kDefaultKeyframeInterval = 256;
+
+ private:
+  /**
+   * Plays the whole game, see Play.
+   * @param board to play on.
+   * @param keyframe_interval physics steps between keyframes to save, 0 for
+   * none.
+   * @param keyframes saved keyframes are added to, can be null when there
+   * are none to save.
+   * @return number of physics steps run.
+   */
+  uint64_t Play(Board &board, uint64_t keyframe_interval,
+                vector<Keyframe> *keyframes) const;
+
+  /**
+   * Applies the inputs recorded at or before a step that haven't been yet.
+   * @param board to change.
+   * @param step physics steps since the game started.
+   * @param next_input index of the first input not applied, moved past the
+   * ones applied.
+   */
+  void ApplyInputs(Board &board, uint64_t step, size_t &next_input) const;
+
+  vector<Ball> initial_balls_;
+  vector<Input> inputs_;
+  vector<Keyframe> keyframes_;
+  typename Board::SimulationMode simulation_mode_;
+  double frames_per_step_;
+  // safety limit for Play so a damaged replay can't run forever
+  constexpr static const uint64_t kMaxStepsAfterLastInput = 1000000;
+};
+
+typedef BasicReplay<ClassicTable> Replay;
+}  // namespace pool
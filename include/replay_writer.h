@@ -0,0 +1,165 @@
+#pragma once
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "replay.h"
+#include "spsc_queue.h"
+namespace pool {
+using pool::Ball;
+using pool::BasicReplay;
+using std::string;
+
+/**
+ * Writes replays to files on its own thread so recording never waits on the
+ * disk. Games and inputs are queued from one thread (the simulation thread)
+ * through a lock free queue and written out by the writer thread, every game
+ * to a new numbered file.
+ */
+template <typename Spec>
+class BasicReplayWriter {
+ public:
+  // replay the files are written as and the board it is recorded from
+  typedef BasicReplay<Spec> Replay;
+  typedef typename Replay::Board Board;
+
+  /**
+   * Constructor for writer naming files path_prefix followed by the game
+   * number and kFileExtension. The thread isn't started yet.
+   * @param path_prefix start of the path of every file.
+   */
+  explicit BasicReplayWriter(const string &path_prefix);
+
+  /**
+   * Stops the thread after writing everything queued.
+   */
+  ~BasicReplayWriter();
+
+  /**
+   * Starts writing queued games and inputs on a new thread.
+   */
+  void Start();
+
+  /**
+   * Writes everything queued, closes the file and stops the thread.
+   */
+  void Stop();
+
+  /**
+   * Queues the start of a new game, later inputs go to its file.
+   * @param board at the start of the game.
+   * @param frames_per_step length of the physics steps the game runs at.
+   * @return false if the queue didn't have room for the game, none of its
+   * inputs are recorded then.
+   */
+  bool BeginGame(const Board &board, double frames_per_step);
+
+  /**
+   * Queues an input of the current game. Once an input is dropped the rest
+   * of the game is dropped too, and an input the file format can't hold
+   * (see Replay::WriteInput) ends the game's file when it is written.
+   * @param input applied to the board.
+   * @return false if the input was dropped.
+   */
+  bool Record(const typename Replay::Input &input);
+
+  /**
+   * Queues a keyframe of the current game. A dropped keyframe only makes
+   * seeking slower, the rest of the game is still recorded.
+   * @param keyframe of the board, after the inputs already recorded.
+   * @return false if the keyframe was dropped.
+   */
+  bool RecordKeyframe(const typename Replay::Keyframe &keyframe);
+
+  /**
+   * Get path of the file a game is written to.
+   * @param game_number 0 for the first game begun.
+   * @return path of the file.
+   */
+  string GetPath(size_t game_number) const;
+
+  /**
+   * Get number of games begun, counting ones that couldn't be queued.
+   * @return number of games.
+   */
+  size_t GetGameCount() const;
+
+  /**
+   * Get number of games, inputs and keyframes that couldn't be queued
+   * because the writer fell behind.
+   * @return number of records dropped.
+   */
+  size_t GetDroppedCount() const;
+
+  // extension of every replay file
+  constexpr static const char *kFileExtension = ".poolreplay";
+  // items that can wait to be written, a game takes one per ball to start
+  constexpr static const size_t kQueueCapacity = 1024;
+  // keyframes that can wait to be written, they are large and only come
+  // every few seconds so they get their own small queue
+  constexpr static const size_t kKeyframeQueueCapacity = 8;
+
+ private:
+  /**
+   * Enum for what a queued item holds.
+   * new_game : game settings and number of balls that follow.
+   * initial_ball : ball the game starts with.
+   * game_input : input of the current game.
+   * game_keyframe : next keyframe in the keyframe queue goes here.
+   */
+  enum ItemType { new_game, initial_ball, game_input, game_keyframe };
+
+  /**
+   * Item passed from the recording thread to the writer thread.
+   */
+  struct Item {
+    ItemType type;
+    // used by new_game
+    size_t game_number;
+    typename Board::SimulationMode mode;
+    double frames_per_step;
+    size_t num_balls;
+    // used by initial_ball
+    Ball ball;
+    // used by game_input
+    typename Replay::Input input;
+  };
+
+  /**
+   * Loop run on the thread until stopped.
+   */
+  void Run();
+
+  /**
+   * Writes out every queued item.
+   */
+  void WriteQueued();
+
+  string path_prefix_;
+  SpscQueue<Item, kQueueCapacity> items_;
+  SpscQueue<typename Replay::Keyframe, kKeyframeQueueCapacity> keyframes_;
+  // only used by the recording thread
+  size_t num_games_ = 0;
+  // set when a record of the current game was dropped, the rest of the game
+  // isn't recorded since it couldn't be played back
+  bool game_dropped_ = false;
+  std::atomic<size_t> num_dropped_;
+  // only used by the writer thread once started
+  std::ofstream file_;
+  // header is written once all of a game's balls have arrived
+  vector<Ball> pending_balls_;
+  size_t num_pending_balls_ = 0;
+  size_t pending_game_number_ = 0;
+  typename Board::SimulationMode pending_mode_ = Board::frame_stepping;
+  double pending_frames_per_step_ = 1;
+  uint64_t last_step_ = 0;
+
+  std::atomic<bool> running_;
+  std::thread thread_;
+  // time the writer thread waits when there is nothing to write
+  constexpr static const double kIdleSeconds = 0.005;
+};
+
+typedef BasicReplayWriter<ClassicTable> ReplayWriter;
+}  // namespace pool
@@ -0,0 +1,246 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "board.h"
+#include "fixed_timestep.h"
+#include "replay.h"
+#include "replay_writer.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+namespace pool {
+using pool::BasicBoard;
+using pool::BasicReplay;
+using pool::BasicReplayWriter;
+using pool::FixedTimestep;
+
+/**
+ * Runs the board simulation on its own thread so slow physics can't hold up
+ * drawing or input. Input is sent as commands through a lock free queue and
+ * the board is published after every step through a triple buffer, so the
+ * app thread never waits on the simulation thread.
+ * Commands are sent and snapshots read from one thread only (the app thread).
+ * Every game is recorded as a Replay, which can be played back on the board.
+ */
+template <typename Spec>
+class BasicSimulationThread {
+ public:
+  // board simulated and how its games are recorded
+  typedef BasicBoard<Spec> Board;
+  typedef BasicReplay<Spec> Replay;
+  typedef BasicReplayWriter<Spec> ReplayWriter;
+
+  /**
+   * Enum for input that changes the board.
+   * rotate_right, rotate_left, pull_back, hit : stick actions.
+   * set_cue_position : cue ball is being dragged to position.
+   * reposition_cue : cue ball is dropped at position.
+   * reset : balls, player and stick start over.
+   * shoot : cue ball is hit at angle with power without the stick, for the
+   * computer player.
+   * replay : current game starts over and plays back what has happened so
+   * far.
+   */
+  enum CommandType {
+    rotate_right,
+    rotate_left,
+    pull_back,
+    hit,
+    set_cue_position,
+    reposition_cue,
+    reset,
+    shoot,
+    replay
+  };
+
+  /**
+   * Input sent to the simulation thread.
+   */
+  struct Command {
+    CommandType type;
+    // only used by set_cue_position and reposition_cue
+    dvec2 position;
+    // only used by shoot
+    double angle;
+    double power;
+  };
+
+  /**
+   * Board as of a physics step, read by the app to draw.
+   */
+  struct Snapshot {
+    Board board;
+    // when the step finished, used to interpolate until the next one
+    std::chrono::steady_clock::time_point time;
+    // number of steps run so far
+    size_t step;
+  };
+
+  /**
+   * Constructor with the board to simulate, the thread isn't started yet.
+   * @param board to simulate, balls should already be created.
+   * @param timestep physics rate and max steps per update.
+   */
+  BasicSimulationThread(const Board &board, const FixedTimestep &timestep);
+
+  /**
+   * Stops the thread if it is running.
+   */
+  ~BasicSimulationThread();
+
+  /**
+   * Sets where games are written as they are played, before the thread is
+   * started.
+   * @param writer already started, has to outlive the simulation thread.
+   */
+  void SetReplayWriter(ReplayWriter *writer);
+
+  /**
+   * Sets how often keyframes of the board are recorded, before the thread is
+   * started. Makes room for the keyframes of a long game up front.
+   * @param interval physics steps between keyframes, 0 for none.
+   */
+  void SetKeyframeInterval(uint64_t interval);
+
+  /**
+   * Starts playing a replay on the board in place of a new game, before the
+   * thread is started. Input is ignored until the replay is over, then the
+   * game carries on as normal.
+   * @param replay to play.
+   * @return false if the thread was already running and nothing changed.
+   */
+  bool LoadReplay(const Replay &replay);
+
+  /**
+   * Get if a replay is being played back.
+   * @return true until the replay's last input has been applied.
+   */
+  bool IsPlayingBack() const;
+
+  /**
+   * Starts stepping the board on a new thread.
+   */
+  void Start();
+
+  /**
+   * Stops the thread and waits for it to finish its step.
+   */
+  void Stop();
+
+  /**
+   * Queues input for the simulation thread.
+   * @param type of command.
+   * @param position used by cue ball commands.
+   * @return false if the queue was full and the command was dropped.
+   */
+  bool Send(CommandType type, const dvec2 &position = dvec2(0, 0));
+
+  /**
+   * Queues a shoot command for the simulation thread, ignored if a shot is
+   * already in progress.
+   * @param angle (in radians) cue ball travels in.
+   * @param power velocity the cue ball is hit with.
+   * @return false if the queue was full and the command was dropped.
+   */
+  bool SendShot(double angle, double power);
+
+  /**
+   * Picks up the latest published board if there is a new one.
+   * @return latest snapshot, stays valid until the next call.
+   */
+  const Snapshot &GetLatestSnapshot();
+
+  /**
+   * Get how far the time now is between the snapshot's step and the next
+   * step, to draw balls between them.
+   * @param snapshot from GetLatestSnapshot.
+   * @return value from 0 to 1.
+   */
+  double GetInterpolationFactor(const Snapshot &snapshot) const;
+
+  /**
+   * Runs everything the thread does in one loop: applies waiting commands,
+   * advances the board by the steps elapsed_seconds makes up and publishes
+   * it. Used by the thread and by tests that need to control time.
+   * @param elapsed_seconds time since the last call.
+   * @return number of steps run.
+   */
+  size_t RunOnce(double elapsed_seconds);
+
+  // commands that can wait before the oldest is handled
+  constexpr static const size_t kCommandQueueCapacity = 64;
+  // the recording has room for the keyframes of a game this many steps long
+  // and this many inputs, so recording them doesn't allocate; longer games
+  // still record, growing the recording as they go
+  constexpr static const uint64_t kReservedGameSteps = 1 << 16;
+  constexpr static const size_t kReservedInputs = 1024;
+
+ private:
+  /**
+   * Loop run on the thread until stopped.
+   */
+  void Run();
+
+  /**
+   * Changes the board for a command.
+   */
+  void Apply(const Command &command);
+
+  /**
+   * Applies an input to the board and records it.
+   */
+  void ApplyInput(typename Replay::Input input);
+
+  /**
+   * Records a keyframe if the game has run a whole number of keyframe
+   * intervals.
+   */
+  void RecordKeyframe();
+
+  /**
+   * Starts recording a game from the board's balls.
+   */
+  void BeginGame(double frames_per_step);
+
+  /**
+   * Makes room in the recording for kReservedInputs inputs and the
+   * keyframes of kReservedGameSteps steps.
+   */
+  void ReserveRecording();
+
+  /**
+   * Resets the board to the start of the replay and plays it back from the
+   * next step.
+   */
+  void BeginPlayback(const Replay &replay);
+
+  /**
+   * Copies the board into the back buffer and publishes it.
+   */
+  void Publish();
+
+  // only touched by the simulation thread once started
+  Board board_;
+  FixedTimestep timestep_;
+  size_t step_ = 0;
+  // game being played, recorded as it goes
+  Replay recording_;
+  ReplayWriter *replay_writer_ = nullptr;
+  uint64_t keyframe_interval_ = Replay::kDefaultKeyframeInterval;
+  // step the game started at and the frames each of its steps runs
+  size_t game_start_step_ = 0;
+  double game_frames_per_step_;
+  // replay being played back and its next input
+  Replay playback_;
+  size_t next_playback_input_ = 0;
+  std::atomic<bool> playing_back_;
+
+  SpscQueue<Command, kCommandQueueCapacity> commands_;
+  TripleBuffer<Snapshot> snapshots_;
+  std::atomic<bool> running_;
+  std::thread thread_;
+};
+
+typedef BasicSimulationThread<ClassicTable> SimulationThread;
+}  // namespace pool
@@ -0,0 +1,114 @@
+#pragma once
+#include <utility>
+#include <vector>
+
+#include "ball.h"
+namespace pool {
+using glm::dvec2;
+using pool::Ball;
+using std::pair;
+using std::vector;
+
+/**
+ * Uniform grid over the board used as a broad phase for ball collisions.
+ * Balls are bucketed by the cell their center is in, and since cells are as
+ * wide as a ball, two balls can only be touching if they are in the same or
+ * neighbouring cells.
+ */
+class SpatialGrid {
+ public:
+  /**
+   * Empty constructor.
+   */
+  SpatialGrid();
+
+  /**
+   * Constructor for grid covering the board.
+   * @param top_left_pos top left corner of area balls move in.
+   * @param bottom_right_pos bottom right corner of area balls move in.
+   * @param cell_size width and height of each cell, should be at least the
+   * ball diameter.
+   * @param max_balls most balls a build can hold, storage for them is made
+   * here so builds and copies of the grid never allocate.
+   */
+  SpatialGrid(const dvec2 &top_left_pos, const dvec2 &bottom_right_pos,
+              double cell_size, size_t max_balls);
+
+  /**
+   * Puts every ball into the cell its center is in, balls outside of the
+   * grid are put in the closest cell.
+   * @param balls on the board, at most max_balls of them.
+   */
+  void Build(const vector<Ball> &balls);
+
+  /**
+   * Puts every ball into the cell its center is in like Build above.
+   * @param first ball on the board.
+   * @param last one past the last ball, at most max_balls after first.
+   */
+  void Build(const Ball *first, const Ball *last);
+
+  /**
+   * Gets pairs of balls in the same or neighbouring cells, which are all the
+   * pairs that could be touching. Pairs are (i, j) with i < j sorted in the
+   * same order a loop over i then j would visit them.
+   * @param pairs cleared and filled with candidate pairs.
+   */
+  void FindCandidatePairs(vector<pair<size_t, size_t>> &pairs) const;
+
+  /**
+   * Visits the balls in cells overlapping a box, which are all the balls
+   * whose centers could be inside it. Parts of the box off the grid are
+   * clamped to the edge cells like the balls are. Nothing is stored, so
+   * querying never allocates.
+   * @param top_left_pos top left corner of the box.
+   * @param bottom_right_pos bottom right corner of the box.
+   * @param visit called with the index of each ball in the last build, in
+   * no particular order.
+   */
+  template <typename Visit>
+  void ForEachBallInBox(const dvec2 &top_left_pos,
+                        const dvec2 &bottom_right_pos, Visit visit) const {
+    size_t min_column = 0;
+    size_t min_row = 0;
+    size_t max_column = 0;
+    size_t max_row = 0;
+    FindCell(top_left_pos, min_column, min_row);
+    FindCell(bottom_right_pos, max_column, max_row);
+    for (size_t row = min_row; row <= max_row; row++) {
+      // cells of a row are next to each other, so are their entries
+      size_t first_cell = row * num_columns_ + min_column;
+      size_t last_cell = row * num_columns_ + max_column;
+      for (size_t entry = cell_starts_[first_cell];
+           entry < cell_starts_[last_cell + 1]; entry++) {
+        visit(cell_entries_[entry]);
+      }
+    }
+  }
+
+  /**
+   * Getter for number of cells in the grid.
+   * @return number of cells across times number of cells down.
+   */
+  size_t GetNumberOfCells() const;
+
+ private:
+  /**
+   * Gets the column and row of cell a position is in, clamped to the grid.
+   */
+  void FindCell(const dvec2 &position, size_t &column, size_t &row) const;
+
+  dvec2 top_left_pos_;
+  double cell_size_;
+  size_t num_columns_;
+  size_t num_rows_;
+  // number of balls in the last build
+  size_t num_balls_;
+  // cell of each ball from last build, sized to max_balls
+  vector<size_t> ball_cells_;
+  // balls in cell c are cell_entries_[cell_starts_[c]] up to
+  // cell_entries_[cell_starts_[c + 1]], cell_entries_ is sized to max_balls
+  vector<size_t> cell_starts_;
+  vector<size_t> cell_entries_;
+};
+}  // namespace pool
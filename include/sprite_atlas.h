@@ -0,0 +1,75 @@
+#pragma once
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <vector>
+namespace pool {
+using glm::ivec2;
+using glm::vec4;
+using std::vector;
+
+/**
+ * Layout of several images packed into one texture, so everything drawn
+ * from them can share a texture bind and a draw call. Images go in a grid of
+ * cells the size of the largest image, in the order given, with padding
+ * around each one so filtering doesn't blend in the image next to it.
+ * Only works out where the images go, copying the pixels is left to the
+ * renderer.
+ */
+class SpriteAtlas {
+ public:
+  /**
+   * Where an image is in the atlas, in pixels from the top left.
+   */
+  struct Region {
+    ivec2 position;
+    ivec2 size;
+  };
+
+  /**
+   * Empty constructor for an atlas with no images.
+   */
+  SpriteAtlas();
+
+  /**
+   * Constructor laying out images in a grid that is as close to square as
+   * possible.
+   * @param image_sizes width and height of each image in pixels.
+   * @param padding pixels left empty around every image.
+   */
+  explicit SpriteAtlas(const vector<ivec2> &image_sizes,
+                       int padding = kDefaultPadding);
+
+  /**
+   * Get size the atlas texture needs to be.
+   * @return width and height in pixels.
+   */
+  ivec2 GetSize() const;
+
+  /**
+   * Get number of images in the atlas.
+   * @return number of images.
+   */
+  size_t GetImageCount() const;
+
+  /**
+   * Get where an image was put.
+   * @param image index in the sizes given to the constructor.
+   * @return region of the image in pixels.
+   */
+  const Region &GetRegion(size_t image) const;
+
+  /**
+   * Get texture coordinates of an image, with 0 at the top of the atlas.
+   * @param image index in the sizes given to the constructor.
+   * @return left, top, right and bottom texture coordinates.
+   */
+  vec4 GetUvRect(size_t image) const;
+
+  // empty pixels around each image, enough for linear filtering
+  constexpr static const int kDefaultPadding = 2;
+
+ private:
+  ivec2 size_;
+  vector<Region> regions_;
+};
+}  // namespace pool
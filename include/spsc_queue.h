@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+namespace pool {
+
+/**
+ * Fixed size lock free queue for one producer thread and one consumer
+ * thread. Push is only called from the producer and Pop only from the
+ * consumer, neither ever blocks or allocates.
+ * @tparam T type of item, copied in and out.
+ * @tparam Capacity max number of items waiting, must be a power of two.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "capacity must be a power of two");
+
+ public:
+  SpscQueue() : head_(0), tail_(0) {
+  }
+
+  /**
+   * Adds an item to the back of the queue, producer only.
+   * @param item to copy in.
+   * @return false if the queue was full and the item was not added.
+   */
+  bool TryPush(const T &item) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+      return false;
+    }
+    items_[tail & (Capacity - 1)] = item;
+    // item has to be written before the consumer can see the new tail
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Removes the item at the front of the queue, consumer only.
+   * @param item set to the removed item.
+   * @return false if the queue was empty and item was not changed.
+   */
+  bool TryPop(T &item) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    item = items_[head & (Capacity - 1)];
+    // item has to be read before the producer can reuse its slot
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Get number of items waiting, only exact when neither thread is using
+   * the queue.
+   * @return number of items in queue.
+   */
+  size_t GetSize() const {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire);
+  }
+
+ private:
+  T items_[Capacity];
+  // indices only ever increase, wrapping is handled by the mask; each is on
+  // its own cache line so the two threads don't slow each other down
+  alignas(64) std::atomic<size_t> head_;
+  alignas(64) std::atomic<size_t> tail_;
+};
+}  // namespace pool
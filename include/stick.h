@@ -3,7 +3,6 @@
 //
 #pragma once
 #include "ball.h"
-#include "cinder/gl/gl.h"
 namespace pool {
 using glm::dvec2;
 /**
@@ -16,11 +15,6 @@ class Stick {
    */
   Stick();
 
-  /**
-   * Display stick on board next to cue ball.
-   */
-  void Display(Ball& ball) const;
-
   /**
    * Rotates stick clockwise when right arrow is clicked.
    */
@@ -74,6 +68,19 @@ class Stick {
    */
   double GetStickHeight() const;
 
+  /**
+   * Getter for stick width used when drawing the stick.
+   * @return double representing width of stick.
+   */
+  double GetStickWidth() const;
+
+  /**
+   * Getter for the gap left between the cue ball and the stick tip before
+   * any pull back is added.
+   * @return double of initial space between stick and cue ball.
+   */
+  double GetInitialSpaceFromCueBall() const;
+
  private:
   // width of cue stick
   double width_;
@@ -81,20 +88,20 @@ class Stick {
   double height_;
   // in week 3 pull from ball will change when player drags stick away from
   // cue ball
-  double const kInitialSpaceFromCueBall = 20;
+  constexpr static double const kInitialSpaceFromCueBall = 20;
   // initial height of cue stick
-  double const kInitialHeight = 400;
+  constexpr static double const kInitialHeight = 400;
   // the pull distance from ball which affects the velocity boost
   double pull_from_ball_ = 0;
   // current angle the stick is at
   double angle_;
   // how much angle is decreased or increased when stick is rotated
-  double const kRotateAngle = .05;
+  constexpr static double const kRotateAngle = .05;
   // how much the stick is pulled back when the player pulls on stick
   // with down arrow
-  double const kPullBack = 5;
+  constexpr static double const kPullBack = 5;
   // max distance the stick can be pulled back
-  double const kMaxPull = 20;
+  constexpr static double const kMaxPull = 20;
   // if player can pull back
   // if set to false player can move stick closer to cue ball
   bool is_pull_back;
@@ -0,0 +1,169 @@
+#pragma once
+#include <cstddef>
+namespace pool {
+
+/**
+ * Table specifications BasicBoard is built for. Every dimension, pocket and
+ * ball count is a compile time constant, so the board's loops over pockets
+ * have a fixed trip count and the pocket test can be unrolled.
+ *
+ * Lengths are in table units, the board's coordinates, where a ball is
+ * kBallTableUnits across, so every table has its real proportions to the
+ * balls. The classic table fills a 1000 window at one unit a pixel, longer
+ * tables are drawn scaled down to fit (BasicBoard::GetViewScale).
+ *
+ * A spec has:
+ * kOuterLeft, kOuterTop, kOuterRight, kOuterBottom : corners of the table
+ * outline.
+ * kCushionWidth : width between the outline and the playing area.
+ * kPocketRadius : radius of every pocket.
+ * kNumPockets, kPocketX, kPocketY : pocket centers, as fractions of the
+ * playing area from its left and top edges.
+ * kNumberOfBallsPerType : number of solid balls, numbered from 1, and of
+ * striped balls.
+ * kNumberOfBalls : balls other than the cue ball, the one after the solids
+ * is the eight ball and the rest are striped.
+ * kRackOrder : ball numbers in the rack from the apex, column by column,
+ * each column one ball longer than the one before.
+ * The rules are eight ball on every table.
+ * BasicBoard and the classes that take one (BasicAimPreview,
+ * BasicComputerPlayer, BasicEventSimulator, BasicReplay, BasicReplayWriter,
+ * BasicSimulationThread and BasicBoardRenderer) are compiled for each spec at
+ * the end of their source files, a new spec has to be added there.
+ */
+
+// diameter of a ball in table units, Ball::kDiameter
+constexpr double kBallTableUnits = 25;
+
+/**
+ * Converts a length on a real table to table units.
+ * @param inches length on the table.
+ * @param ball_inches diameter of the table's balls, a pool ball by default.
+ * @return length in table units.
+ */
+constexpr double TableInches(double inches, double ball_inches = 2.25) {
+  return inches / ball_inches * kBallTableUnits;
+}
+
+/**
+ * Four corner and two side pockets.
+ */
+struct SixPockets {
+  constexpr static double kPocketRadius = kBallTableUnits;
+  constexpr static size_t kNumPockets = 6;
+  // bottom left, top left, top right, bottom right, top side, bottom side
+  constexpr static double kPocketX[kNumPockets] = {0, 0, 1, 1, .5, .5};
+  constexpr static double kPocketY[kNumPockets] = {1, 0, 0, 1, 0, 1};
+};
+
+/**
+ * Solids 1 to 7, the eight ball and stripes 9 to 15 in the usual rack.
+ */
+struct EightBallSet {
+  constexpr static size_t kNumberOfBallsPerType = 7;
+  constexpr static size_t kNumberOfBalls = 15;
+  constexpr static size_t kRackOrder[kNumberOfBalls] = {
+      1, 11, 2, 6, 8, 12, 13, 7, 9, 3, 10, 4, 14, 15, 5};
+};
+
+/**
+ * Table the game has always been played on, with a playing area 32 by 20
+ * balls.
+ */
+struct ClassicTable : SixPockets, EightBallSet {
+  constexpr static double kOuterLeft = 50;
+  constexpr static double kOuterTop = 200;
+  constexpr static double kOuterRight = 950;
+  constexpr static double kOuterBottom = 800;
+  constexpr static double kCushionWidth = 50;
+};
+
+/**
+ * 7 foot pool table, playing area 78 by 39 inches.
+ */
+struct SevenFootTable : SixPockets, EightBallSet {
+  constexpr static double kOuterLeft = 50;
+  constexpr static double kOuterTop = 200;
+  constexpr static double kCushionWidth = 50;
+  constexpr static double kOuterRight =
+      kOuterLeft + 2 * kCushionWidth + TableInches(78);
+  constexpr static double kOuterBottom =
+      kOuterTop + 2 * kCushionWidth + TableInches(39);
+};
+
+/**
+ * 8 foot pool table, playing area 88 by 44 inches.
+ */
+struct EightFootTable : SixPockets, EightBallSet {
+  constexpr static double kOuterLeft = 50;
+  constexpr static double kOuterTop = 200;
+  constexpr static double kCushionWidth = 50;
+  constexpr static double kOuterRight =
+      kOuterLeft + 2 * kCushionWidth + TableInches(88);
+  constexpr static double kOuterBottom =
+      kOuterTop + 2 * kCushionWidth + TableInches(44);
+};
+
+/**
+ * 9 foot pool table, playing area 100 by 50 inches.
+ */
+struct NineFootTable : SixPockets, EightBallSet {
+  constexpr static double kOuterLeft = 50;
+  constexpr static double kOuterTop = 200;
+  constexpr static double kCushionWidth = 50;
+  constexpr static double kOuterRight =
+      kOuterLeft + 2 * kCushionWidth + TableInches(100);
+  constexpr static double kOuterBottom =
+      kOuterTop + 2 * kCushionWidth + TableInches(50);
+};
+
+/**
+ * 12 foot snooker table, playing area 140 by 70 inches with 3.5 inch
+ * pockets, sized to snooker's 2 1/16 inch balls. It has 21 object balls like
+ * snooker's 15 reds and 6 colours, but snooker rules and spots aren't
+ * modelled: it plays eight ball rules like every spec, with solids 1 to 10,
+ * the eight ball numbered 11 and stripes 12 to 21 racked in a 6 column
+ * triangle.
+ */
+struct SnookerTable : SixPockets {
+  constexpr static double kBallInches = 2.0625;
+  constexpr static double kOuterLeft = 50;
+  constexpr static double kOuterTop = 200;
+  constexpr static double kCushionWidth = 50;
+  constexpr static double kOuterRight =
+      kOuterLeft + 2 * kCushionWidth + TableInches(140, kBallInches);
+  constexpr static double kOuterBottom =
+      kOuterTop + 2 * kCushionWidth + TableInches(70, kBallInches);
+  // hides SixPockets' radius, the pockets are in the same places
+  constexpr static double kPocketRadius = TableInches(1.75, kBallInches);
+  constexpr static size_t kNumberOfBallsPerType = 10;
+  constexpr static size_t kNumberOfBalls = 21;
+  constexpr static size_t kRackOrder[kNumberOfBalls] = {
+      1,  12, 2,  13, 11, 3,  14, 4,  15, 5, 16,
+      6,  17, 7,  18, 8,  19, 9,  20, 10, 21};
+};
+
+/**
+ * Carom table without pockets, playing area 112 by 56 inches like a
+ * 10 foot table, with two object balls (a solid and the eight ball). With
+ * nothing to pocket the game never ends, it is for practicing cushion and
+ * ball contacts.
+ */
+struct CaromTable {
+  constexpr static double kOuterLeft = 50;
+  constexpr static double kOuterTop = 200;
+  constexpr static double kCushionWidth = 50;
+  constexpr static double kOuterRight =
+      kOuterLeft + 2 * kCushionWidth + TableInches(112);
+  constexpr static double kOuterBottom =
+      kOuterTop + 2 * kCushionWidth + TableInches(56);
+  constexpr static double kPocketRadius = 0;
+  constexpr static size_t kNumPockets = 0;
+  // arrays can't be empty, these are never read
+  constexpr static double kPocketX[1] = {0};
+  constexpr static double kPocketY[1] = {0};
+  constexpr static size_t kNumberOfBallsPerType = 1;
+  constexpr static size_t kNumberOfBalls = 2;
+  constexpr static size_t kRackOrder[kNumberOfBalls] = {1, 2};
+};
+}  // namespace pool
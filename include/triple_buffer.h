@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+namespace pool {
+
+/**
+ * Lock free handoff of the latest value from one writer thread to one reader
+ * thread. The writer fills the back buffer and publishes it, the reader picks
+ * up the most recently published buffer; neither waits on the other and the
+ * reader's buffer is never written while it is being read. Values published
+ * while the reader is busy are skipped.
+ * @tparam T type of value, should be cheap to copy assign into.
+ */
+template <typename T>
+class TripleBuffer {
+ public:
+  /**
+   * Constructor setting all three buffers to the same value.
+   * @param initial value the reader sees before anything is published.
+   */
+  explicit TripleBuffer(const T &initial)
+      : buffers_{initial, initial, initial}, middle_(1), back_(0), front_(2) {
+  }
+
+  /**
+   * Get buffer to write the next value into, writer only.
+   * @return back buffer, holds an old value.
+   */
+  T &GetWriteBuffer() {
+    return buffers_[back_];
+  }
+
+  /**
+   * Makes the back buffer the latest value and takes the middle buffer to
+   * write into next, writer only.
+   */
+  void Publish() {
+    back_ = middle_.exchange(back_ | kNewBit, std::memory_order_acq_rel) &
+            kIndexMask;
+  }
+
+  /**
+   * Swaps in the latest published value if there is one, reader only.
+   * @return true if a new value was published since the last call.
+   */
+  bool Update() {
+    if ((middle_.load(std::memory_order_relaxed) & kNewBit) == 0) {
+      return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+    return true;
+  }
+
+  /**
+   * Get value picked up by the last Update, reader only.
+   * @return front buffer.
+   */
+  const T &Read() const {
+    return buffers_[front_];
+  }
+
+ private:
+  // middle_ holds a buffer index and whether it was published since the
+  // reader last took it
+  constexpr static const unsigned kIndexMask = 3;
+  constexpr static const unsigned kNewBit = 4;
+
+  T buffers_[3];
+  std::atomic<unsigned> middle_;
+  // only used by the writer
+  unsigned back_;
+  // only used by the reader
+  unsigned front_;
+};
+}  // namespace pool
@@ -0,0 +1,218 @@
+#include "aim_preview.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+namespace pool {
+
+namespace {
+double const kNever = std::numeric_limits<double>::infinity();
+// sides reached within this distance of each other are hit together, so a
+// path into a corner bounces off both
+double const kCornerTolerance = 1e-9;
+double const kDirectionTolerance = 1e-12;
+
+/**
+ * Distance along a ray to where it first comes within radius of a center.
+ * @param origin start of the ray.
+ * @param direction unit direction of the ray.
+ * @param center of the circle.
+ * @param radius of the circle.
+ * @return distance, 0 if the origin is already inside and moving further in,
+ * kNever if the ray misses.
+ */
+double RayCircleDistance(const dvec2 &origin, const dvec2 &direction,
+                         const dvec2 &center, double radius) {
+  dvec2 offset = origin - center;
+  double half_b = offset.x * direction.x + offset.y * direction.y;
+  double c = offset.x * offset.x + offset.y * offset.y - radius * radius;
+  if (c <= 0) {
+    return half_b < 0 ? 0 : kNever;
+  }
+  double discriminant = half_b * half_b - c;
+  if (discriminant < 0 || half_b >= 0) {
+    return kNever;
+  }
+  return -half_b - std::sqrt(discriminant);
+}
+}  // namespace
+
+template <typename Spec>
+constexpr const size_t BasicAimPreview<Spec>::kDefaultMaxBounces;
+
+template <typename Spec>
+BasicAimPreview<Spec>::BasicAimPreview()
+    : BasicAimPreview(kDefaultMaxBounces) {
+}
+
+template <typename Spec>
+BasicAimPreview<Spec>::BasicAimPreview(size_t max_bounces)
+    : max_bounces_(max_bounces) {
+  path_.hits_ball = false;
+  path_.object_ball_number = 0;
+  path_.cue_pocketed = false;
+  // start, one point per bounce and the end, so tracing never allocates
+  path_.points.reserve(max_bounces_ + 2);
+}
+
+template <typename Spec>
+const typename BasicAimPreview<Spec>::Path &BasicAimPreview<Spec>::Update(
+    const Board &board) {
+  if (CheckChanged(board)) {
+    Trace(board);
+  }
+  return path_;
+}
+
+template <typename Spec>
+const typename BasicAimPreview<Spec>::Path &BasicAimPreview<Spec>::GetPath()
+    const {
+  return path_;
+}
+
+template <typename Spec>
+size_t BasicAimPreview<Spec>::GetTraceCount() const {
+  return trace_count_;
+}
+
+template <typename Spec>
+double BasicAimPreview<Spec>::GetPathLength(const Board &board) {
+  return board.GetAimLineLength() * kPathLengthScale;
+}
+
+template <typename Spec>
+bool BasicAimPreview<Spec>::CheckChanged(const Board &board) {
+  const BallPool &pool = board.GetBallPool();
+  const vector<size_t> &numbers = pool.GetNumbers();
+  dvec2 table_top = {board.GetLeftXBoundary(), board.GetTopYBoundary()};
+  dvec2 table_bottom = {board.GetRightXBoundary(), board.GetBottomYBoundary()};
+  bool changed = !traced_ || board.GetShotAngle() != shot_angle_ ||
+                 GetPathLength(board) != path_length_ ||
+                 table_top != table_top_ || table_bottom != table_bottom_ ||
+                 numbers.size() != balls_.size();
+  for (size_t i = 0; i < numbers.size() && !changed; i++) {
+    const Ball &ball = pool[numbers[i]];
+    changed = ball.GetBallNumber() != balls_[i].GetBallNumber() ||
+              ball.GetPosition() != balls_[i].GetPosition();
+  }
+  if (changed) {
+    traced_ = true;
+    shot_angle_ = board.GetShotAngle();
+    path_length_ = GetPathLength(board);
+    table_top_ = table_top;
+    table_bottom_ = table_bottom;
+    // copying keeps the storage so moving the stick doesn't allocate
+    pool.GetBalls(balls_);
+  }
+  return changed;
+}
+
+template <typename Spec>
+void BasicAimPreview<Spec>::Trace(const Board &board) {
+  trace_count_ += 1;
+  path_.points.clear();
+  path_.hits_ball = false;
+  path_.object_ball_number = 0;
+  path_.ghost_position = dvec2(0, 0);
+  path_.object_ball_direction = dvec2(0, 0);
+  path_.cue_ball_direction = dvec2(0, 0);
+  path_.cue_pocketed = false;
+  if (balls_.empty()) {
+    return;
+  }
+  double radius = Ball::GetDiameter() / 2;
+  dvec2 to_center = {radius, radius};
+  dvec2 position = balls_[0].GetPosition() + to_center;
+  dvec2 direction = {-cos(shot_angle_), -sin(shot_angle_)};
+  // rounding in cos and sin of angles along an axis would otherwise send a
+  // ball resting against a side into it
+  for (size_t axis = 0; axis < 2; axis++) {
+    if (std::abs(direction[axis]) < kDirectionTolerance) {
+      direction[axis] = 0;
+    }
+  }
+  // sides the cue ball center can reach
+  double low_sides[2] = {table_top_.x + radius, table_top_.y + radius};
+  double high_sides[2] = {table_bottom_.x - radius, table_bottom_.y - radius};
+  const typename Board::HolePositions &hole_positions =
+      board.GetHolePositions();
+  double remaining = path_length_;
+  path_.points.push_back(position);
+  for (size_t bounce = 0;; bounce++) {
+    double ball_distance = kNever;
+    size_t ball_index = 0;
+    for (size_t i = 1; i < balls_.size(); i++) {
+      double distance =
+          RayCircleDistance(position, direction,
+                            balls_[i].GetPosition() + to_center,
+                            Ball::GetDiameter());
+      if (distance < ball_distance) {
+        ball_distance = distance;
+        ball_index = i;
+      }
+    }
+    // same test as the board uses, the ball center inside the hole
+    double hole_distance = kNever;
+    for (const dvec2 &hole_position : hole_positions) {
+      hole_distance = std::min(
+          hole_distance, RayCircleDistance(position, direction, hole_position,
+                                           board.GetHoleRadius()));
+    }
+    double side_distances[2] = {kNever, kNever};
+    for (size_t axis = 0; axis < 2; axis++) {
+      if (direction[axis] < 0) {
+        side_distances[axis] = (low_sides[axis] - position[axis]) /
+                               direction[axis];
+      } else if (direction[axis] > 0) {
+        side_distances[axis] = (high_sides[axis] - position[axis]) /
+                               direction[axis];
+      }
+      side_distances[axis] = std::max(side_distances[axis], 0.0);
+    }
+    double side_distance = std::min(side_distances[0], side_distances[1]);
+    double distance = std::min(std::min(ball_distance, hole_distance),
+                               std::min(side_distance, remaining));
+    position += direction * distance;
+    path_.points.push_back(position);
+
+    if (distance == ball_distance) {
+      dvec2 object_center = balls_[ball_index].GetPosition() + to_center;
+      dvec2 normal = (object_center - position) / Ball::GetDiameter();
+      path_.hits_ball = true;
+      path_.object_ball_number = balls_[ball_index].GetBallNumber();
+      path_.ghost_position = position;
+      path_.object_ball_direction = normal;
+      // the cue ball keeps the part of its direction along the tangent
+      double along_normal = direction.x * normal.x + direction.y * normal.y;
+      dvec2 tangent = direction - normal * along_normal;
+      double tangent_length = std::sqrt(tangent.x * tangent.x +
+                                        tangent.y * tangent.y);
+      // straight on hits leave nothing but rounding along the tangent
+      if (tangent_length > kDirectionTolerance) {
+        path_.cue_ball_direction = tangent / tangent_length;
+      }
+      return;
+    }
+    if (distance == hole_distance) {
+      path_.cue_pocketed = true;
+      return;
+    }
+    if (distance == remaining || bounce == max_bounces_) {
+      return;
+    }
+    remaining -= distance;
+    for (size_t axis = 0; axis < 2; axis++) {
+      if (side_distances[axis] <= side_distance + kCornerTolerance) {
+        direction[axis] = -direction[axis];
+      }
+    }
+  }
+}
+
+template class BasicAimPreview<ClassicTable>;
+template class BasicAimPreview<SevenFootTable>;
+template class BasicAimPreview<EightFootTable>;
+template class BasicAimPreview<NineFootTable>;
+template class BasicAimPreview<SnookerTable>;
+template class BasicAimPreview<CaromTable>;
+}  // namespace pool
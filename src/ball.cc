@@ -2,45 +2,51 @@
 // Created by neha konjeti on 4/16/21.
 //
 #include "ball.h"
+
+#include <algorithm>
+#include <cmath>
 namespace pool {
-Ball::Ball() {
+template <typename Scalar>
+BasicBall<Scalar>::BasicBall() {
 }
 
-Ball::Ball(size_t number, const Type type, const dvec2& position,
-           const dvec2& velocity) {
+template <typename Scalar>
+BasicBall<Scalar>::BasicBall(size_t number, const Type type,
+                             const Vec2& position, const Vec2& velocity) {
   number_ = number;
   type_ = type;
   position_ = position;
   velocity_ = velocity;
-  velocity_boost_ = kInitialVelocityBoost;
-}
-
-void Ball::Display(ci::gl::Texture2dRef image) const {
-  ci::gl::color(ci::ColorA("white", 1));
-  ci::gl::draw(image, ci::Rectf(position_, {position_.x + kDiameter,
-                                            position_.y + kDiameter}));
+  velocity_boost_ = static_cast<Scalar>(kInitialVelocityBoost);
 }
 
-double Ball::GetDiameter() {
+template <typename Scalar>
+double BasicBall<Scalar>::GetDiameter() {
   return kDiameter;
 }
 
-dvec2 Ball::GetPosition() const {
+template <typename Scalar>
+typename BasicBall<Scalar>::Vec2 BasicBall<Scalar>::GetPosition() const {
   return position_;
 }
 
-dvec2 Ball::GetVelocity() const {
+template <typename Scalar>
+typename BasicBall<Scalar>::Vec2 BasicBall<Scalar>::GetVelocity() const {
   return velocity_;
 }
 
-bool Ball::HandleBoardCollision(double right_boundary, double left_boundary,
-                                double top_boundary, double bottom_boundary) {
+template <typename Scalar>
+bool BasicBall<Scalar>::HandleBoardCollision(Scalar right_boundary,
+                                             Scalar left_boundary,
+                                             Scalar top_boundary,
+                                             Scalar bottom_boundary) {
+  Scalar const diameter = static_cast<Scalar>(kDiameter);
   // board collisions
   if (position_.x <= left_boundary ||
-      position_.x + kDiameter >= right_boundary) {
+      position_.x + diameter >= right_boundary) {
     velocity_.x *= -1;
     return true;
-  } else if (position_.y + kDiameter >= bottom_boundary ||
+  } else if (position_.y + diameter >= bottom_boundary ||
              position_.y <= top_boundary) {
     velocity_.y *= -1;
     return true;
@@ -48,20 +54,22 @@ bool Ball::HandleBoardCollision(double right_boundary, double left_boundary,
   return false;
 }
 
-bool Ball::HandlePoolBallsColliding(Ball& ball_one, Ball& ball_two) {
-  double radius = GetDiameter() / 2;
-  dvec2 velocity_one = ball_one.velocity_;
-  dvec2 velocity_two = ball_two.velocity_;
+template <typename Scalar>
+bool BasicBall<Scalar>::HandlePoolBallsColliding(BasicBall& ball_one,
+                                                 BasicBall& ball_two) {
+  Scalar radius = static_cast<Scalar>(GetDiameter() / 2);
+  Vec2 velocity_one = ball_one.velocity_;
+  Vec2 velocity_two = ball_two.velocity_;
   // get center positions of balls
   // to better judge if they are colliding
-  dvec2 position_one = {ball_one.position_.x + radius,
-                        ball_one.position_.y + radius};
-  dvec2 position_two = {ball_two.position_.x + radius,
-                        ball_two.position_.y + radius};
-  dvec2 velocity_difference = velocity_one - velocity_two;
-  dvec2 position_difference = position_one - position_two;
-  double between_dist = glm::distance(position_one, position_two);
-  double dot_prod = glm::dot(velocity_difference, position_difference);
+  Vec2 position_one = {ball_one.position_.x + radius,
+                       ball_one.position_.y + radius};
+  Vec2 position_two = {ball_two.position_.x + radius,
+                       ball_two.position_.y + radius};
+  Vec2 velocity_difference = velocity_one - velocity_two;
+  Vec2 position_difference = position_one - position_two;
+  Scalar between_dist = glm::distance(position_one, position_two);
+  Scalar dot_prod = glm::dot(velocity_difference, position_difference);
   bool is_collision = between_dist <= 2 * radius;
   // if particles are not moving towards each other
   if (dot_prod >= 0) {
@@ -72,20 +80,21 @@ bool Ball::HandlePoolBallsColliding(Ball& ball_one, Ball& ball_two) {
   }
 
   // calculate new velocities
-  double squared_difference_length = pow(glm::length(position_difference), 2);
-  double dot_over_length = dot_prod / squared_difference_length;
+  Scalar squared_difference_length =
+      std::pow(glm::length(position_difference), Scalar(2));
+  Scalar dot_over_length = dot_prod / squared_difference_length;
   // change velocity for first ball
-  dvec2 updated_velocity_one =
+  Vec2 updated_velocity_one =
       velocity_one - (dot_over_length * position_difference);
   // change velocity for other ball
-  dvec2 velocity_difference_two = velocity_two - velocity_one;
-  dvec2 position_difference_two = position_two - position_one;
-  double dot_prod_two =
+  Vec2 velocity_difference_two = velocity_two - velocity_one;
+  Vec2 position_difference_two = position_two - position_one;
+  Scalar dot_prod_two =
       glm::dot(velocity_difference_two, position_difference_two);
-  double squared_difference_length_two =
-      pow(glm::length(position_difference_two), 2);
-  double dot_over_length_two = dot_prod_two / squared_difference_length_two;
-  dvec2 updated_velocity_two =
+  Scalar squared_difference_length_two =
+      std::pow(glm::length(position_difference_two), Scalar(2));
+  Scalar dot_over_length_two = dot_prod_two / squared_difference_length_two;
+  Vec2 updated_velocity_two =
       velocity_two - (dot_over_length_two * position_difference_two);
   // update velocities
   ball_one.velocity_ = updated_velocity_one;
@@ -93,18 +102,19 @@ bool Ball::HandlePoolBallsColliding(Ball& ball_one, Ball& ball_two) {
   return true;
 }
 
-void Ball::StickHit(double angle) {
+template <typename Scalar>
+void BasicBall<Scalar>::StickHit(double angle) {
   // velocity boost depends on angle ball is hit at by stick
-  dvec2 velocity_boost = {-velocity_boost_ * cos(angle),
-                          -velocity_boost_ * sin(angle)};
+  Vec2 velocity_boost = {-velocity_boost_ * static_cast<Scalar>(cos(angle)),
+                         -velocity_boost_ * static_cast<Scalar>(sin(angle))};
   velocity_ += velocity_boost;
 }
 
-void Ball::DecreaseVelocity() {
+template <typename Scalar>
+void BasicBall<Scalar>::DecreaseVelocity() {
   // reduces velocity for ball to stop rolling
   // Vf = Vi - (friction constant) * g * t
-  double const kReduceVelocity =
-      kGravityConstant * kFrictionConstant * kSecondsPerFrame;
+  Scalar const kReduceVelocity = GetFrictionDeceleration();
   // positive x and y velocities
   if (velocity_.y > kReduceVelocity) {
     velocity_.y -= kReduceVelocity;
@@ -129,35 +139,96 @@ void Ball::DecreaseVelocity() {
   }
 }
 
-void Ball::SetVelocityBoost(double velocity_boost) {
+template <typename Scalar>
+Scalar BasicBall<Scalar>::GetFrictionDeceleration() {
+  return static_cast<Scalar>(kGravityConstant * kFrictionConstant *
+                             kSecondsPerFrame);
+}
+
+template <typename Scalar>
+Scalar BasicBall<Scalar>::GetTimeUntilStopped(size_t axis) const {
+  return std::abs(velocity_[axis]) / GetFrictionDeceleration();
+}
+
+template <typename Scalar>
+typename BasicBall<Scalar>::Vec2 BasicBall<Scalar>::GetPositionAfter(
+    Scalar frames) const {
+  Scalar deceleration = GetFrictionDeceleration();
+  Vec2 position = position_;
+  for (size_t axis = 0; axis < 2; axis++) {
+    // time is cut off when the component stops so the ball doesn't go back
+    Scalar time = std::min(frames, GetTimeUntilStopped(axis));
+    Scalar direction = velocity_[axis] < 0 ? -1 : 1;
+    position[axis] += velocity_[axis] * time -
+                      direction * deceleration * time * time / 2;
+  }
+  return position;
+}
+
+template <typename Scalar>
+typename BasicBall<Scalar>::Vec2 BasicBall<Scalar>::GetVelocityAfter(
+    Scalar frames) const {
+  Scalar deceleration = GetFrictionDeceleration();
+  Vec2 velocity = velocity_;
+  for (size_t axis = 0; axis < 2; axis++) {
+    if (frames >= GetTimeUntilStopped(axis)) {
+      velocity[axis] = 0;
+    } else {
+      Scalar direction = velocity_[axis] < 0 ? -1 : 1;
+      velocity[axis] -= direction * deceleration * frames;
+    }
+  }
+  return velocity;
+}
+
+template <typename Scalar>
+void BasicBall<Scalar>::MoveFor(Scalar frames) {
+  Vec2 position = GetPositionAfter(frames);
+  velocity_ = GetVelocityAfter(frames);
+  position_ = position;
+}
+
+template <typename Scalar>
+void BasicBall<Scalar>::SetVelocityBoost(Scalar velocity_boost) {
   velocity_boost_ = velocity_boost;
 }
 
-double Ball::GetInitialVelocityBoost() {
+template <typename Scalar>
+double BasicBall<Scalar>::GetInitialVelocityBoost() {
   return kInitialVelocityBoost;
 }
 
-double Ball::GetVelocityBoost() const {
+template <typename Scalar>
+Scalar BasicBall<Scalar>::GetVelocityBoost() const {
   return velocity_boost_;
 }
 
-void Ball::SetPosition(dvec2 position) {
+template <typename Scalar>
+void BasicBall<Scalar>::SetPosition(Vec2 position) {
   position_ = position;
 }
 
-void Ball::SetVelocity(dvec2 velocity) {
+template <typename Scalar>
+void BasicBall<Scalar>::SetVelocity(Vec2 velocity) {
   velocity_ = velocity;
 }
 
-size_t Ball::GetBallNumber() const {
+template <typename Scalar>
+size_t BasicBall<Scalar>::GetBallNumber() const {
   return number_;
 }
 
-void Ball::Move() {
+template <typename Scalar>
+void BasicBall<Scalar>::Move() {
   position_ += velocity_;
 }
 
-Ball::Type Ball::GetBallType() const {
+template <typename Scalar>
+typename BasicBall<Scalar>::Type BasicBall<Scalar>::GetBallType() const {
   return type_;
 }
+
+// double is the game's physics, float is for batches of simulations
+template class BasicBall<double>;
+template class BasicBall<float>;
 }  // namespace pool
@@ -0,0 +1,77 @@
+#include "ball_pool.h"
+
+#include <algorithm>
+namespace pool {
+BallPool::BallPool(size_t capacity)
+    : slots_(capacity), in_play_(capacity, false), asleep_(capacity, false) {
+  numbers_.reserve(capacity);
+}
+
+void BallPool::Assign(const Ball *first, const Ball *last) {
+  Clear();
+  for (const Ball *ball = first; ball != last; ball++) {
+    Add(*ball);
+  }
+}
+
+void BallPool::Assign(const vector<Ball> &balls) {
+  Assign(balls.data(), balls.data() + balls.size());
+}
+
+void BallPool::Add(const Ball &ball) {
+  size_t number = ball.GetBallNumber();
+  slots_[number] = ball;
+  in_play_[number] = true;
+  asleep_[number] = false;
+  numbers_.push_back(number);
+  sleep_version_ += 1;
+}
+
+void BallPool::Clear() {
+  for (size_t number : numbers_) {
+    in_play_[number] = false;
+  }
+  numbers_.clear();
+  sleep_version_ += 1;
+}
+
+void BallPool::Remove(size_t ball_number) {
+  in_play_[ball_number] = false;
+  numbers_.erase(std::find(numbers_.begin(), numbers_.end(), ball_number));
+  sleep_version_ += 1;
+}
+
+bool BallPool::IsInPlay(size_t ball_number) const {
+  return ball_number < in_play_.size() && in_play_[ball_number] != 0;
+}
+
+void BallPool::WakeAll() {
+  std::fill(asleep_.begin(), asleep_.end(), false);
+  sleep_version_ += 1;
+}
+
+size_t BallPool::GetCount() const {
+  return numbers_.size();
+}
+
+size_t BallPool::GetCapacity() const {
+  return slots_.size();
+}
+
+const vector<size_t> &BallPool::GetNumbers() const {
+  return numbers_;
+}
+
+void BallPool::GetBalls(vector<Ball> &balls) const {
+  balls.clear();
+  for (size_t number : numbers_) {
+    balls.push_back(slots_[number]);
+  }
+}
+
+void BallPool::Update(const vector<Ball> &balls) {
+  for (const Ball &ball : balls) {
+    slots_[ball.GetBallNumber()] = ball;
+  }
+}
+}  // namespace pool
@@ -0,0 +1,198 @@
+#include "ball_system.h"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+namespace pool {
+
+template <typename Scalar>
+BasicBallSystem<Scalar>::BasicBallSystem() {
+  size_ = 0;
+}
+
+template <typename Scalar>
+void BasicBallSystem<Scalar>::Load(const vector<BasicBall<Scalar>> &balls) {
+  size_ = balls.size();
+  size_t padded_size = GetPaddedSize() + kLaneWidth;
+  // padding balls sit in the corner of the arrays, assign keeps the storage
+  // once it has grown to the number of balls
+  x_.assign(padded_size, 0);
+  y_.assign(padded_size, 0);
+  for (size_t i = 0; i < size_; i++) {
+    x_[i] = balls[i].GetPosition().x;
+    y_[i] = balls[i].GetPosition().y;
+  }
+}
+
+#if defined(__AVX__)
+
+template <typename Scalar>
+const char *BasicBallSystem<Scalar>::GetInstructionSet() {
+  return "avx";
+}
+
+template <>
+void BasicBallSystem<double>::FindTouchingPairs(
+    vector<pair<size_t, size_t>> &pairs, double contact_distance) const {
+  pairs.clear();
+  const __m256d max_squared_distance =
+      _mm256_set1_pd(contact_distance * contact_distance);
+  for (size_t i = 0; i < size_; i++) {
+    const __m256d x = _mm256_set1_pd(x_[i]);
+    const __m256d y = _mm256_set1_pd(y_[i]);
+    for (size_t j = i + 1; j < size_; j += 4) {
+      __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x_.data() + j), x);
+      __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y_.data() + j), y);
+      __m256d squared_distance =
+          _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+      int mask = _mm256_movemask_pd(
+          _mm256_cmp_pd(squared_distance, max_squared_distance, _CMP_LE_OQ));
+      // almost every lane misses, only hits fall into the scalar path
+      if (mask != 0) {
+        for (size_t lane = 0; lane < 4 && j + lane < size_; lane++) {
+          if ((mask >> lane) & 1) {
+            pairs.push_back(std::make_pair(i, j + lane));
+          }
+        }
+      }
+    }
+  }
+}
+
+template <>
+void BasicBallSystem<float>::FindTouchingPairs(
+    vector<pair<size_t, size_t>> &pairs, float contact_distance) const {
+  pairs.clear();
+  const __m256 max_squared_distance =
+      _mm256_set1_ps(contact_distance * contact_distance);
+  for (size_t i = 0; i < size_; i++) {
+    const __m256 x = _mm256_set1_ps(x_[i]);
+    const __m256 y = _mm256_set1_ps(y_[i]);
+    for (size_t j = i + 1; j < size_; j += 8) {
+      __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x_.data() + j), x);
+      __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y_.data() + j), y);
+      __m256 squared_distance =
+          _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+      int mask = _mm256_movemask_ps(
+          _mm256_cmp_ps(squared_distance, max_squared_distance, _CMP_LE_OQ));
+      if (mask != 0) {
+        for (size_t lane = 0; lane < 8 && j + lane < size_; lane++) {
+          if ((mask >> lane) & 1) {
+            pairs.push_back(std::make_pair(i, j + lane));
+          }
+        }
+      }
+    }
+  }
+}
+
+#elif defined(__SSE2__)
+
+template <typename Scalar>
+const char *BasicBallSystem<Scalar>::GetInstructionSet() {
+  return "sse2";
+}
+
+template <>
+void BasicBallSystem<double>::FindTouchingPairs(
+    vector<pair<size_t, size_t>> &pairs, double contact_distance) const {
+  pairs.clear();
+  const __m128d max_squared_distance =
+      _mm_set1_pd(contact_distance * contact_distance);
+  for (size_t i = 0; i < size_; i++) {
+    const __m128d x = _mm_set1_pd(x_[i]);
+    const __m128d y = _mm_set1_pd(y_[i]);
+    for (size_t j = i + 1; j < size_; j += 2) {
+      __m128d dx = _mm_sub_pd(_mm_loadu_pd(x_.data() + j), x);
+      __m128d dy = _mm_sub_pd(_mm_loadu_pd(y_.data() + j), y);
+      __m128d squared_distance =
+          _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+      int mask =
+          _mm_movemask_pd(_mm_cmple_pd(squared_distance, max_squared_distance));
+      // almost every lane misses, only hits fall into the scalar path
+      if ((mask & 1) != 0) {
+        pairs.push_back(std::make_pair(i, j));
+      }
+      if ((mask & 2) != 0 && j + 1 < size_) {
+        pairs.push_back(std::make_pair(i, j + 1));
+      }
+    }
+  }
+}
+
+template <>
+void BasicBallSystem<float>::FindTouchingPairs(
+    vector<pair<size_t, size_t>> &pairs, float contact_distance) const {
+  pairs.clear();
+  const __m128 max_squared_distance =
+      _mm_set1_ps(contact_distance * contact_distance);
+  for (size_t i = 0; i < size_; i++) {
+    const __m128 x = _mm_set1_ps(x_[i]);
+    const __m128 y = _mm_set1_ps(y_[i]);
+    for (size_t j = i + 1; j < size_; j += 4) {
+      __m128 dx = _mm_sub_ps(_mm_loadu_ps(x_.data() + j), x);
+      __m128 dy = _mm_sub_ps(_mm_loadu_ps(y_.data() + j), y);
+      __m128 squared_distance =
+          _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+      int mask =
+          _mm_movemask_ps(_mm_cmple_ps(squared_distance, max_squared_distance));
+      if (mask != 0) {
+        for (size_t lane = 0; lane < 4 && j + lane < size_; lane++) {
+          if ((mask >> lane) & 1) {
+            pairs.push_back(std::make_pair(i, j + lane));
+          }
+        }
+      }
+    }
+  }
+}
+
+#else
+
+template <typename Scalar>
+const char *BasicBallSystem<Scalar>::GetInstructionSet() {
+  return "scalar";
+}
+
+template <typename Scalar>
+void BasicBallSystem<Scalar>::FindTouchingPairs(
+    vector<pair<size_t, size_t>> &pairs, Scalar contact_distance) const {
+  pairs.clear();
+  Scalar max_squared_distance = contact_distance * contact_distance;
+  for (size_t i = 0; i < size_; i++) {
+    for (size_t j = i + 1; j < size_; j++) {
+      Scalar dx = x_[j] - x_[i];
+      Scalar dy = y_[j] - y_[i];
+      if (dx * dx + dy * dy <= max_squared_distance) {
+        pairs.push_back(std::make_pair(i, j));
+      }
+    }
+  }
+}
+
+#endif
+
+template <typename Scalar>
+size_t BasicBallSystem<Scalar>::GetSize() const {
+  return size_;
+}
+
+template <typename Scalar>
+size_t BasicBallSystem<Scalar>::GetPaddedSize() const {
+  return (size_ + kLaneWidth - 1) / kLaneWidth * kLaneWidth;
+}
+
+template <typename Scalar>
+const Scalar *BasicBallSystem<Scalar>::GetX() const {
+  return x_.data();
+}
+
+template <typename Scalar>
+const Scalar *BasicBallSystem<Scalar>::GetY() const {
+  return y_.data();
+}
+
+// double is what the board uses, float fits twice as many lanes
+template class BasicBallSystem<double>;
+template class BasicBallSystem<float>;
+}  // namespace pool
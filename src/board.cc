@@ -2,76 +2,98 @@
 // Created by neha konjeti on 4/16/21.
 //
 #include "board.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "profiler.h"
 namespace pool {
-Board::Board(double window_size) : cue_stick_(), player_() {
-  outer_rect_top_pos_ = {window_size * .05, window_size * .20};
-  outer_rect_bottom_pos_ = {window_size * .95, window_size * .8};
-  board_outline_width_ = window_size * .05;
-  hole_radius_ = window_size * .025;
-  inner_rect_bottom_pos_ = {outer_rect_bottom_pos_.x - board_outline_width_,
-                            outer_rect_bottom_pos_.y - board_outline_width_};
-  inner_rect_top_pos_ = {outer_rect_top_pos_.x + board_outline_width_,
-                         outer_rect_top_pos_.y + board_outline_width_};
-  // initialize hole positions based on board rectangle positions
-  dvec2 hole_one_position = {inner_rect_top_pos_.x, inner_rect_bottom_pos_.y};
-  dvec2 hole_two_position = inner_rect_top_pos_;
-  dvec2 hole_three_position = {inner_rect_bottom_pos_.x, inner_rect_top_pos_.y};
-  dvec2 hole_four_position = inner_rect_bottom_pos_;
-  dvec2 hole_five_position = {
-      (inner_rect_bottom_pos_.x + inner_rect_top_pos_.x) / 2,
-      inner_rect_top_pos_.y};
-  dvec2 hole_six_position = {hole_five_position.x, inner_rect_bottom_pos_.y};
-  hole_positions_ = {hole_one_position,   hole_two_position,
-                     hole_three_position, hole_four_position,
-                     hole_five_position,  hole_six_position};
+template <typename Spec>
+constexpr const size_t BasicBoard<Spec>::kMaxContactIterations;
+template <typename Spec>
+constexpr const double BasicBoard<Spec>::kFeltLeft;
+template <typename Spec>
+constexpr const double BasicBoard<Spec>::kFeltTop;
+template <typename Spec>
+constexpr const double BasicBoard<Spec>::kFeltRight;
+template <typename Spec>
+constexpr const double BasicBoard<Spec>::kFeltBottom;
+
+template <typename Spec>
+BasicBoard<Spec>::BasicBoard(double window_size)
+    : cue_stick_(), player_(), window_size_(window_size) {
+  for (size_t pocket = 0; pocket < Spec::kNumPockets; pocket++) {
+    hole_positions_[pocket] = {GetHoleX(pocket), GetHoleY(pocket)};
+  }
+  event_simulator_ =
+      EventSimulator(kFeltLeft, kFeltRight, kFeltTop, kFeltBottom,
+                     hole_positions_, Spec::kPocketRadius);
+  grid_ = SpatialGrid(inner_rect_top_pos_, inner_rect_bottom_pos_,
+                      Ball::GetDiameter(), balls_.GetCapacity());
+  sleeping_grid_ = grid_;
+  sleeping_balls_.resize(balls_.GetCapacity());
+  fixed_felt_left_ = Fixed::FromDouble(kFeltLeft);
+  fixed_felt_top_ = Fixed::FromDouble(kFeltTop);
+  fixed_felt_right_ = Fixed::FromDouble(kFeltRight);
+  fixed_felt_bottom_ = Fixed::FromDouble(kFeltBottom);
+  for (size_t pocket = 0; pocket < Spec::kNumPockets; pocket++) {
+    fixed_hole_positions_[pocket] =
+        FixedVec2::FromDouble(hole_positions_[pocket]);
+  }
+  fixed_hole_radius_ = Fixed::FromDouble(Spec::kPocketRadius);
+  fixed_diameter_ = Fixed::FromDouble(Ball::GetDiameter());
   min_line_length_ = window_size * .1;
   aim_line_length_ = min_line_length_;
   extend_line_length_ = window_size * .02;
 }
 
-void Board::MakeCueBall() {
+template <typename Spec>
+void BasicBoard<Spec>::MakeCueBall() {
   dvec2 starting_pos = {(inner_rect_top_pos_.x + inner_rect_bottom_pos_.x) / 4,
                         (inner_rect_top_pos_.y + inner_rect_bottom_pos_.y) / 2};
   Ball cue_ball = Ball(0, Ball::cue, starting_pos, {0.0, 0.0});
-  balls_.push_back(cue_ball);
+  balls_.Add(cue_ball);
 }
 
-void Board::MakeSolidPoolBalls() {
+template <typename Spec>
+void BasicBoard<Spec>::MakeSolidPoolBalls() {
   for (size_t ball_number = 1; ball_number <= kNumberOfBallsPerType;
        ball_number++) {
     Ball solid_ball = Ball(ball_number, Ball::solid, {0, 0}, {0, 0});
-    balls_.push_back(solid_ball);
+    balls_.Add(solid_ball);
   }
 }
 
-void Board::MakeEightBall() {
+template <typename Spec>
+void BasicBoard<Spec>::MakeEightBall() {
   Ball eight_ball = Ball(kEightBallNumber, Ball::eight, {0, 0}, {0, 0});
-  balls_.push_back(eight_ball);
+  balls_.Add(eight_ball);
 }
 
-void Board::MakeStripedPoolBalls() {
+template <typename Spec>
+void BasicBoard<Spec>::MakeStripedPoolBalls() {
   for (size_t ball_number = kEightBallNumber + 1; ball_number <= kNumberOfBalls;
        ball_number++) {
     Ball striped_ball = Ball(ball_number, Ball::striped, {0, 0}, {0, 0});
-    balls_.push_back(striped_ball);
+    balls_.Add(striped_ball);
   }
 }
 
-void Board::MakeTriangle() {
+template <typename Spec>
+void BasicBoard<Spec>::MakeTriangle() {
   // starting pos is center of board
   dvec2 starting_pos = {(inner_rect_top_pos_.x + inner_rect_bottom_pos_.x) / 2,
                         (inner_rect_top_pos_.y + inner_rect_bottom_pos_.y) / 2};
-  // number of columns in triangle
-  size_t const kNumCols = 5;
-  // found order of balls online
-  vector<size_t> kBallNumberOrder = {1, 11, 2,  6, 8,  12, 13, 7,
-                                     9, 3,  10, 4, 14, 15, 5};
   // this increments by one for each column
   size_t num_balls_in_col = 1;
   size_t index = 0;
-  for (size_t c = 0; c < kNumCols; c++) {
-    for (size_t num = 0; num < num_balls_in_col; num++) {
-      balls_[kBallNumberOrder[index]].SetPosition(starting_pos);
+  // last column can be short if the balls don't make a full triangle
+  while (index < kNumberOfBalls) {
+    for (size_t num = 0; num < num_balls_in_col && index < kNumberOfBalls;
+         num++) {
+      balls_[Spec::kRackOrder[index]].SetPosition(starting_pos);
       index += 1;
       // check if there is next ball in column to add to y
       if (num != num_balls_in_col - 1) {
@@ -80,22 +102,17 @@ void Board::MakeTriangle() {
     }
     // subtract the y that was added to the position for previous column
     starting_pos.y -= ((double)(num_balls_in_col - 1) * Ball::GetDiameter());
-    // add diameter to starting position x for next column first ball position
-    starting_pos.x += Ball::GetDiameter();
+    // columns of a packed rack are sqrt(3)/2 of a diameter apart, so every
+    // ball touches the ones next to it in the columns on each side too
+    starting_pos.x += Ball::GetDiameter() * std::sqrt(3.0) / 2;
     // add radius for new starting position of next column
     starting_pos.y -= Ball::GetDiameter() / 2;
     num_balls_in_col += 1;
   }
 }
 
-void Board::DrawHoles() const {
-  ci::gl::color(ci::Color("black"));
-  for (size_t i = 0; i < hole_positions_.size(); i++) {
-    ci::gl::drawSolidCircle(hole_positions_[i], hole_radius_);
-  }
-}
-
-void Board::CreatePoolBalls() {
+template <typename Spec>
+void BasicBoard<Spec>::CreatePoolBalls() {
   // creates all the ball objects
   MakeCueBall();
   MakeSolidPoolBalls();
@@ -105,101 +122,92 @@ void Board::CreatePoolBalls() {
   MakeTriangle();
 }
 
-void Board::Display(const vector<ci::gl::Texture2dRef> &images) {
-  // draws board outline
-  ci::gl::color(ci::Color(kPoolBoardOutlineColor));
-  ci::gl::drawSolidRect(ci::Rectf(outer_rect_bottom_pos_, outer_rect_top_pos_));
-  // draws inside of board
-  ci::gl::color(ci::Color(kPoolBoardColor));
-  ci::gl::drawSolidRect(ci::Rectf(inner_rect_bottom_pos_, inner_rect_top_pos_));
-  // holes are drawn before balls so ball would appear above hole
-  DrawHoles();
-  // displays the balls the player hit into holes above the pool board
-  if (player_.GetGameState() == Player::playing) {
-    for (size_t i = 0; i < balls_.size(); i++) {
-      size_t ball_number = balls_[i].GetBallNumber();
-      balls_[i].Display(images[ball_number]);
-    }
-    if (stick_visible_) {
-      cue_stick_.Display(balls_[0]);
-      DrawLine();
-    }
-    player_.DisplayBalls(images);
-  }
-}
-
-void Board::DisplayWinningMessage() const {
-  dvec2 text_center_pos = {
-      (inner_rect_bottom_pos_.x + inner_rect_top_pos_.x) / 2,
-      (inner_rect_bottom_pos_.y + inner_rect_top_pos_.y) / 2};
-  ci::gl::drawStringCentered("You Won! Press SPACE to play again!",
-                             text_center_pos, "black", ci::Font("Arial", 30));
-}
-
-void Board::DisplayLosingMessage() const {
-  dvec2 text_center_pos = {
-      (inner_rect_bottom_pos_.x + inner_rect_top_pos_.x) / 2,
-      (inner_rect_bottom_pos_.y + inner_rect_top_pos_.y) / 2};
-  ci::gl::drawStringCentered("You Lost! Press SPACE to play again",
-                             text_center_pos, "black", ci::Font("Arial", 30));
-}
-
-void Board::DrawLine() const {
-  double rad_angle = cue_stick_.GetAngle() + kInitialStickAngle;
-  double radius = Ball::GetDiameter() / 2;
-  // line starts at cue ball center
-  dvec2 cue_ball_center_pos = {balls_[0].GetPosition().x + radius,
-                               balls_[0].GetPosition().y + radius};
-  // calculate ending position of cue ball using the angle of stick
-  dvec2 triangle_legs = {-aim_line_length_ * cos(rad_angle),
-                         -aim_line_length_ * sin(rad_angle)};
-  dvec2 line_end_pos = cue_ball_center_pos + triangle_legs;
-  ci::gl::color(ci::Color("white"));
-  ci::gl::drawLine(cue_ball_center_pos, line_end_pos);
-}
-
-void Board::HitCueBall() {
+template <typename Spec>
+void BasicBoard<Spec>::HitCueBall() {
   // stick has to be there for ball to be hit
   // prevents cue ball being hit during shot
   if (stick_visible_) {
     double angle = cue_stick_.GetAngle();
     // have to add initial angle of stick
     angle += kInitialStickAngle;
-    balls_[0].StickHit(angle);
+    StickHitCueBall(angle);
+    balls_.SetAsleep(0, false);
     stick_visible_ = false;
+    pocketed_this_shot_.clear();
+  }
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::HitCueBall(double angle, double power) {
+  balls_[0].SetVelocityBoost(power);
+  StickHitCueBall(angle);
+  balls_.SetAsleep(0, false);
+  stick_visible_ = false;
+  pocketed_this_shot_.clear();
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::StickHitCueBall(double angle) {
+  if (simulation_mode_ != fixed_point) {
+    balls_[0].StickHit(angle);
+    return;
   }
+  // angle and power are only rounded, sine and cosine are fixed point too
+  FixedBall cue_ball = FixedBall(balls_[0]);
+  cue_ball.StickHit(Fixed::FromDouble(angle),
+                    Fixed::FromDouble(balls_[0].GetVelocityBoost()));
+  cue_ball.Store(balls_[0]);
 }
 
-bool Board::CheckIfInHole(const Ball &ball) {
+template <typename Spec>
+bool BasicBoard<Spec>::CheckIfInHole(const Ball &ball) const {
   dvec2 pos = ball.GetPosition();
-  // calculate the distance between the center of the ball and the
-  // hole center to see if it is less than the hole radius
-  dvec2 center_pos = {pos.x + ball.GetDiameter() / 2,
-                      pos.y + ball.GetDiameter() / 2};
-  for (dvec2 const &hole_position : hole_positions_) {
-    dvec2 difference_in_center_pos = {abs(center_pos.x - hole_position.x),
-                                      abs(center_pos.y - hole_position.y)};
-    double distance = sqrt(pow(difference_in_center_pos.x, 2) +
-                           pow(difference_in_center_pos.y, 2));
-    if (distance < hole_radius_) {
+  // compare the squared distance between the center of the ball and each
+  // hole center with the squared hole radius, the pockets are constants so
+  // the loop unrolls into comparisons against them
+  double center_x = pos.x + Ball::kDiameter / 2;
+  double center_y = pos.y + Ball::kDiameter / 2;
+  for (size_t pocket = 0; pocket < Spec::kNumPockets; pocket++) {
+    double dx = center_x - GetHoleX(pocket);
+    double dy = center_y - GetHoleY(pocket);
+    if (dx * dx + dy * dy < kHoleRadiusSquared) {
       return true;
     }
   }
   return false;
 }
 
-bool Board::IsCueInHole() {
+template <typename Spec>
+bool BasicBoard<Spec>::IsCueInHole() const {
   return cue_in_hole_;
 }
 
-bool Board::CheckOverlap(dvec2 center_pos) {
+template <typename Spec>
+bool BasicBoard<Spec>::CheckOverlap(dvec2 center_pos) {
   double diameter = Ball::GetDiameter();
-  // start at 1 because index 0 is the cue ball
-  for (size_t i = 1; i < balls_.size(); i++) {
+  if (simulation_mode_ == fixed_point) {
+    FixedBall placed = FixedBall(Ball(0, Ball::cue,
+                                      {center_pos.x - diameter / 2,
+                                       center_pos.y - diameter / 2},
+                                      {0, 0}));
+    for (size_t i : balls_.GetNumbers()) {
+      if (i != 0 && FixedBall::AreWithin(placed, FixedBall(balls_[i]),
+                                         Fixed::FromDouble(diameter))) {
+        return true;
+      }
+    }
+    return false;
+  }
+  for (size_t i : balls_.GetNumbers()) {
+    // ball 0 is the cue ball
+    if (i == 0) {
+      continue;
+    }
     dvec2 ball_center_pos = {balls_[i].GetPosition().x + diameter / 2,
                              balls_[i].GetPosition().y + diameter / 2};
-    dvec2 difference_in_center_pos = {abs(center_pos.x - ball_center_pos.x),
-                                      abs(center_pos.y - ball_center_pos.y)};
+    dvec2 difference_in_center_pos = {
+        std::abs(center_pos.x - ball_center_pos.x),
+        std::abs(center_pos.y - ball_center_pos.y)};
     double distance = sqrt(pow(difference_in_center_pos.x, 2) +
                            pow(difference_in_center_pos.y, 2));
     if (distance <= diameter) {
@@ -209,7 +217,8 @@ bool Board::CheckOverlap(dvec2 center_pos) {
   return false;
 }
 
-void Board::RepositionCueBall(const dvec2 &pos) {
+template <typename Spec>
+void BasicBoard<Spec>::RepositionCueBall(const dvec2 &pos) {
   double diameter = Ball::GetDiameter();
   dvec2 center_pos = {pos.x + diameter / 2, pos.y + diameter / 2};
   // keeps changes x or y of cue ball till there is no overlap in balls
@@ -225,86 +234,671 @@ void Board::RepositionCueBall(const dvec2 &pos) {
   balls_[0].SetPosition(
       {center_pos.x - diameter / 2, center_pos.y - diameter / 2});
   balls_[0].SetVelocity({0, 0});
+  balls_.SetAsleep(0, false);
   cue_in_hole_ = false;
 }
 
-void Board::AdvanceOneFrame() {
+template <typename Spec>
+bool BasicBoard<Spec>::HandleBallInHole(size_t ball_number) {
+  const Ball &ball = balls_[ball_number];
+  pocketed_this_shot_.push_back(ball_number);
+  if (ball.GetBallType() == Ball::cue) {
+    dvec2 center = {(inner_rect_top_pos_.x + inner_rect_bottom_pos_.x) / 2,
+                    (inner_rect_top_pos_.y + inner_rect_bottom_pos_.y) / 2};
+    RepositionCueBall({center.x, center.y});
+    cue_in_hole_ = true;
+  } else {
+    if (player_.GetBallTypeToScore() == Ball::Type::cue &&
+        ball.GetBallType() != Ball::eight) {
+      player_.SetBallTypeToScore(ball.GetBallType());
+    }
+    if (player_.GetBallTypeToScore() == ball.GetBallType()) {
+      player_.AddBallNumberScored(ball_number);
+      player_.AddBallScore();
+      return true;
+    } else if (ball.GetBallType() == Ball::eight) {
+      if (player_.GetPlayerScore() == kNumberOfBallsPerType) {
+        player_.AddBallNumberScored(ball_number);
+        player_.AddBallScore();
+        player_.SetGameState(Player::won);
+      } else {
+        player_.SetGameState(Player::lost);
+      }
+    } else if (player_.GetBallTypeToScore() != ball.GetBallType()) {
+      player_.SetGameState(Player::lost);
+    }
+  }
+  return false;
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::AdvanceOneFrame() {
+  if (simulation_mode_ == event_driven) {
+    AdvanceByEvents(1.0);
+    return;
+  }
+  POOL_PROFILE_SCOPE("physics/frame");
+  candidate_pair_count_ = 0;
+  size_t num_balls_moving = 0;
+  WakeTouchingBalls();
+  POOL_PROFILE_COUNT("physics/awake balls", num_awake_);
+  if (broad_phase_ != brute_force) {
+    FindCandidatePairs();
+  }
+  if (simulation_mode_ == fixed_point) {
+    num_balls_moving = StepBallsFixed();
+  } else {
+    num_balls_moving = contact_solver_ == sequential ? StepBallsInOrder()
+                                                     : StepBallsTogether();
+  }
+  // stick is made visible if all balls (including cue ball) are not
+  // not moving
+  if (num_balls_moving == 0) {
+    stick_visible_ = true;
+  }
+  POOL_PROFILE_COUNT("physics/collision pairs", candidate_pair_count_);
+  for (size_t ball_number : balls_to_remove_) {
+    balls_.Remove(ball_number);
+  }
+  balls_to_remove_.clear();
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::FindCandidatePairs() {
+  POOL_PROFILE_SCOPE("physics/broad phase");
+  // pairs come back as positions among the awake balls, which are in the
+  // order they are stepped
+  awake_balls_.clear();
+  for (size_t awake = 0; awake < num_awake_; awake++) {
+    awake_balls_.push_back(balls_[ball_order_[awake]]);
+  }
+  if (broad_phase_ == uniform_grid) {
+    grid_.Build(awake_balls_);
+    grid_.FindCandidatePairs(candidate_pairs_);
+  } else {
+    ball_system_.Load(awake_balls_);
+    ball_system_.FindTouchingPairs(candidate_pairs_,
+                                   Ball::GetDiameter() + kOverlapTolerance);
+  }
+}
+
+template <typename Spec>
+size_t BasicBoard<Spec>::StepBallsInOrder() {
+  // balls i and after haven't moved yet when ball i is checked, so pairs
+  // found from the positions at the start of the frame are the same pairs
+  // the brute force loop would find touching
   size_t num_balls_moving = 0;
-  for (size_t i = 0; i < balls_.size(); i++) {
+  size_t next_pair = 0;
+  dvec2 no_velocity = {0.0, 0.0};
+  for (size_t awake = 0; awake < num_awake_; awake++) {
+    size_t i = ball_order_[awake];
     if (CheckIfInHole(balls_[i])) {
-      if (balls_[i].GetBallType() == Ball::cue) {
-        dvec2 center = {(inner_rect_top_pos_.x + inner_rect_bottom_pos_.x) / 2,
-                        (inner_rect_top_pos_.y + inner_rect_bottom_pos_.y) / 2};
-        RepositionCueBall({center.x, center.y});
-        cue_in_hole_ = true;
+      // scored balls stay in their slots until the frame is done
+      if (HandleBallInHole(i)) {
+        balls_to_remove_.push_back(i);
+      }
+    } else {
+      balls_[i].HandleBoardCollision(
+          inner_rect_bottom_pos_.x, inner_rect_top_pos_.x,
+          inner_rect_top_pos_.y, inner_rect_bottom_pos_.y);
+      balls_[i].DecreaseVelocity();
+      if (broad_phase_ == brute_force) {
+        // sleeping balls aren't touching any awake ball
+        for (size_t other = awake + 1; other < num_awake_; other++) {
+          Ball::HandlePoolBallsColliding(balls_[i],
+                                         balls_[ball_order_[other]]);
+          candidate_pair_count_ += 1;
+        }
       } else {
-        if (player_.GetBallTypeToScore() == Ball::Type::cue &&
-            balls_[i].GetBallType() != Ball::eight) {
-          player_.SetBallTypeToScore(balls_[i].GetBallType());
+        // skip pairs of balls that were in holes
+        while (next_pair < candidate_pairs_.size() &&
+               candidate_pairs_[next_pair].first < awake) {
+          next_pair += 1;
         }
-        if (player_.GetBallTypeToScore() == balls_[i].GetBallType()) {
-          player_.AddBallNumberScored(balls_[i].GetBallNumber());
-          player_.AddBallScore();
-          // set to temporary position not on screen
-          // to remove later from vector
-          // removing now will mess up indices of vector in looping through it
-          balls_[i].SetPosition(kOutsideOfView);
-        } else if (balls_[i].GetBallType() == Ball::eight) {
-          if (player_.GetPlayerScore() == kNumberOfBallsPerType) {
-            player_.AddBallNumberScored(balls_[i].GetBallNumber());
-            player_.AddBallScore();
-            player_.SetGameState(Player::won);
-          } else {
-            player_.SetGameState(Player::lost);
-          }
-        } else if (player_.GetBallTypeToScore() != balls_[i].GetBallType()) {
-          player_.SetGameState(Player::lost);
+        while (next_pair < candidate_pairs_.size() &&
+               candidate_pairs_[next_pair].first == awake) {
+          Ball::HandlePoolBallsColliding(
+              balls_[i],
+              balls_[ball_order_[candidate_pairs_[next_pair].second]]);
+          candidate_pair_count_ += 1;
+          next_pair += 1;
         }
       }
+      balls_[i].Move();
+      // nothing later in the frame changes ball i, and a ball that didn't
+      // move has been checked for holes where it is. Balls in holes stay
+      // awake so the repositioned cue ball is checked where it was put.
+      balls_.SetAsleep(i, balls_[i].GetVelocity() == no_velocity);
+    }
+    if (balls_[i].GetVelocity() != no_velocity) {
+      num_balls_moving += 1;
+    }
+  }
+  return num_balls_moving;
+}
+
+template <typename Spec>
+template <typename Touching>
+void BasicBoard<Spec>::FindContacts(Touching touching) {
+  contacts_.clear();
+  auto add_if_touching = [&](size_t i, size_t j) {
+    candidate_pair_count_ += 1;
+    // balls in holes don't collide
+    if (!in_hole_[i] && !in_hole_[j] && touching(i, j)) {
+      // lower ball number first so a pair is resolved the same way
+      // whatever order the balls were set in
+      contacts_.push_back(std::make_pair(std::min(i, j), std::max(i, j)));
+    }
+  };
+  if (broad_phase_ == brute_force) {
+    for (size_t first = 0; first < num_awake_; first++) {
+      for (size_t second = first + 1; second < num_awake_; second++) {
+        add_if_touching(ball_order_[first], ball_order_[second]);
+      }
+    }
+  } else {
+    for (const std::pair<size_t, size_t> &candidate : candidate_pairs_) {
+      add_if_touching(ball_order_[candidate.first],
+                      ball_order_[candidate.second]);
+    }
+  }
+  // sweeping in ball number order rather than the order the balls were set
+  // in makes the result independent of that order and of the broad phase
+  std::sort(contacts_.begin(), contacts_.end());
+}
+
+template <typename Spec>
+size_t BasicBoard<Spec>::StepBallsTogether() {
+  // holes, cushions and friction first, so every contact is resolved from
+  // the velocities the balls start the collisions with
+  in_hole_.assign(balls_.GetCapacity(), false);
+  for (size_t awake = 0; awake < num_awake_; awake++) {
+    size_t i = ball_order_[awake];
+    if (CheckIfInHole(balls_[i])) {
+      in_hole_[i] = true;
     } else {
       balls_[i].HandleBoardCollision(
           inner_rect_bottom_pos_.x, inner_rect_top_pos_.x,
           inner_rect_top_pos_.y, inner_rect_bottom_pos_.y);
       balls_[i].DecreaseVelocity();
-      for (size_t j = i; j < balls_.size(); j++) {
-        Ball::HandlePoolBallsColliding(balls_[i], balls_[j]);
+    }
+  }
+  HandleBallsInHoles();
+  double reach = Ball::GetDiameter() + kOverlapTolerance;
+  FindContacts([&](size_t i, size_t j) {
+    dvec2 difference = balls_[i].GetPosition() - balls_[j].GetPosition();
+    return glm::dot(difference, difference) <= reach * reach;
+  });
+  // a pair resolved once is moving apart, later sweeps only pass on what
+  // other contacts changed
+  size_t num_sweeps = 0;
+  bool resolved_any = !contacts_.empty();
+  while (resolved_any && num_sweeps < kMaxContactIterations) {
+    resolved_any = false;
+    for (const std::pair<size_t, size_t> &contact : contacts_) {
+      if (Ball::HandlePoolBallsColliding(balls_[contact.first],
+                                         balls_[contact.second])) {
+        resolved_any = true;
       }
+    }
+    num_sweeps += 1;
+  }
+  POOL_PROFILE_COUNT("physics/contact sweeps", num_sweeps);
+  size_t num_balls_moving = 0;
+  dvec2 no_velocity = {0.0, 0.0};
+  for (size_t awake = 0; awake < num_awake_; awake++) {
+    size_t i = ball_order_[awake];
+    if (!in_hole_[i]) {
       balls_[i].Move();
+      // a ball that didn't move has been checked for holes where it is,
+      // balls in holes stay awake so the repositioned cue ball is checked
+      // where it was put
+      balls_.SetAsleep(i, balls_[i].GetVelocity() == no_velocity);
     }
-    dvec2 no_velocity = {0.0, 0.0};
     if (balls_[i].GetVelocity() != no_velocity) {
       num_balls_moving += 1;
     }
   }
-  // stick is made visible if all balls (including cue ball) are not
-  // not moving
-  if (num_balls_moving == 0) {
-    stick_visible_ = true;
+  contacts_.clear();
+  in_hole_.clear();
+  return num_balls_moving;
+}
+
+template <typename Spec>
+size_t BasicBoard<Spec>::StepBallsFixed() {
+  // sleeping balls are at rest and not touching an awake ball, stepping
+  // them in fixed point would leave them as they are
+  fixed_balls_.resize(balls_.GetCapacity());
+  in_hole_.assign(balls_.GetCapacity(), false);
+  // same order as the simultaneous solver: holes, cushions and friction,
+  // then the contacts at the start of the frame, then movement
+  for (size_t awake = 0; awake < num_awake_; awake++) {
+    size_t i = ball_order_[awake];
+    fixed_balls_[i] = FixedBall(balls_[i]);
+    for (const FixedVec2 &hole : fixed_hole_positions_) {
+      if (fixed_balls_[i].IsCenterWithin(hole, fixed_hole_radius_)) {
+        in_hole_[i] = true;
+        break;
+      }
+    }
+    if (!in_hole_[i]) {
+      fixed_balls_[i].HandleBoardCollision(
+          fixed_felt_right_, fixed_felt_left_, fixed_felt_top_,
+          fixed_felt_bottom_);
+      fixed_balls_[i].DecreaseVelocity();
+    }
+  }
+  HandleBallsInHoles();
+  // the broad phase looks a little further than the diameter, so it finds
+  // every pair the fixed point test does
+  FindContacts([&](size_t i, size_t j) {
+    return FixedBall::AreWithin(fixed_balls_[i], fixed_balls_[j],
+                                fixed_diameter_);
+  });
+  size_t num_sweeps = 0;
+  bool resolved_any = !contacts_.empty();
+  while (resolved_any && num_sweeps < kMaxContactIterations) {
+    resolved_any = false;
+    for (const std::pair<size_t, size_t> &contact : contacts_) {
+      if (FixedBall::HandlePoolBallsColliding(fixed_balls_[contact.first],
+                                              fixed_balls_[contact.second])) {
+        resolved_any = true;
+      }
+    }
+    num_sweeps += 1;
+  }
+  POOL_PROFILE_COUNT("physics/contact sweeps", num_sweeps);
+  // balls in holes keep what HandleBallInHole did to them
+  size_t num_balls_moving = 0;
+  dvec2 no_velocity = {0.0, 0.0};
+  for (size_t awake = 0; awake < num_awake_; awake++) {
+    size_t i = ball_order_[awake];
+    if (!in_hole_[i]) {
+      fixed_balls_[i].Move();
+      fixed_balls_[i].Store(balls_[i]);
+      // a ball that didn't move has been checked for holes where it is
+      balls_.SetAsleep(i, balls_[i].GetVelocity() == no_velocity);
+    }
+    if (balls_[i].GetVelocity() != no_velocity) {
+      num_balls_moving += 1;
+    }
+  }
+  fixed_balls_.clear();
+  contacts_.clear();
+  in_hole_.clear();
+  return num_balls_moving;
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::HandleBallsInHoles() {
+  // the first ball pocketed picks the type to score and the eight ball
+  // only wins after the rest, so the rules see balls pocketed in the same
+  // frame in number order whatever order they were set in
+  for (size_t i = 0; i < in_hole_.size(); i++) {
+    if (in_hole_[i] && HandleBallInHole(i)) {
+      balls_to_remove_.push_back(i);
+    }
+  }
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::WakeTouchingBalls() {
+  // awake balls go at the front and sleeping ones at the back, the vector
+  // keeps the same size so copies of the board don't allocate for it
+  const vector<size_t> &numbers = balls_.GetNumbers();
+  size_t num_balls = numbers.size();
+  ball_order_.resize(num_balls);
+  num_awake_ = 0;
+  size_t first_sleeping = num_balls;
+  for (size_t i : numbers) {
+    if (balls_.IsAsleep(i)) {
+      first_sleeping -= 1;
+      ball_order_[first_sleeping] = i;
+    } else {
+      ball_order_[num_awake_] = i;
+      num_awake_ += 1;
+    }
+  }
+  if (num_awake_ == 0 || num_awake_ == num_balls) {
+    return;
+  }
+  UpdateSleepingGrid();
+  // collisions are found from positions at the start of the frame, so a
+  // ball can only get moving this frame through a chain of balls touching
+  // now, same contact distance as the broad phase. A ball moving fast
+  // enough to reach a sleeping one during the frame is touching it at the
+  // start of the next, which is when the frame resolves the collision.
+  double radius = Ball::GetDiameter() / 2;
+  double reach = Ball::GetDiameter() + kOverlapTolerance;
+  dvec2 reach_box = {reach, reach};
+  size_t num_awake_before = num_awake_;
+  for (size_t next = 0; next < num_awake_ && num_awake_ < num_balls;
+       next++) {
+    dvec2 position = balls_[ball_order_[next]].GetPosition();
+    // the grid holds centers, a touching ball's center is within reach
+    dvec2 center = position + dvec2(radius, radius);
+    sleeping_grid_.ForEachBallInBox(
+        center - reach_box, center + reach_box, [&](size_t sleeping) {
+          size_t j = sleeping_balls_[sleeping].GetBallNumber();
+          dvec2 difference = balls_[j].GetPosition() - position;
+          if (balls_.IsAsleep(j) &&
+              glm::dot(difference, difference) <= reach * reach) {
+            balls_.SetAsleep(j, false);
+            ball_order_[num_awake_] = j;
+            num_awake_ += 1;
+          }
+        });
+  }
+  if (num_awake_ > num_awake_before) {
+    // back in the pool's order, which is the order they are stepped in
+    size_t awake = 0;
+    first_sleeping = num_balls;
+    for (size_t i : numbers) {
+      if (balls_.IsAsleep(i)) {
+        first_sleeping -= 1;
+        ball_order_[first_sleeping] = i;
+      } else {
+        ball_order_[awake] = i;
+        awake += 1;
+      }
+    }
+  }
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::UpdateSleepingGrid() {
+  // a new board's pool has been changed by putting balls in, so version 0
+  // is never current once there are sleeping balls
+  if (sleeping_grid_version_ == balls_.GetSleepVersion()) {
+    return;
+  }
+  num_sleeping_balls_ = ball_order_.size() - num_awake_;
+  for (size_t k = 0; k < num_sleeping_balls_; k++) {
+    sleeping_balls_[k] = balls_[ball_order_[num_awake_ + k]];
   }
-  for (size_t i = 0; i < balls_.size(); i++) {
-    if (balls_[i].GetPosition() == kOutsideOfView) {
-      balls_.erase(balls_.begin() + i);
+  sleeping_grid_.Build(sleeping_balls_.data(),
+                       sleeping_balls_.data() + num_sleeping_balls_);
+  sleeping_grid_version_ = balls_.GetSleepVersion();
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::Advance(double frames) {
+  previous_balls_ = balls_;
+  last_advance_frames_ = frames;
+  if (simulation_mode_ == event_driven) {
+    AdvanceByEvents(frames);
+    return;
+  }
+  frame_remainder_ += frames;
+  while (frame_remainder_ >= 1 - kFrameTolerance) {
+    AdvanceOneFrame();
+    frame_remainder_ -= 1;
+  }
+}
+
+template <typename Spec>
+vector<Ball> BasicBoard<Spec>::GetInterpolatedPoolBalls(
+    double interpolation_factor) const {
+  vector<Ball> balls;
+  GetInterpolatedPoolBalls(interpolation_factor, balls);
+  return balls;
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::GetInterpolatedPoolBalls(double interpolation_factor,
+                                     vector<Ball> &balls) const {
+  // copying keeps the vector's memory when it is big enough
+  balls_.GetBalls(balls);
+  // no ball moves further than its diameter in a frame, so a longer jump
+  // means it was placed somewhere new
+  double max_distance =
+      Ball::GetDiameter() * std::max(last_advance_frames_, 1.0);
+  for (size_t i = 0; i < balls.size(); i++) {
+    size_t number = balls[i].GetBallNumber();
+    if (!previous_balls_.IsInPlay(number)) {
+      continue;
+    }
+    dvec2 previous_position = previous_balls_[number].GetPosition();
+    dvec2 position = balls[i].GetPosition();
+    if (glm::distance(previous_position, position) <= max_distance) {
+      balls[i].SetPosition(
+          glm::mix(previous_position, position, interpolation_factor));
+    }
+  }
+}
+
+template <typename Spec>
+size_t BasicBoard<Spec>::AdvanceByEvents(double frames) {
+  POOL_PROFILE_SCOPE("physics/events");
+  size_t num_events = 0;
+  double time_left = frames;
+  // the event simulator works on packed balls, they are copied back into
+  // their slots whenever the rules look at the board
+  balls_.GetBalls(event_balls_);
+  while (player_.GetGameState() == Player::playing &&
+         num_events < kMaxEventsPerAdvance) {
+    typename EventSimulator::Event event =
+        event_simulator_.FindNextEvent(event_balls_, time_left);
+    EventSimulator::AdvanceBalls(event_balls_, event.time);
+    time_left -= event.time;
+    if (event.type == EventSimulator::no_event) {
+      break;
     }
+    num_events += 1;
+    if (event.type == EventSimulator::pocketed) {
+      balls_.Update(event_balls_);
+      // the ball can be removed right away, the packed copy is made again
+      // for the next event
+      size_t ball_number = event_balls_[event.first].GetBallNumber();
+      if (HandleBallInHole(ball_number)) {
+        balls_.Remove(ball_number);
+      }
+      balls_.GetBalls(event_balls_);
+    } else {
+      EventSimulator::ResolveEvent(event_balls_, event);
+    }
+  }
+  balls_.Update(event_balls_);
+  event_balls_.clear();
+  dvec2 no_velocity = {0.0, 0.0};
+  bool balls_moving = false;
+  for (size_t i : balls_.GetNumbers()) {
+    if (balls_[i].GetVelocity() != no_velocity) {
+      balls_moving = true;
+    }
+  }
+  if (!balls_moving) {
+    stick_visible_ = true;
+  }
+  POOL_PROFILE_COUNT("physics/events processed", num_events);
+  return num_events;
+}
+
+template <typename Spec>
+size_t BasicBoard<Spec>::SimulateUntilRest() {
+  if (simulation_mode_ == event_driven) {
+    return AdvanceByEvents(std::numeric_limits<double>::infinity());
+  }
+  size_t frames = 0;
+  while (!stick_visible_ && player_.GetGameState() == Player::playing) {
+    AdvanceOneFrame();
+    frames += 1;
   }
+  return frames;
 }
 
-void Board::ResetBoard() {
-  balls_.clear();
+template <typename Spec>
+typename BasicBoard<Spec>::ShotResult BasicBoard<Spec>::SimulateShot(
+    double angle, double power, BasicBoard &scratch) const {
+  return RunShot(angle, power, event_driven, scratch);
+}
+
+template <typename Spec>
+typename BasicBoard<Spec>::ShotResult BasicBoard<Spec>::SimulateShot(
+    double angle, double power) const {
+  BasicBoard scratch = BasicBoard(window_size_);
+  return RunShot(angle, power, event_driven, scratch);
+}
+
+template <typename Spec>
+typename BasicBoard<Spec>::ShotResult BasicBoard<Spec>::PlayShot(
+    double angle, double power, BasicBoard &scratch) const {
+  return RunShot(angle, power, simulation_mode_, scratch);
+}
+
+template <typename Spec>
+typename BasicBoard<Spec>::ShotResult BasicBoard<Spec>::RunShot(
+    double angle, double power, SimulationMode mode,
+    BasicBoard &scratch) const {
+  // a shot that is never played isn't part of the frame being profiled
+  POOL_PROFILE_PAUSE();
+  scratch.Restore(Save());
+  scratch.SetSimulationMode(mode);
+  scratch.SetBroadPhase(broad_phase_);
+  scratch.SetContactSolver(contact_solver_);
+  scratch.HitCueBall(angle, power);
+  ShotResult result;
+  result.num_events = scratch.SimulateUntilRest();
+  scratch.balls_.GetBalls(result.balls);
+  result.pocketed_ball_numbers = scratch.pocketed_this_shot_;
+  result.game_state = scratch.player_.GetGameState();
+  result.ball_type_to_score = scratch.player_.GetBallTypeToScore();
+  result.player_score = scratch.player_.GetPlayerScore();
+  result.cue_in_hole = scratch.cue_in_hole_;
+  return result;
+}
+
+template <typename Spec>
+double BasicBoard<Spec>::GetMinShotPower() {
+  return Ball::GetInitialVelocityBoost();
+}
+
+template <typename Spec>
+double BasicBoard<Spec>::GetMaxShotPower() {
+  return Ball::GetInitialVelocityBoost() + kVelocityPower;
+}
+
+template <typename Spec>
+const vector<size_t> &BasicBoard<Spec>::GetBallsPocketedThisShot() const {
+  return pocketed_this_shot_;
+}
+
+template <typename Spec>
+BoardState BasicBoard<Spec>::Save() const {
+  BoardState state;
+  // copy of the constant so std::min can take it by reference
+  size_t const max_balls = BoardState::kMaxBalls;
+  const vector<size_t> &numbers = balls_.GetNumbers();
+  state.num_balls = std::min(numbers.size(), max_balls);
+  for (size_t i = 0; i < state.num_balls; i++) {
+    state.balls[i] = balls_[numbers[i]];
+  }
+  vector<size_t> const &scored = player_.GetBallNumbers();
+  state.num_ball_numbers_scored = std::min(scored.size(), max_balls);
+  std::copy(scored.begin(), scored.begin() + state.num_ball_numbers_scored,
+            state.ball_numbers_scored);
+  state.player_score = player_.GetPlayerScore();
+  state.ball_type_to_score = player_.GetBallTypeToScore();
+  state.game_state = player_.GetGameState();
+  state.num_pocketed_this_shot =
+      std::min(pocketed_this_shot_.size(), max_balls);
+  std::copy(pocketed_this_shot_.begin(),
+            pocketed_this_shot_.begin() + state.num_pocketed_this_shot,
+            state.pocketed_this_shot);
+  state.stick = cue_stick_;
+  state.stick_visible = stick_visible_;
+  state.cue_in_hole = cue_in_hole_;
+  state.aim_line_length = aim_line_length_;
+  state.frame_remainder = frame_remainder_;
+  return state;
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::Restore(const BoardState &state) {
+  // the pool's storage is never reallocated
+  balls_.Assign(state.balls, state.balls + state.num_balls);
+  player_.ResetPlayer();
+  for (size_t i = 0; i < state.num_ball_numbers_scored; i++) {
+    player_.AddBallNumberScored(state.ball_numbers_scored[i]);
+  }
+  player_.SetPlayerScore(state.player_score);
+  player_.SetBallTypeToScore(state.ball_type_to_score);
+  player_.SetGameState(state.game_state);
+  pocketed_this_shot_.assign(
+      state.pocketed_this_shot,
+      state.pocketed_this_shot + state.num_pocketed_this_shot);
+  cue_stick_ = state.stick;
+  stick_visible_ = state.stick_visible;
+  cue_in_hole_ = state.cue_in_hole;
+  aim_line_length_ = state.aim_line_length;
+  frame_remainder_ = state.frame_remainder;
+  previous_balls_.Clear();
+  last_advance_frames_ = 0;
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::SetSimulationMode(SimulationMode mode) {
+  simulation_mode_ = mode;
+  // events move balls without keeping the sleep flags
+  balls_.WakeAll();
+}
+
+template <typename Spec>
+typename BasicBoard<Spec>::SimulationMode
+BasicBoard<Spec>::GetSimulationMode() const {
+  return simulation_mode_;
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::SetBroadPhase(BroadPhase broad_phase) {
+  broad_phase_ = broad_phase;
+}
+
+template <typename Spec>
+typename BasicBoard<Spec>::BroadPhase BasicBoard<Spec>::GetBroadPhase() const {
+  return broad_phase_;
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::SetContactSolver(ContactSolver contact_solver) {
+  contact_solver_ = contact_solver;
+}
+
+template <typename Spec>
+typename BasicBoard<Spec>::ContactSolver
+BasicBoard<Spec>::GetContactSolver() const {
+  return contact_solver_;
+}
+
+template <typename Spec>
+size_t BasicBoard<Spec>::GetCandidatePairCount() const {
+  return candidate_pair_count_;
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::ResetBoard() {
+  balls_.Clear();
+  pocketed_this_shot_.clear();
+  previous_balls_.Clear();
+  frame_remainder_ = 0;
   cue_stick_.ResetStick();
   stick_visible_ = true;
   cue_in_hole_ = false;
   player_.ResetPlayer();
 }
 
-void Board::UpdateStickRight() {
+template <typename Spec>
+void BasicBoard<Spec>::UpdateStickRight() {
   cue_stick_.RotateStickCounterClockwise();
 }
 
-void Board::UpdateStickLeft() {
+template <typename Spec>
+void BasicBoard<Spec>::UpdateStickLeft() {
   cue_stick_.RotateStickClockwise();
 }
 
-void Board::PullStickBackForShot() {
+template <typename Spec>
+void BasicBoard<Spec>::PullStickBackForShot() {
   cue_stick_.PullBackStick();
   double pull_dist = cue_stick_.GetPullBackDistance();
   double max_dist = cue_stick_.GetMaxPullBackDistance();
@@ -316,54 +910,117 @@ void Board::PullStickBackForShot() {
                      min_line_length_;
 }
 
-Player::GameState Board::GetPlayerState() const {
+template <typename Spec>
+Player::GameState BasicBoard<Spec>::GetPlayerState() const {
   return player_.GetGameState();
 }
 
-double Board::GetAimLineLength() const {
+template <typename Spec>
+double BasicBoard<Spec>::GetAimLineLength() const {
   return aim_line_length_;
 }
 
-double Board::GetRightXBoundary() const {
+template <typename Spec>
+double BasicBoard<Spec>::GetShotAngle() const {
+  return cue_stick_.GetAngle() + kInitialStickAngle;
+}
+
+template <typename Spec>
+double BasicBoard<Spec>::GetRightXBoundary() const {
   return inner_rect_bottom_pos_.x;
 }
 
-double Board::GetLeftXBoundary() const {
+template <typename Spec>
+double BasicBoard<Spec>::GetLeftXBoundary() const {
   return inner_rect_top_pos_.x;
 }
 
-double Board::GetTopYBoundary() const {
+template <typename Spec>
+double BasicBoard<Spec>::GetTopYBoundary() const {
   return inner_rect_top_pos_.y;
 }
 
-double Board::GetBottomYBoundary() const {
+template <typename Spec>
+double BasicBoard<Spec>::GetBottomYBoundary() const {
   return inner_rect_bottom_pos_.y;
 }
 
-void Board::SetPoolBalls(const vector<Ball> &balls) {
-  balls_ = balls;
+template <typename Spec>
+void BasicBoard<Spec>::SetPoolBalls(const vector<Ball> &balls) {
+  balls_.Assign(balls);
+  previous_balls_.Clear();
 }
 
-vector<Ball> Board::GetPoolBalls() {
+template <typename Spec>
+vector<Ball> BasicBoard<Spec>::GetPoolBalls() const {
+  vector<Ball> balls;
+  balls_.GetBalls(balls);
+  return balls;
+}
+
+template <typename Spec>
+void BasicBoard<Spec>::GetPoolBalls(vector<Ball> &balls) const {
+  balls_.GetBalls(balls);
+}
+
+template <typename Spec>
+const BallPool &BasicBoard<Spec>::GetBallPool() const {
   return balls_;
 }
 
-double Board::GetHoleRadius() {
-  return hole_radius_;
+template <typename Spec>
+double BasicBoard<Spec>::GetHoleRadius() const {
+  return Spec::kPocketRadius;
+}
+
+template <typename Spec>
+const typename BasicBoard<Spec>::HolePositions &
+BasicBoard<Spec>::GetHolePositions() const {
+  return hole_positions_;
+}
+
+template <typename Spec>
+dvec2 BasicBoard<Spec>::GetOuterRectTopPosition() const {
+  return outer_rect_top_pos_;
+}
+
+template <typename Spec>
+dvec2 BasicBoard<Spec>::GetOuterRectBottomPosition() const {
+  return outer_rect_bottom_pos_;
 }
 
-bool Board::GetStickVisibility() {
+template <typename Spec>
+double BasicBoard<Spec>::GetViewScale() const {
+  double width = Spec::kOuterRight + Spec::kOuterLeft;
+  double height = Spec::kOuterBottom + Spec::kOuterLeft;
+  return std::min(1.0, std::min(window_size_ / width, window_size_ / height));
+}
+
+template <typename Spec>
+bool BasicBoard<Spec>::GetStickVisibility() const {
   return stick_visible_;
 }
 
-void Board::SetCueBallPosition(const dvec2 &position) {
+template <typename Spec>
+void BasicBoard<Spec>::SetCueBallPosition(const dvec2 &position) {
   balls_[0].SetPosition(position);
+  balls_.SetAsleep(0, false);
 }
 
-Player Board::GetPlayer() const {
+template <typename Spec>
+const Player &BasicBoard<Spec>::GetPlayer() const {
   return player_;
 }
-Stick Board::GetStick() const {
+template <typename Spec>
+const Stick &BasicBoard<Spec>::GetStick() const {
   return cue_stick_;
 }
+
+// every table BasicBoard is built for, see table_spec.h
+template class BasicBoard<ClassicTable>;
+template class BasicBoard<SevenFootTable>;
+template class BasicBoard<EightFootTable>;
+template class BasicBoard<NineFootTable>;
+template class BasicBoard<SnookerTable>;
+template class BasicBoard<CaromTable>;
 }  // namespace pool
@@ -0,0 +1,351 @@
+#include "board_renderer.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+
+#include "cinder/ip/Fill.h"
+namespace pool {
+
+namespace {
+// places a unit quad at each ball's rect and picks its image from the atlas,
+// y goes down the screen and down the atlas
+const char *const kBallVertexShader = R"(#version 150
+uniform mat4 ciModelViewProjection;
+in vec4 ciPosition;
+in vec4 instanceRect;
+in vec4 instanceUvRect;
+out vec2 uv;
+void main() {
+  uv = mix(instanceUvRect.xy, instanceUvRect.zw, ciPosition.xy);
+  vec2 position = instanceRect.xy + ciPosition.xy * instanceRect.zw;
+  gl_Position = ciModelViewProjection * vec4(position, 0.0, 1.0);
+}
+)";
+
+const char *const kBallFragmentShader = R"(#version 150
+uniform sampler2D atlas;
+in vec2 uv;
+out vec4 color;
+void main() {
+  color = texture(atlas, uv);
+}
+)";
+}  // namespace
+
+template <typename Spec>
+void BasicBoardRenderer<Spec>::LoadBallImages(
+    const vector<ci::SurfaceRef> &images) {
+  vector<ivec2> sizes;
+  for (const ci::SurfaceRef &image : images) {
+    sizes.push_back(image->getSize());
+  }
+  ball_layout_ = SpriteAtlas(sizes);
+  ci::Surface atlas =
+      ci::Surface(ball_layout_.GetSize().x, ball_layout_.GetSize().y, true);
+  // padding stays transparent
+  ci::ip::fill(&atlas, ci::ColorA8u(0, 0, 0, 0));
+  for (size_t i = 0; i < images.size(); i++) {
+    atlas.copyFrom(*images[i], images[i]->getBounds(),
+                   ball_layout_.GetRegion(i).position);
+  }
+  // top down so texture coordinates match SpriteAtlas::GetUvRect
+  ball_atlas_ = ci::gl::Texture2d::create(
+      atlas, ci::gl::Texture2d::Format().loadTopDown());
+
+  ci::gl::GlslProgRef shader =
+      ci::gl::GlslProg::create(ci::gl::GlslProg::Format()
+                                   .vertex(kBallVertexShader)
+                                   .fragment(kBallFragmentShader));
+  shader->uniform("atlas", 0);
+  // room for every ball on the table and every scored ball, grown in
+  // DrawBalls when a table has more
+  ball_instance_vbo_ = ci::gl::Vbo::create(
+      GL_ARRAY_BUFFER, 2 * images.size() * sizeof(BallInstance), nullptr,
+      GL_DYNAMIC_DRAW);
+  ci::geom::BufferLayout instance_layout;
+  // last argument makes the attributes advance once per instance
+  instance_layout.append(ci::geom::Attrib::CUSTOM_0, 4, sizeof(BallInstance),
+                         offsetof(BallInstance, rect), 1);
+  instance_layout.append(ci::geom::Attrib::CUSTOM_1, 4, sizeof(BallInstance),
+                         offsetof(BallInstance, uv_rect), 1);
+  ci::gl::VboMeshRef quad =
+      ci::gl::VboMesh::create(ci::geom::Rect(ci::Rectf(0, 0, 1, 1)));
+  quad->appendVbo(instance_layout, ball_instance_vbo_);
+  ball_batch_ = ci::gl::Batch::create(
+      quad, shader,
+      {{ci::geom::Attrib::CUSTOM_0, "instanceRect"},
+       {ci::geom::Attrib::CUSTOM_1, "instanceUvRect"}});
+}
+
+template <typename Spec>
+void BasicBoardRenderer<Spec>::Display(const Board &board,
+                                       double interpolation_factor) const {
+  // everything is drawn in table units, scaled down for long tables
+  ci::gl::ScopedModelMatrix model;
+  float scale = static_cast<float>(board.GetViewScale());
+  ci::gl::scale(scale, scale);
+  {
+    POOL_PROFILE_SCOPE("draw/table");
+    DrawTable(board);
+  }
+  // displays the balls the player hit into holes above the pool board
+  if (board.GetPlayerState() == Player::playing) {
+    vector<Ball> &balls = interpolated_balls_;
+    {
+      POOL_PROFILE_SCOPE("draw/balls");
+      board.GetInterpolatedPoolBalls(interpolation_factor, balls);
+      for (size_t i = 0; i < balls.size(); i++) {
+        AddBall(balls[i].GetPosition(), Ball::GetDiameter(),
+                balls[i].GetBallNumber());
+      }
+      AddScoredBalls(board.GetPlayer());
+      DrawBalls();
+    }
+    if (board.GetStickVisibility()) {
+      POOL_PROFILE_SCOPE("draw/stick and aim");
+      DrawStick(board.GetStick(), balls[0]);
+      DrawLine(board);
+    }
+  }
+}
+
+template <typename Spec>
+void BasicBoardRenderer<Spec>::DisplayWinningMessage(
+    const Board &board) const {
+  DrawMessage(board, "You Won! Press SPACE to play again!");
+}
+
+template <typename Spec>
+void BasicBoardRenderer<Spec>::DisplayLosingMessage(
+    const Board &board) const {
+  DrawMessage(board, "You Lost! Press SPACE to play again");
+}
+
+template <typename Spec>
+void BasicBoardRenderer<Spec>::DisplayProfiler(
+    const vector<Profiler::Stats> &stats) const {
+  POOL_PROFILE_SCOPE("draw/profiler");
+  ci::gl::color(ci::ColorA("black", 0.75f));
+  ci::gl::drawSolidRect(ci::Rectf(
+      kProfilerPosition,
+      kProfilerPosition +
+          ci::vec2(kProfilerWidth, kProfilerLineHeight * (stats.size() + 1))));
+  const ci::gl::TextureFontRef &font = GetFont(profiler_font_, "Courier", 14);
+  ci::gl::color(ci::Color("white"));
+  // strings are drawn from their baseline
+  ci::vec2 baseline = kProfilerPosition + ci::vec2(0, font->getAscent());
+  char line[128];
+  std::snprintf(line, sizeof(line), "%-28s %8s %8s %8s", "ms / count", "last",
+                "average", "worst");
+  font->drawString(line, baseline);
+  for (size_t i = 0; i < stats.size(); i++) {
+    const char *format = stats[i].is_counter ? "%-28s %8.0f %8.1f %8.0f"
+                                             : "%-28s %8.2f %8.2f %8.2f";
+    std::snprintf(line, sizeof(line), format, stats[i].name, stats[i].last,
+                  stats[i].average, stats[i].worst);
+    font->drawString(line,
+                     baseline + ci::vec2(0, kProfilerLineHeight * (i + 1)));
+  }
+  POOL_PROFILE_COUNT("draw/draw calls", stats.size() + 2);
+}
+
+template <typename Spec>
+void BasicBoardRenderer<Spec>::DrawMessage(const Board &board,
+                                           const std::string &message) const {
+  ci::gl::ScopedModelMatrix model;
+  float scale = static_cast<float>(board.GetViewScale());
+  ci::gl::scale(scale, scale);
+  ci::vec2 text_center_pos = {
+      (board.GetRightXBoundary() + board.GetLeftXBoundary()) / 2,
+      (board.GetBottomYBoundary() + board.GetTopYBoundary()) / 2};
+  const ci::gl::TextureFontRef &font = GetFont(message_font_, "Arial", 30);
+  ci::vec2 size = font->measureString(message);
+  // baseline that puts the middle of the text on the center
+  ci::vec2 baseline =
+      text_center_pos +
+      ci::vec2(-size.x / 2, (font->getAscent() - font->getDescent()) / 2);
+  ci::gl::color(ci::Color("black"));
+  font->drawString(message, baseline);
+  POOL_PROFILE_COUNT("draw/draw calls", 1);
+}
+
+template <typename Spec>
+dvec2 BasicBoardRenderer<Spec>::ToBoardPosition(
+    const Board &board, const ci::ivec2 &window_position) {
+  return dvec2(window_position.x, window_position.y) / board.GetViewScale();
+}
+
+template <typename Spec>
+typename BasicBoardRenderer<Spec>::TableShape
+BasicBoardRenderer<Spec>::GetTableShape(const Board &board) {
+  TableShape shape;
+  shape.outer_bottom = board.GetOuterRectBottomPosition();
+  shape.outer_top = board.GetOuterRectTopPosition();
+  shape.felt_bottom =
+      dvec2(board.GetRightXBoundary(), board.GetBottomYBoundary());
+  shape.felt_top = dvec2(board.GetLeftXBoundary(), board.GetTopYBoundary());
+  shape.hole_positions = board.GetHolePositions();
+  shape.hole_radius = board.GetHoleRadius();
+  return shape;
+}
+
+template <typename Spec>
+bool BasicBoardRenderer<Spec>::TableShape::Matches(const Board &board) const {
+  return outer_bottom == board.GetOuterRectBottomPosition() &&
+         outer_top == board.GetOuterRectTopPosition() &&
+         felt_bottom == dvec2(board.GetRightXBoundary(),
+                              board.GetBottomYBoundary()) &&
+         felt_top ==
+             dvec2(board.GetLeftXBoundary(), board.GetTopYBoundary()) &&
+         hole_positions == board.GetHolePositions() &&
+         hole_radius == board.GetHoleRadius();
+}
+
+template <typename Spec>
+void BasicBoardRenderer<Spec>::BuildTableBatch(
+    const TableShape &shape) const {
+  ci::TriMesh mesh = ci::TriMesh(ci::TriMesh::Format().positions(2).colors(3));
+  auto add_rect = [&mesh](const dvec2 &corner, const dvec2 &opposite,
+                          const ci::Color &color) {
+    uint32_t first = static_cast<uint32_t>(mesh.getNumVertices());
+    mesh.appendPosition(ci::vec2(corner));
+    mesh.appendPosition(ci::vec2(opposite.x, corner.y));
+    mesh.appendPosition(ci::vec2(opposite));
+    mesh.appendPosition(ci::vec2(corner.x, opposite.y));
+    for (size_t i = 0; i < 4; i++) {
+      mesh.appendColorRgb(color);
+    }
+    mesh.appendTriangle(first, first + 1, first + 2);
+    mesh.appendTriangle(first, first + 2, first + 3);
+  };
+  // later shapes are drawn over earlier ones, holes go on the felt
+  add_rect(shape.outer_bottom, shape.outer_top,
+           ci::Color(kPoolBoardOutlineColor));
+  add_rect(shape.felt_bottom, shape.felt_top, ci::Color(kPoolBoardColor));
+  for (const dvec2 &hole : shape.hole_positions) {
+    // triangle fan around the center
+    uint32_t center = static_cast<uint32_t>(mesh.getNumVertices());
+    mesh.appendPosition(ci::vec2(hole));
+    mesh.appendColorRgb(ci::Color("black"));
+    for (size_t i = 0; i < kHoleSegments; i++) {
+      double angle = 2 * M_PI * i / kHoleSegments;
+      mesh.appendPosition(ci::vec2(
+          hole + shape.hole_radius * dvec2(std::cos(angle), std::sin(angle))));
+      mesh.appendColorRgb(ci::Color("black"));
+      uint32_t next = static_cast<uint32_t>((i + 1) % kHoleSegments);
+      mesh.appendTriangle(center, center + 1 + static_cast<uint32_t>(i),
+                          center + 1 + next);
+    }
+  }
+  table_batch_ = ci::gl::Batch::create(
+      mesh, ci::gl::getStockShader(ci::gl::ShaderDef().color()));
+}
+
+template <typename Spec>
+void BasicBoardRenderer<Spec>::DrawTable(const Board &board) const {
+  if (!table_batch_ || !table_shape_.Matches(board)) {
+    table_shape_ = GetTableShape(board);
+    BuildTableBatch(table_shape_);
+  }
+  ci::gl::color(ci::Color("white"));
+  table_batch_->draw();
+  POOL_PROFILE_COUNT("draw/draw calls", 1);
+}
+
+template <typename Spec>
+const ci::gl::TextureFontRef &BasicBoardRenderer<Spec>::GetFont(
+    ci::gl::TextureFontRef &font, const std::string &name, float size) {
+  if (!font) {
+    font = ci::gl::TextureFont::create(ci::Font(name, size));
+  }
+  return font;
+}
+
+template <typename Spec>
+void BasicBoardRenderer<Spec>::AddBall(const dvec2 &position, double diameter,
+                                       size_t ball_number) const {
+  BallInstance instance;
+  instance.rect = ci::vec4(position.x, position.y, diameter, diameter);
+  instance.uv_rect = ball_layout_.GetUvRect(ball_number);
+  ball_instances_.push_back(instance);
+}
+
+template <typename Spec>
+void BasicBoardRenderer<Spec>::DrawBalls() const {
+  if (ball_instances_.empty()) {
+    return;
+  }
+  size_t bytes = ball_instances_.size() * sizeof(BallInstance);
+  ball_instance_vbo_->ensureMinimumSize(bytes);
+  ball_instance_vbo_->bufferSubData(0, bytes, ball_instances_.data());
+  ci::gl::ScopedBlendAlpha blend;
+  ci::gl::ScopedTextureBind texture(ball_atlas_, 0);
+  ball_batch_->drawInstanced(static_cast<GLsizei>(ball_instances_.size()));
+  ball_instances_.clear();
+  POOL_PROFILE_COUNT("draw/draw calls", 1);
+}
+
+template <typename Spec>
+void BasicBoardRenderer<Spec>::DrawStick(const Stick &stick,
+                                         const Ball &cue_ball) const {
+  ci::gl::color(ci::Color(kStickColor));
+  ci::gl::pushModelMatrix();
+  // grid is rotated by rad
+  double x = cue_ball.GetPosition().x + Ball::GetDiameter() / 2;
+  double y = cue_ball.GetPosition().y + Ball::GetDiameter() / 2;
+  ci::gl::translate({x, y});
+  ci::gl::rotate(stick.GetAngle());
+  // change position to match rotated grid
+  double width = stick.GetStickWidth();
+  ci::gl::drawSolidRect(ci::Rectf(
+      {-width,
+       stick.GetPullBackDistance() + stick.GetInitialSpaceFromCueBall()},
+      {width, stick.GetStickHeight()}));
+  ci::gl::popModelMatrix();
+  POOL_PROFILE_COUNT("draw/draw calls", 1);
+}
+
+template <typename Spec>
+void BasicBoardRenderer<Spec>::DrawLine(const Board &board) const {
+  const typename AimPreview::Path &path = aim_preview_.Update(board);
+  ci::gl::color(ci::Color("white"));
+  for (size_t i = 1; i < path.points.size(); i++) {
+    ci::gl::drawLine(path.points[i - 1], path.points[i]);
+  }
+  if (path.hits_ball) {
+    // outline of where the cue ball is when it touches the other ball
+    ci::gl::drawStrokedCircle(path.ghost_position, Ball::GetDiameter() / 2);
+    dvec2 object_center =
+        path.ghost_position + path.object_ball_direction * Ball::GetDiameter();
+    ci::gl::drawLine(object_center,
+                     object_center +
+                         path.object_ball_direction * kDeflectionLineLength);
+    ci::gl::color(ci::ColorA("white", 0.5f));
+    ci::gl::drawLine(path.ghost_position,
+                     path.ghost_position +
+                         path.cue_ball_direction * kDeflectionLineLength);
+    POOL_PROFILE_COUNT("draw/draw calls", 3);
+  }
+  if (!path.points.empty()) {
+    POOL_PROFILE_COUNT("draw/draw calls", path.points.size() - 1);
+  }
+}
+
+template <typename Spec>
+void BasicBoardRenderer<Spec>::AddScoredBalls(const Player &player) const {
+  dvec2 position = {kSpaceBetweenBalls, kSpaceBetweenBalls};
+  const vector<size_t> &ball_numbers = player.GetBallNumbers();
+  for (size_t i = 0; i < ball_numbers.size(); i++) {
+    AddBall(position, 2 * Ball::GetDiameter(), ball_numbers[i]);
+    position.x += kSpaceBetweenBalls;
+  }
+}
+
+template class BasicBoardRenderer<ClassicTable>;
+template class BasicBoardRenderer<SevenFootTable>;
+template class BasicBoardRenderer<EightFootTable>;
+template class BasicBoardRenderer<NineFootTable>;
+template class BasicBoardRenderer<SnookerTable>;
+template class BasicBoardRenderer<CaromTable>;
+}  // namespace pool
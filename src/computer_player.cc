@@ -0,0 +1,196 @@
+#include "computer_player.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+
+#include "profiler.h"
+namespace pool {
+template <typename Spec>
+BasicComputerPlayer<Spec>::BasicComputerPlayer(Difficulty difficulty)
+    : settings_(GetDifficultySettings(difficulty)), seed_(kDefaultSeed) {
+}
+
+template <typename Spec>
+BasicComputerPlayer<Spec>::BasicComputerPlayer(const Settings &settings,
+                                               unsigned seed)
+    : settings_(settings), seed_(seed) {
+}
+
+template <typename Spec>
+typename BasicComputerPlayer<Spec>::Settings
+BasicComputerPlayer<Spec>::GetDifficultySettings(Difficulty difficulty) {
+  // sized so a single core gets through every shot from the break inside
+  // the budget, see pool-bench for the throughput
+  Settings settings;
+  settings.num_threads = 0;
+  if (difficulty == easy) {
+    settings.num_angles = 24;
+    settings.num_powers = 3;
+    settings.samples_per_shot = 2;
+    settings.angle_noise = 0.05;
+    settings.power_noise = 0.5;
+    settings.time_budget_seconds = 0.1;
+  } else if (difficulty == medium) {
+    settings.num_angles = 72;
+    settings.num_powers = 4;
+    settings.samples_per_shot = 4;
+    settings.angle_noise = 0.02;
+    settings.power_noise = 0.3;
+    settings.time_budget_seconds = 0.5;
+  } else {
+    settings.num_angles = 360;
+    settings.num_powers = 6;
+    settings.samples_per_shot = 8;
+    settings.angle_noise = 0.005;
+    settings.power_noise = 0.1;
+    settings.time_budget_seconds = 2;
+  }
+  return settings;
+}
+
+template <typename Spec>
+typename BasicComputerPlayer<Spec>::Shot BasicComputerPlayer<Spec>::ChooseShot(
+    const Board &board) const {
+  POOL_PROFILE_SCOPE("computer/choose shot");
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point deadline =
+      start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                  std::chrono::duration<double>(settings_.time_budget_seconds));
+
+  vector<Candidate> candidates;
+  size_t num_angles = std::max(settings_.num_angles, (size_t)1);
+  size_t num_powers = std::max(settings_.num_powers, (size_t)1);
+  double power_range = Board::GetMaxShotPower() - Board::GetMinShotPower();
+  for (size_t a = 0; a < num_angles; a++) {
+    for (size_t p = 0; p < num_powers; p++) {
+      Candidate candidate;
+      candidate.angle = 2 * M_PI * (double)a / (double)num_angles;
+      candidate.power = Board::GetMinShotPower() +
+                        power_range * (double)(p + 1) / (double)num_powers;
+      candidate.total_score = 0;
+      candidate.samples = 0;
+      candidates.push_back(candidate);
+    }
+  }
+  // shuffled so a search cut short by the budget has still tried shots all
+  // around the table
+  std::mt19937 generator(seed_);
+  std::shuffle(candidates.begin(), candidates.end(), generator);
+
+  size_t num_threads = settings_.num_threads;
+  if (num_threads == 0) {
+    num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  num_threads = std::min(num_threads, candidates.size());
+
+  BoardState state = board.Save();
+  std::atomic<size_t> next_candidate(0);
+  // one board per worker, restored from the state for every sample
+  vector<Board> boards(num_threads, board);
+  vector<std::thread> workers;
+  for (size_t i = 1; i < num_threads; i++) {
+    workers.push_back(std::thread(&BasicComputerPlayer::SearchCandidates, this,
+                                  std::ref(boards[i]), std::cref(state),
+                                  std::ref(candidates),
+                                  std::ref(next_candidate), deadline));
+  }
+  SearchCandidates(boards[0], state, candidates, next_candidate, deadline);
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+
+  Shot shot;
+  shot.shots_simulated = 0;
+  shot.candidates_tried = 0;
+  const Candidate *best = nullptr;
+  for (const Candidate &candidate : candidates) {
+    if (candidate.samples == 0) {
+      continue;
+    }
+    shot.shots_simulated += candidate.samples;
+    shot.candidates_tried += 1;
+    if (best == nullptr || candidate.total_score / candidate.samples >
+                               best->total_score / best->samples) {
+      best = &candidate;
+    }
+  }
+  // every worker tries at least one candidate so best is always set
+  shot.angle = best->angle;
+  shot.power = best->power;
+  shot.expected_score = best->total_score / best->samples;
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  shot.shots_per_second = shot.shots_simulated / elapsed.count();
+  return shot;
+}
+
+template <typename Spec>
+double BasicComputerPlayer<Spec>::ScoreOutcome(const BoardState &before,
+                                               const BoardState &after) {
+  if (after.game_state == Player::won) {
+    return kWinScore;
+  }
+  if (after.game_state == Player::lost) {
+    return kLoseScore;
+  }
+  double score =
+      kBallScore * ((double)after.player_score - (double)before.player_score);
+  if (after.cue_in_hole) {
+    score += kCueInHoleScore;
+  }
+  return score;
+}
+
+template <typename Spec>
+const typename BasicComputerPlayer<Spec>::Settings &
+BasicComputerPlayer<Spec>::GetSettings() const {
+  return settings_;
+}
+
+template <typename Spec>
+void BasicComputerPlayer<Spec>::SearchCandidates(
+    Board &board, const BoardState &state, vector<Candidate> &candidates,
+    std::atomic<size_t> &next_candidate,
+    std::chrono::steady_clock::time_point deadline) const {
+  // scaled by the settings' standard deviations, which can be 0
+  std::normal_distribution<double> noise(0, 1);
+  // candidates would swamp the frame's physics numbers and the trace, the
+  // whole search is timed by "computer/choose shot" instead
+  POOL_PROFILE_PAUSE();
+  // check the deadline after each candidate so every worker tries at least
+  // one
+  do {
+    size_t index = next_candidate.fetch_add(1);
+    if (index >= candidates.size()) {
+      return;
+    }
+    Candidate &candidate = candidates[index];
+    // noise only depends on the candidate, not on which worker took it
+    std::seed_seq seed = {seed_, (unsigned)index};
+    std::mt19937 generator(seed);
+    noise.reset();
+    size_t num_samples = std::max(settings_.samples_per_shot, (size_t)1);
+    for (size_t sample = 0; sample < num_samples; sample++) {
+      double angle = candidate.angle + settings_.angle_noise * noise(generator);
+      double power = candidate.power + settings_.power_noise * noise(generator);
+      power = std::min(std::max(power, Board::GetMinShotPower()),
+                       Board::GetMaxShotPower());
+      board.Restore(state);
+      board.HitCueBall(angle, power);
+      board.SimulateUntilRest();
+      candidate.total_score += ScoreOutcome(state, board.Save());
+      candidate.samples += 1;
+    }
+  } while (std::chrono::steady_clock::now() < deadline);
+}
+
+template class BasicComputerPlayer<ClassicTable>;
+template class BasicComputerPlayer<SevenFootTable>;
+template class BasicComputerPlayer<EightFootTable>;
+template class BasicComputerPlayer<NineFootTable>;
+template class BasicComputerPlayer<SnookerTable>;
+template class BasicComputerPlayer<CaromTable>;
+}  // namespace pool
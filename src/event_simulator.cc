@@ -0,0 +1,415 @@
+#include "event_simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+namespace pool {
+
+namespace {
+// highest degree polynomial solved for, squared distance between two balls
+// moving along parabolas is a quartic
+int const kMaxDegree = 4;
+// bisection stops once the root is bracketed this tightly
+double const kTimeTolerance = 1e-10;
+size_t const kMaxBisections = 100;
+double const kNever = std::numeric_limits<double>::infinity();
+
+/**
+ * Evaluates polynomial c[0] + c[1] t + ... + c[degree] t^degree.
+ */
+double Evaluate(const double *coefficients, int degree, double t) {
+  double value = coefficients[degree];
+  for (int i = degree - 1; i >= 0; i--) {
+    value = value * t + coefficients[i];
+  }
+  return value;
+}
+
+/**
+ * Narrows down a sign change of the polynomial between low and high with
+ * Newton steps, falling back to bisection when a step leaves the bracket.
+ * @return end of the final bracket that has the same sign as f(high), so a
+ * crossing into f <= 0 is returned at a time where f <= 0.
+ */
+double Bisect(const double *coefficients, int degree, double low,
+              double high) {
+  double derivative[kMaxDegree];
+  for (int i = 1; i <= degree; i++) {
+    derivative[i - 1] = i * coefficients[i];
+  }
+  bool low_positive = Evaluate(coefficients, degree, low) > 0;
+  double guess = (low + high) / 2;
+  for (size_t i = 0; i < kMaxBisections && high - low > kTimeTolerance; i++) {
+    double value = Evaluate(coefficients, degree, guess);
+    if ((value > 0) == low_positive) {
+      low = guess;
+    } else {
+      high = guess;
+    }
+    double slope = Evaluate(derivative, degree - 1, guess);
+    double next = slope != 0 ? guess - value / slope : guess;
+    if (std::abs(next - guess) < kTimeTolerance / 2) {
+      // Newton has converged from one side, step just past the root so the
+      // other end of the bracket closes in too
+      next += high - next > next - low ? kTimeTolerance / 2
+                                       : -kTimeTolerance / 2;
+    }
+    if (!(next > low && next < high)) {
+      next = (low + high) / 2;
+    }
+    guess = next;
+  }
+  return high;
+}
+
+/**
+ * Finds times in (low, high) where the derivative of the polynomial is zero,
+ * splitting the interval into pieces where the polynomial is monotonic.
+ * @return number of critical points written to critical_points in order.
+ */
+int FindCriticalPoints(const double *coefficients, int degree, double low,
+                       double high, double *critical_points) {
+  if (degree < 2) {
+    return 0;
+  }
+  double derivative[kMaxDegree];
+  for (int i = 1; i <= degree; i++) {
+    derivative[i - 1] = i * coefficients[i];
+  }
+  if (degree == 2) {
+    if (derivative[1] == 0) {
+      return 0;
+    }
+    double root = -derivative[0] / derivative[1];
+    if (root > low && root < high) {
+      critical_points[0] = root;
+      return 1;
+    }
+    return 0;
+  }
+  // roots of the derivative lie between its own critical points
+  double pieces[kMaxDegree + 1];
+  int num_pieces = FindCriticalPoints(derivative, degree - 1, low, high,
+                                      pieces + 1);
+  pieces[0] = low;
+  pieces[num_pieces + 1] = high;
+  int num_roots = 0;
+  for (int i = 0; i <= num_pieces; i++) {
+    double start = Evaluate(derivative, degree - 1, pieces[i]);
+    double end = Evaluate(derivative, degree - 1, pieces[i + 1]);
+    if ((start < 0 && end > 0) || (start > 0 && end < 0)) {
+      critical_points[num_roots] =
+          Bisect(derivative, degree - 1, pieces[i], pieces[i + 1]);
+      num_roots += 1;
+    }
+  }
+  return num_roots;
+}
+
+/**
+ * Finds the first time in [start, time_limit] where the polynomial goes from
+ * positive to zero or negative.
+ * @return time of crossing or kNever if it doesn't cross.
+ */
+double FindFirstCrossing(const double *coefficients, int degree, double start,
+                         double time_limit) {
+  if (start >= time_limit) {
+    return kNever;
+  }
+  double pieces[kMaxDegree + 1];
+  int num_critical_points = FindCriticalPoints(coefficients, degree, start,
+                                               time_limit, pieces + 1);
+  pieces[0] = start;
+  pieces[num_critical_points + 1] = time_limit;
+  for (int i = 0; i <= num_critical_points; i++) {
+    if (Evaluate(coefficients, degree, pieces[i]) > 0 &&
+        Evaluate(coefficients, degree, pieces[i + 1]) <= 0) {
+      return Bisect(coefficients, degree, pieces[i], pieces[i + 1]);
+    }
+  }
+  return kNever;
+}
+
+/**
+ * Finds the first time the quadratic c[0] + c[1] t + c[2] t^2 goes from
+ * positive to zero, with c[0] > 0 and c[1] < 0 (a ball closing in on a side
+ * while friction slows it down).
+ * @return time of crossing or kNever if it turns around first.
+ */
+double FindFirstQuadraticCrossing(const double *coefficients) {
+  double discriminant = coefficients[1] * coefficients[1] -
+                        4 * coefficients[2] * coefficients[0];
+  if (discriminant < 0) {
+    return kNever;
+  }
+  // smaller root written so it doesn't lose precision when c[2] is tiny
+  return 2 * coefficients[0] / (-coefficients[1] + std::sqrt(discriminant));
+}
+
+/**
+ * Writes coefficients of one ball's center position on an axis over time,
+ * which is a parabola until that velocity component stops.
+ */
+void AxisMotion(const Ball &ball, size_t axis, double *coefficients) {
+  double velocity = ball.GetVelocity()[axis];
+  double deceleration = 0;
+  if (velocity > 0) {
+    deceleration = -Ball::GetFrictionDeceleration();
+  } else if (velocity < 0) {
+    deceleration = Ball::GetFrictionDeceleration();
+  }
+  coefficients[0] = ball.GetPosition()[axis] + Ball::GetDiameter() / 2;
+  coefficients[1] = velocity;
+  coefficients[2] = deceleration / 2;
+}
+
+/**
+ * Writes coefficients of |offset(t)|^2 - distance^2 where each component of
+ * offset(t) is a quadratic, this is positive while the points are further
+ * apart than distance.
+ */
+void SquaredDistanceMinus(const double offset[2][3], double distance,
+                          double *coefficients) {
+  for (int i = 0; i <= kMaxDegree; i++) {
+    coefficients[i] = 0;
+  }
+  for (size_t axis = 0; axis < 2; axis++) {
+    double a = offset[axis][0];
+    double b = offset[axis][1];
+    double c = offset[axis][2];
+    coefficients[0] += a * a;
+    coefficients[1] += 2 * a * b;
+    coefficients[2] += b * b + 2 * a * c;
+    coefficients[3] += 2 * b * c;
+    coefficients[4] += c * c;
+  }
+  coefficients[0] -= distance * distance;
+}
+
+bool IsMoving(const Ball &ball) {
+  return ball.GetVelocity().x != 0 || ball.GetVelocity().y != 0;
+}
+
+/**
+ * Friction only slows balls down so a ball can't cover more than its current
+ * speed times the time, used to skip solving for far away contacts.
+ */
+double MaxDistanceTravelled(const Ball &ball, double frames) {
+  return (std::abs(ball.GetVelocity().x) + std::abs(ball.GetVelocity().y)) *
+         frames;
+}
+}  // namespace
+
+template <typename Spec>
+BasicEventSimulator<Spec>::BasicEventSimulator() {
+  left_boundary_ = 0;
+  right_boundary_ = 0;
+  top_boundary_ = 0;
+  bottom_boundary_ = 0;
+  hole_radius_ = 0;
+}
+
+template <typename Spec>
+BasicEventSimulator<Spec>::BasicEventSimulator(
+    double left_boundary, double right_boundary, double top_boundary,
+    double bottom_boundary, const HolePositions &hole_positions,
+    double hole_radius) {
+  left_boundary_ = left_boundary;
+  right_boundary_ = right_boundary;
+  top_boundary_ = top_boundary;
+  bottom_boundary_ = bottom_boundary;
+  hole_positions_ = hole_positions;
+  hole_radius_ = hole_radius;
+}
+
+template <typename Spec>
+typename BasicEventSimulator<Spec>::Event
+BasicEventSimulator<Spec>::FindNextEvent(const vector<Ball> &balls,
+                                         double time_limit) const {
+  Event event = {no_event, time_limit, 0, 0};
+  // velocity components stopping change the motion of the balls, so the
+  // motion is only a single parabola up to the first stop
+  for (size_t i = 0; i < balls.size(); i++) {
+    for (size_t axis = 0; axis < 2; axis++) {
+      if (balls[i].GetVelocity()[axis] != 0) {
+        double stop_time = balls[i].GetTimeUntilStopped(axis);
+        if (stop_time < event.time) {
+          event = {came_to_rest, stop_time, i, axis};
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i < balls.size(); i++) {
+    FindPocketEvent(balls, i, event);
+    FindCushionEvent(balls, i, event);
+    for (size_t j = i + 1; j < balls.size(); j++) {
+      FindBallEvent(balls, i, j, event);
+    }
+  }
+  return event;
+}
+
+template <typename Spec>
+void BasicEventSimulator<Spec>::FindCushionEvent(const vector<Ball> &balls,
+                                                 size_t index,
+                                                 Event &event) const {
+  const Ball &ball = balls[index];
+  if (!IsMoving(ball)) {
+    return;
+  }
+  double radius = Ball::GetDiameter() / 2;
+  double low_boundaries[2] = {left_boundary_, top_boundary_};
+  double high_boundaries[2] = {right_boundary_, bottom_boundary_};
+  for (size_t axis = 0; axis < 2; axis++) {
+    double velocity = ball.GetVelocity()[axis];
+    double motion[3];
+    AxisMotion(ball, axis, motion);
+    // distance left before ball edge reaches the side it is moving towards
+    double gap[3];
+    if (velocity < 0) {
+      gap[0] = motion[0] - radius - low_boundaries[axis];
+      gap[1] = motion[1];
+      gap[2] = motion[2];
+    } else if (velocity > 0) {
+      gap[0] = high_boundaries[axis] - (motion[0] + radius);
+      gap[1] = -motion[1];
+      gap[2] = -motion[2];
+    } else {
+      continue;
+    }
+    double time = gap[0] <= 0 ? 0 : FindFirstQuadraticCrossing(gap);
+    if (time < event.time) {
+      event = {cushion_collision, time, index, axis};
+    }
+  }
+}
+
+template <typename Spec>
+void BasicEventSimulator<Spec>::FindPocketEvent(const vector<Ball> &balls,
+                                                size_t index,
+                                                Event &event) const {
+  double offset[2][3];
+  AxisMotion(balls[index], 0, offset[0]);
+  AxisMotion(balls[index], 1, offset[1]);
+  double reach = MaxDistanceTravelled(balls[index], event.time);
+  for (const dvec2 &hole_position : hole_positions_) {
+    dvec2 center = {offset[0][0], offset[1][0]};
+    if (glm::distance(center, hole_position) - hole_radius_ > reach) {
+      continue;
+    }
+    double relative[2][3] = {
+        {offset[0][0] - hole_position.x, offset[0][1], offset[0][2]},
+        {offset[1][0] - hole_position.y, offset[1][1], offset[1][2]}};
+    double coefficients[kMaxDegree + 1];
+    SquaredDistanceMinus(relative, hole_radius_, coefficients);
+    double time = 0;
+    if (coefficients[0] >= 0) {
+      if (!IsMoving(balls[index])) {
+        continue;
+      }
+      time = FindFirstCrossing(coefficients, kMaxDegree, 0, event.time);
+    }
+    if (time < event.time) {
+      event = {pocketed, time, index, 0};
+    }
+  }
+}
+
+template <typename Spec>
+void BasicEventSimulator<Spec>::FindBallEvent(const vector<Ball> &balls,
+                                              size_t first, size_t second,
+                                              Event &event) const {
+  if (!IsMoving(balls[first]) && !IsMoving(balls[second])) {
+    return;
+  }
+  double reach = MaxDistanceTravelled(balls[first], event.time) +
+                 MaxDistanceTravelled(balls[second], event.time) +
+                 Ball::GetDiameter();
+  dvec2 difference = balls[first].GetPosition() - balls[second].GetPosition();
+  if (glm::dot(difference, difference) > reach * reach) {
+    return;
+  }
+  double offset[2][3];
+  for (size_t axis = 0; axis < 2; axis++) {
+    double first_motion[3];
+    double second_motion[3];
+    AxisMotion(balls[first], axis, first_motion);
+    AxisMotion(balls[second], axis, second_motion);
+    for (size_t i = 0; i < 3; i++) {
+      offset[axis][i] = first_motion[i] - second_motion[i];
+    }
+  }
+  double coefficients[kMaxDegree + 1];
+  SquaredDistanceMinus(offset, Ball::GetDiameter() - kContactTolerance,
+                       coefficients);
+  double time = 0;
+  if (coefficients[0] > 0) {
+    time = FindFirstCrossing(coefficients, kMaxDegree, 0, event.time);
+  }
+  if (time >= event.time) {
+    return;
+  }
+  // half the derivative of the squared distance is the separating speed,
+  // this is positive while not pushing into each other faster than the
+  // tolerance
+  double pushing[kMaxDegree];
+  for (int i = 0; i < kMaxDegree; i++) {
+    pushing[i] = (i + 1) * coefficients[i + 1] / 2;
+  }
+  pushing[0] += kApproachTolerance;
+  if (Evaluate(pushing, kMaxDegree - 1, time) > 0) {
+    // touching without really pushing, like balls rolling along each other.
+    // Resolving that would give the same event again straight away, so wait
+    // until they push harder while still touching or touch again after
+    // moving apart
+    double touch_again_time =
+        FindFirstCrossing(coefficients, kMaxDegree, time, event.time);
+    double push_limit = std::min(touch_again_time, event.time);
+    double push_time =
+        FindFirstCrossing(pushing, kMaxDegree - 1, time, push_limit);
+    if (push_time < touch_again_time &&
+        Evaluate(coefficients, kMaxDegree, push_time) <= 0) {
+      time = push_time;
+    } else {
+      time = touch_again_time;
+    }
+  }
+  if (time < event.time) {
+    event = {ball_collision, time, first, second};
+  }
+}
+
+template <typename Spec>
+void BasicEventSimulator<Spec>::AdvanceBalls(vector<Ball> &balls,
+                                             double frames) {
+  if (frames <= 0) {
+    return;
+  }
+  for (size_t i = 0; i < balls.size(); i++) {
+    balls[i].MoveFor(frames);
+  }
+}
+
+template <typename Spec>
+void BasicEventSimulator<Spec>::ResolveEvent(vector<Ball> &balls,
+                                             const Event &event) {
+  if (event.type == ball_collision) {
+    Ball::HandlePoolBallsColliding(balls[event.first], balls[event.second]);
+  } else if (event.type == cushion_collision) {
+    dvec2 velocity = balls[event.first].GetVelocity();
+    velocity[event.second] *= -1;
+    balls[event.first].SetVelocity(velocity);
+  } else if (event.type == came_to_rest) {
+    dvec2 velocity = balls[event.first].GetVelocity();
+    velocity[event.second] = 0;
+    balls[event.first].SetVelocity(velocity);
+  }
+}
+
+template class BasicEventSimulator<ClassicTable>;
+template class BasicEventSimulator<SevenFootTable>;
+template class BasicEventSimulator<EightFootTable>;
+template class BasicEventSimulator<NineFootTable>;
+template class BasicEventSimulator<SnookerTable>;
+template class BasicEventSimulator<CaromTable>;
+}  // namespace pool
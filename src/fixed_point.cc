@@ -0,0 +1,158 @@
+#include "fixed_point.h"
+
+#include <cmath>
+namespace pool {
+constexpr int const Fixed::kFractionBits;
+constexpr int64_t const Fixed::kOne;
+constexpr int64_t const Fixed::kPiRaw;
+const Fixed FixedBall::kDiameter = Fixed::FromDouble(Ball::GetDiameter());
+const Fixed FixedBall::kRadius = Fixed::FromDouble(Ball::GetDiameter() / 2);
+const Fixed FixedBall::kFrictionDeceleration =
+    Fixed::FromDouble(Ball::GetFrictionDeceleration());
+
+Fixed Fixed::FromDouble(double value) {
+  // scaling by a power of two is exact, so only llround rounds
+  return FromRaw(std::llround(value * (double)kOne));
+}
+
+Fixed Fixed::Sin(Fixed angle) {
+  // bring the angle into [-pi, pi] so the series converges quickly
+  int64_t two_pi = 2 * kPiRaw;
+  int64_t reduced = angle.raw_ % two_pi;
+  if (reduced > kPiRaw) {
+    reduced -= two_pi;
+  } else if (reduced < -kPiRaw) {
+    reduced += two_pi;
+  }
+  // x - x^3/3! + x^5/5! - ..., each term made from the one before so the
+  // terms stay small, stops once a term rounds to zero
+  Fixed x = FromRaw(reduced);
+  Fixed square = x * x;
+  Fixed term = x;
+  Fixed sum = x;
+  for (int64_t n = 1; term != Fixed() && n < 20; n++) {
+    term = -(term * square / FromRaw((2 * n) * (2 * n + 1) * kOne));
+    sum += term;
+  }
+  return sum;
+}
+
+Fixed Fixed::Cos(Fixed angle) {
+  return Sin(angle + FromRaw(kPiRaw / 2));
+}
+
+FixedBall::FixedBall() {
+}
+
+FixedBall::FixedBall(const Ball &ball) {
+  position_ = FixedVec2::FromDouble(ball.GetPosition());
+  velocity_ = FixedVec2::FromDouble(ball.GetVelocity());
+}
+
+void FixedBall::Store(Ball &ball) const {
+  ball.SetPosition(position_.ToDouble());
+  ball.SetVelocity(velocity_.ToDouble());
+}
+
+bool FixedBall::HandleBoardCollision(Fixed right_boundary,
+                                     Fixed left_boundary, Fixed top_boundary,
+                                     Fixed bottom_boundary) {
+  if (position_.x <= left_boundary ||
+      position_.x + kDiameter >= right_boundary) {
+    velocity_.x = -velocity_.x;
+    return true;
+  } else if (position_.y + kDiameter >= bottom_boundary ||
+             position_.y <= top_boundary) {
+    velocity_.y = -velocity_.y;
+    return true;
+  }
+  return false;
+}
+
+void FixedBall::DecreaseVelocity() {
+  Fixed *components[2] = {&velocity_.x, &velocity_.y};
+  for (Fixed *component : components) {
+    if (*component > kFrictionDeceleration) {
+      *component -= kFrictionDeceleration;
+    } else if (*component < -kFrictionDeceleration) {
+      *component += kFrictionDeceleration;
+    } else {
+      // prevents lingering velocity
+      *component = Fixed();
+    }
+  }
+}
+
+bool FixedBall::HandlePoolBallsColliding(FixedBall &ball_one,
+                                         FixedBall &ball_two) {
+  // top left corners are the same offset from the centers
+  Fixed dx = ball_one.position_.x - ball_two.position_.x;
+  Fixed dy = ball_one.position_.y - ball_two.position_.y;
+  Fixed dvx = ball_one.velocity_.x - ball_two.velocity_.x;
+  Fixed dvy = ball_one.velocity_.y - ball_two.velocity_.y;
+  if (!IsWithin(dx, dy, kDiameter)) {
+    return false;
+  }
+  Fixed dot = dx * dvx + dy * dvy;
+  // if balls are not moving towards each other
+  if (dot >= Fixed()) {
+    return false;
+  }
+  // centers less than about 2^-10 apart square to zero steps, there is no
+  // direction to push the balls apart in and dividing would trap
+  Fixed squared_length = dx * dx + dy * dy;
+  if (squared_length == Fixed()) {
+    return false;
+  }
+  // both balls change by the projection of the relative velocity onto the
+  // line between centers, with the same rounding so momentum is kept
+  Fixed dot_over_length = dot / squared_length;
+  Fixed change_x = dot_over_length * dx;
+  Fixed change_y = dot_over_length * dy;
+  ball_one.velocity_.x -= change_x;
+  ball_one.velocity_.y -= change_y;
+  ball_two.velocity_.x += change_x;
+  ball_two.velocity_.y += change_y;
+  return true;
+}
+
+void FixedBall::Move() {
+  position_.x += velocity_.x;
+  position_.y += velocity_.y;
+}
+
+void FixedBall::StickHit(Fixed angle, Fixed velocity_boost) {
+  velocity_.x -= velocity_boost * Fixed::Cos(angle);
+  velocity_.y -= velocity_boost * Fixed::Sin(angle);
+}
+
+bool FixedBall::IsCenterWithin(const FixedVec2 &point, Fixed radius) const {
+  Fixed dx = position_.x + kRadius - point.x;
+  Fixed dy = position_.y + kRadius - point.y;
+  if (dx >= radius || -dx >= radius || dy >= radius || -dy >= radius) {
+    return false;
+  }
+  return dx * dx + dy * dy < radius * radius;
+}
+
+bool FixedBall::AreWithin(const FixedBall &ball_one,
+                          const FixedBall &ball_two, Fixed distance) {
+  return IsWithin(ball_one.position_.x - ball_two.position_.x,
+                  ball_one.position_.y - ball_two.position_.y, distance);
+}
+
+const FixedVec2 &FixedBall::GetVelocity() const {
+  return velocity_;
+}
+
+bool FixedBall::IsMoving() const {
+  return velocity_.x != Fixed() || velocity_.y != Fixed();
+}
+
+bool FixedBall::IsWithin(Fixed dx, Fixed dy, Fixed distance) {
+  if (dx > distance || -dx > distance || dy > distance || -dy > distance) {
+    return false;
+  }
+  return dx * dx + dy * dy <= distance * distance;
+}
+}  // namespace pool
@@ -0,0 +1,55 @@
+#include "fixed_timestep.h"
+
+#include "ball.h"
+namespace pool {
+FixedTimestep::FixedTimestep() {
+  step_seconds_ = Ball::kSecondsPerFrame;
+  max_steps_per_update_ = kDefaultMaxStepsPerUpdate;
+}
+
+FixedTimestep::FixedTimestep(double steps_per_second,
+                             size_t max_steps_per_update) {
+  step_seconds_ = 1.0 / steps_per_second;
+  max_steps_per_update_ = max_steps_per_update;
+}
+
+size_t FixedTimestep::Update(double elapsed_seconds) {
+  if (elapsed_seconds > 0) {
+    accumulator_ += elapsed_seconds;
+  }
+  size_t num_steps = 0;
+  while (accumulator_ >= step_seconds_ && num_steps < max_steps_per_update_) {
+    accumulator_ -= step_seconds_;
+    num_steps += 1;
+  }
+  // more time than the cap allows, drop whole steps but keep the fraction so
+  // interpolation doesn't jump
+  if (accumulator_ >= step_seconds_) {
+    double whole_steps = (double)(size_t)(accumulator_ / step_seconds_);
+    dropped_seconds_ += whole_steps * step_seconds_;
+    accumulator_ -= whole_steps * step_seconds_;
+  }
+  return num_steps;
+}
+
+double FixedTimestep::GetInterpolationFactor() const {
+  return accumulator_ / step_seconds_;
+}
+
+double FixedTimestep::GetStepSeconds() const {
+  return step_seconds_;
+}
+
+size_t FixedTimestep::GetMaxStepsPerUpdate() const {
+  return max_steps_per_update_;
+}
+
+double FixedTimestep::GetDroppedSeconds() const {
+  return dropped_seconds_;
+}
+
+void FixedTimestep::Reset() {
+  accumulator_ = 0;
+  dropped_seconds_ = 0;
+}
+}  // namespace pool
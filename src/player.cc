@@ -9,17 +9,6 @@ Player::Player() {
   state_ = playing;
 }
 
-void Player::DisplayBalls(vector<ci::gl::Texture2dRef> images) const {
-  dvec2 position = {kSpaceBetweenBalls, kSpaceBetweenBalls};
-  for (size_t i = 0; i < ball_numbers_scored_.size(); i++) {
-    ci::gl::color(ci::ColorA("white", 1));
-    ci::gl::draw(images[ball_numbers_scored_[i]],
-                 ci::Rectf(position, {position.x + 2 * Ball::GetDiameter(),
-                                      position.y + 2 * Ball::GetDiameter()}));
-    position.x += kSpaceBetweenBalls;
-  }
-}
-
 void Player::AddBallScore() {
   num_balls_scored_ += 1;
 }
@@ -28,7 +17,7 @@ void Player::AddBallNumberScored(size_t ball_number) {
   ball_numbers_scored_.push_back(ball_number);
 }
 
-vector<size_t> Player::GetBallNumbers() const {
+const vector<size_t> &Player::GetBallNumbers() const {
   return ball_numbers_scored_;
 }
 
@@ -40,6 +29,10 @@ size_t Player::GetPlayerScore() const {
   return num_balls_scored_;
 }
 
+void Player::SetPlayerScore(size_t score) {
+  num_balls_scored_ = score;
+}
+
 void Player::SetBallTypeToScore(Ball::Type type) {
   type_ = type;
 }
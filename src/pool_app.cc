@@ -2,74 +2,156 @@
 // Created by neha konjeti on 4/16/21.
 //
 #include "pool_app.h"
+
+#include <fstream>
 namespace pool {
 
-PoolApp::PoolApp() : board_(kWindowSize) {
+PoolApp::PoolApp()
+    : images_([](const string &path) {
+        return ci::Surface::create(cinder::loadImage(path));
+      }),
+      replay_writer_(kReplayPathPrefix),
+      simulation_(Board(kWindowSize),
+                  FixedTimestep(kPhysicsStepsPerSecond,
+                                kMaxPhysicsStepsPerUpdate)),
+      computer_(ComputerPlayer::medium) {
   ci::app::setWindowSize(kWindowSize, kWindowSize);
+  simulation_.SetReplayWriter(&replay_writer_);
+  replay_writer_.Start();
+  // decoding only needs the files, uploading waits for setup
+  images_.Preload(kBallImagePaths);
 }
 
 void PoolApp::setup() {
+  vector<ci::SurfaceRef> images;
   for (size_t i = 0; i < kBallImagePaths.size(); i++) {
-    ci::gl::Texture2dRef texture =
-        ci::gl::Texture2d::create(cinder::loadImage(kBallImagePaths[i]));
-    images_.push_back(texture);
+    images.push_back(images_.Get(kBallImagePaths[i]));
+  }
+  renderer_.LoadBallImages(images);
+  // a replay can only be loaded before the simulation thread starts
+  const vector<string> &args = getCommandLineArgs();
+  Replay replay;
+  std::ifstream file;
+  if (args.size() > 1) {
+    file.open(args[1], std::ios::binary);
+  }
+  if (!file.is_open() || !replay.Read(file) ||
+      !simulation_.LoadReplay(replay)) {
+    SendCommand({SimulationThread::reset, dvec2(0, 0), 0, 0});
   }
-  board_.CreatePoolBalls();
+  simulation_.Start();
 }
 
 void PoolApp::draw() {
-  ci::Color background_color("white");
-  ci::gl::clear(background_color);
-  board_.Display(images_);
-  // message displayed over board
-  if (board_.GetPlayerState() == Player::lost) {
-    board_.DisplayLosingMessage();
-  } else if (board_.GetPlayerState() == Player::won) {
-    board_.DisplayWinningMessage();
+  {
+    POOL_PROFILE_SCOPE("draw/frame");
+    SendUnsentCommands();
+    const SimulationThread::Snapshot &snapshot =
+        simulation_.GetLatestSnapshot();
+    const Board &board = snapshot.board;
+    if (computer_shot_.valid() &&
+        computer_shot_.wait_for(std::chrono::seconds(0)) ==
+            std::future_status::ready) {
+      ComputerPlayer::Shot shot = computer_shot_.get();
+      SendCommand({SimulationThread::shoot, dvec2(0, 0), shot.angle,
+                   shot.power});
+    }
+    ci::Color background_color("white");
+    ci::gl::clear(background_color);
+    renderer_.Display(board, simulation_.GetInterpolationFactor(snapshot));
+    // message displayed over board
+    POOL_PROFILE_SCOPE("draw/text");
+    if (board.GetPlayerState() == Player::lost) {
+      renderer_.DisplayLosingMessage(board);
+    } else if (board.GetPlayerState() == Player::won) {
+      renderer_.DisplayWinningMessage(board);
+    }
+  }
+  Profiler &profiler = Profiler::GetInstance();
+  profiler.EndFrame();
+  if (profiler.IsEnabled()) {
+    // drawing the overlay is counted in the next frame
+    renderer_.DisplayProfiler(profiler.GetStats());
   }
 }
 
 void PoolApp::mouseDrag(ci::app::MouseEvent event) {
-  if (board_.GetPlayerState() == Player::playing) {
-    if (board_.IsCueInHole()) {
-      board_.SetCueBallPosition(event.getPos());
-    }
-  }
+  const Board &board = simulation_.GetLatestSnapshot().board;
+  // simulation thread ignores it unless the cue ball is in a hole
+  SendCommand({SimulationThread::set_cue_position,
+               BoardRenderer::ToBoardPosition(board, event.getPos()), 0, 0});
 }
 
 void PoolApp::mouseUp(ci::app::MouseEvent event) {
-  if (board_.GetPlayerState() == Player::playing) {
-    if (board_.IsCueInHole()) {
-      board_.RepositionCueBall({static_cast<double>(event.getPos().x),
-                                static_cast<double>(event.getPos().y)});
-    }
-  }
+  const Board &board = simulation_.GetLatestSnapshot().board;
+  SendCommand({SimulationThread::reposition_cue,
+               BoardRenderer::ToBoardPosition(board, event.getPos()), 0, 0});
 }
 
 void PoolApp::keyDown(ci::app::KeyEvent event) {
-  if (board_.GetPlayerState() == Player::playing) {
+  const Board &board = simulation_.GetLatestSnapshot().board;
+  if (event.getCode() == ci::app::KeyEvent::KEY_r) {
+    SendCommand({SimulationThread::replay, dvec2(0, 0), 0, 0});
+    return;
+  }
+  Profiler &profiler = Profiler::GetInstance();
+  if (event.getCode() == ci::app::KeyEvent::KEY_p) {
+    // numbers start over each time profiling is turned on
+    if (!profiler.IsEnabled()) {
+      profiler.Clear();
+    }
+    profiler.SetEnabled(!profiler.IsEnabled());
+    return;
+  }
+  if (event.getCode() == ci::app::KeyEvent::KEY_t && profiler.IsEnabled()) {
+    std::ofstream trace(kTracePath);
+    profiler.WriteChromeTrace(trace);
+    return;
+  }
+  if (board.GetPlayerState() == Player::playing) {
     if (event.getCode() == ci::app::KeyEvent::KEY_RIGHT) {
-      board_.UpdateStickRight();
+      SendCommand({SimulationThread::rotate_right, dvec2(0, 0), 0, 0});
     } else if (event.getCode() == ci::app::KeyEvent::KEY_LEFT) {
-      board_.UpdateStickLeft();
+      SendCommand({SimulationThread::rotate_left, dvec2(0, 0), 0, 0});
     } else if (event.getCode() == ci::app::KeyEvent::KEY_UP) {
-      board_.HitCueBall();
+      SendCommand({SimulationThread::hit, dvec2(0, 0), 0, 0});
     } else if (event.getCode() == ci::app::KeyEvent::KEY_DOWN) {
-      board_.PullStickBackForShot();
+      SendCommand({SimulationThread::pull_back, dvec2(0, 0), 0, 0});
+    } else if (event.getCode() == ci::app::KeyEvent::KEY_c &&
+               !computer_shot_.valid() && board.GetStickVisibility() &&
+               !board.IsCueInHole()) {
+      // search on a copy so the simulation and drawing keep going
+      computer_shot_ = std::async(std::launch::async,
+                                  &ComputerPlayer::ChooseShot, &computer_,
+                                  board);
     }
   } else {  // to restart game when player loses or wins
     if (event.getCode() == ci::app::KeyEvent::KEY_SPACE) {
-      // reset board
-      board_.ResetBoard();
-      setup();
+      // images and textures are kept, only the board starts over
+      SendCommand({SimulationThread::reset, dvec2(0, 0), 0, 0});
     }
   }
 }
 
-void PoolApp::update() {
-  if (board_.GetPlayerState() == Player::playing) {
-    board_.AdvanceOneFrame();
-  }
+void PoolApp::SendCommand(const SimulationThread::Command &command) {
+  // commands already waiting go first so input keeps its order
+  unsent_commands_.push_back(command);
+  SendUnsentCommands();
 }
 
+void PoolApp::SendUnsentCommands() {
+  size_t num_sent = 0;
+  for (const SimulationThread::Command &command : unsent_commands_) {
+    bool sent = command.type == SimulationThread::shoot
+                    ? simulation_.SendShot(command.angle, command.power)
+                    : simulation_.Send(command.type, command.position);
+    if (!sent) {
+      // queue is full, the rest are tried again next frame
+      break;
+    }
+    num_sent += 1;
+  }
+  unsent_commands_.erase(unsent_commands_.begin(),
+                         unsent_commands_.begin() + num_sent);
+}
 }  // namespace pool
@@ -0,0 +1,179 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+namespace pool {
+constexpr const size_t Profiler::kHistoryFrames;
+constexpr const size_t Profiler::kMaxTraceEvents;
+
+namespace {
+// ScopedProfilerPauses the calling thread is in
+thread_local size_t num_thread_pauses = 0;
+
+/**
+ * Small number for the calling thread, in the order threads first record.
+ */
+uint32_t GetThreadNumber() {
+  static std::atomic<uint32_t> next_thread_number(1);
+  thread_local uint32_t thread_number = next_thread_number++;
+  return thread_number;
+}
+
+/**
+ * Writes a name as a JSON string.
+ */
+void WriteJsonString(std::ostream &output, const char *text) {
+  output << '"';
+  for (const char *character = text; *character != '\0'; character++) {
+    if (*character == '"' || *character == '\\') {
+      output << '\\';
+    }
+    output << *character;
+  }
+  output << '"';
+}
+}  // namespace
+
+Profiler::Profiler()
+    : enabled_(false),
+      epoch_ns_(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count()) {
+}
+
+Profiler &Profiler::GetInstance() {
+  static Profiler profiler;
+  return profiler;
+}
+
+void Profiler::SetEnabled(bool enabled) {
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+bool Profiler::IsThreadPaused() {
+  return num_thread_pauses > 0;
+}
+
+uint64_t Profiler::GetNanoseconds() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+             .count() -
+         epoch_ns_;
+}
+
+void Profiler::RecordScope(const char *name, uint64_t start_ns,
+                           uint64_t end_ns) {
+  if (!IsRecording()) {
+    return;
+  }
+  TraceEvent event = {name, false, GetThreadNumber(), start_ns,
+                      end_ns - start_ns, 0};
+  std::lock_guard<std::mutex> lock(mutex_);
+  series_[name].current += (end_ns - start_ns) * 1e-6;
+  AddTraceEvent(event);
+}
+
+void Profiler::AddCountRecording(const char *name, double value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Series &series = series_[name];
+  series.is_counter = true;
+  series.current += value;
+}
+
+void Profiler::EndFrame() {
+  if (!IsEnabled()) {
+    return;
+  }
+  uint64_t now_ns = GetNanoseconds();
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &named_series : series_) {
+    Series &series = named_series.second;
+    series.history[num_frames_ % kHistoryFrames] = series.current;
+    if (series.is_counter) {
+      AddTraceEvent({named_series.first, true, 0, now_ns, 0, series.current});
+    }
+    series.current = 0;
+  }
+  num_frames_ += 1;
+}
+
+vector<Profiler::Stats> Profiler::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  vector<Stats> stats;
+  size_t num_frames = std::min(num_frames_, kHistoryFrames);
+  // scopes then counters, the map already sorts each by name
+  for (bool counters : {false, true}) {
+    for (const auto &named_series : series_) {
+      const Series &series = named_series.second;
+      if (series.is_counter != counters) {
+        continue;
+      }
+      Stats scope_stats = {named_series.first, series.is_counter, 0, 0, 0};
+      if (num_frames > 0) {
+        scope_stats.last =
+            series.history[(num_frames_ - 1) % kHistoryFrames];
+        double total = 0;
+        for (size_t i = 0; i < num_frames; i++) {
+          total += series.history[i];
+          scope_stats.worst = std::max(scope_stats.worst, series.history[i]);
+        }
+        scope_stats.average = total / num_frames;
+      }
+      stats.push_back(scope_stats);
+    }
+  }
+  return stats;
+}
+
+void Profiler::WriteChromeTrace(std::ostream &output) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  output << "{\"traceEvents\":[";
+  // oldest first, which is next_trace_event_ once the buffer has wrapped
+  size_t first = trace_.size() < kMaxTraceEvents ? 0 : next_trace_event_;
+  for (size_t i = 0; i < trace_.size(); i++) {
+    const TraceEvent &event = trace_[(first + i) % trace_.size()];
+    output << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+    WriteJsonString(output, event.name);
+    // trace times are in microseconds, written with fixed decimals so long
+    // traces keep nanosecond precision
+    char numbers[96];
+    if (event.is_counter) {
+      std::snprintf(numbers, sizeof(numbers),
+                    ",\"ph\":\"C\",\"ts\":%.3f,\"args\":{\"value\":%.17g}",
+                    event.start_ns / 1000.0, event.value);
+    } else {
+      std::snprintf(numbers, sizeof(numbers),
+                    ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f",
+                    event.start_ns / 1000.0, event.duration_ns / 1000.0);
+    }
+    output << ",\"pid\":1,\"tid\":" << event.thread << numbers << "}";
+  }
+  output << "\n]}\n";
+}
+
+void Profiler::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  series_.clear();
+  num_frames_ = 0;
+  trace_.clear();
+  next_trace_event_ = 0;
+}
+
+void Profiler::AddTraceEvent(const TraceEvent &event) {
+  if (trace_.size() < kMaxTraceEvents) {
+    trace_.push_back(event);
+  } else {
+    trace_[next_trace_event_] = event;
+  }
+  next_trace_event_ = (next_trace_event_ + 1) % kMaxTraceEvents;
+}
+
+ScopedProfilerPause::ScopedProfilerPause() {
+  num_thread_pauses += 1;
+}
+
+ScopedProfilerPause::~ScopedProfilerPause() {
+  num_thread_pauses -= 1;
+}
+}  // namespace pool
@@ -0,0 +1,513 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <cstring>
+namespace pool {
+
+namespace {
+char const kMagic[4] = {'P', 'R', 'E', 'P'};
+// 2 added keyframes, 3 the fixed_point simulation mode
+uint8_t const kVersion = 3;
+// record type of keyframes, after the input types
+uint8_t const kKeyframeRecord = 3;
+
+/**
+ * Checks if a value can be written in a number of bytes.
+ */
+bool Fits(uint64_t value, size_t num_bytes) {
+  return num_bytes >= 8 || value >> (8 * num_bytes) == 0;
+}
+
+void WriteUnsigned(std::ostream &output, uint64_t value, size_t num_bytes) {
+  char bytes[8];
+  for (size_t i = 0; i < num_bytes; i++) {
+    bytes[i] = (char)((value >> (8 * i)) & 0xff);
+  }
+  output.write(bytes, num_bytes);
+}
+
+void WriteDouble(std::ostream &output, double value) {
+  // bits are copied as they are so values read back are exactly the same
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  WriteUnsigned(output, bits, sizeof(bits));
+}
+
+bool ReadUnsigned(std::istream &input, uint64_t &value, size_t num_bytes) {
+  unsigned char bytes[8];
+  if (!input.read((char *)bytes, num_bytes)) {
+    return false;
+  }
+  value = 0;
+  for (size_t i = 0; i < num_bytes; i++) {
+    value |= (uint64_t)bytes[i] << (8 * i);
+  }
+  return true;
+}
+
+bool ReadDouble(std::istream &input, double &value) {
+  uint64_t bits;
+  if (!ReadUnsigned(input, bits, sizeof(bits))) {
+    return false;
+  }
+  std::memcpy(&value, &bits, sizeof(value));
+  return true;
+}
+
+/**
+ * Checks if a count and each of the ball numbers fit in a byte.
+ */
+bool BallNumbersFit(const size_t *numbers, size_t count) {
+  if (!Fits(count, 1)) {
+    return false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (!Fits(numbers[i], 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void WriteBallNumbers(std::ostream &output, const size_t *numbers,
+                      size_t count) {
+  WriteUnsigned(output, count, 1);
+  for (size_t i = 0; i < count; i++) {
+    WriteUnsigned(output, numbers[i], 1);
+  }
+}
+
+bool ReadBallNumbers(std::istream &input, size_t *numbers, size_t &count) {
+  uint64_t value;
+  if (!ReadUnsigned(input, value, 1) || value > BoardState::kMaxBalls) {
+    return false;
+  }
+  count = (size_t)value;
+  for (size_t i = 0; i < count; i++) {
+    if (!ReadUnsigned(input, value, 1)) {
+      return false;
+    }
+    numbers[i] = (size_t)value;
+  }
+  return true;
+}
+
+/**
+ * Reads the part of a keyframe record after its type and step.
+ * @return false if the record is cut short, leaving the stream failed, or
+ * has a value out of range.
+ */
+bool ReadKeyframeState(std::istream &input, BoardState &state) {
+  uint64_t value;
+  if (!ReadUnsigned(input, value, 1) || value > BoardState::kMaxBalls) {
+    return false;
+  }
+  state.num_balls = (size_t)value;
+  for (size_t i = 0; i < state.num_balls; i++) {
+    uint64_t number;
+    uint64_t type;
+    dvec2 position;
+    dvec2 velocity;
+    double velocity_boost;
+    if (!ReadUnsigned(input, number, 1) || !ReadUnsigned(input, type, 1) ||
+        type > Ball::eight || !ReadDouble(input, position.x) ||
+        !ReadDouble(input, position.y) || !ReadDouble(input, velocity.x) ||
+        !ReadDouble(input, velocity.y) || !ReadDouble(input, velocity_boost)) {
+      return false;
+    }
+    state.balls[i] = Ball((size_t)number, (Ball::Type)type, position, velocity);
+    state.balls[i].SetVelocityBoost(velocity_boost);
+  }
+  uint64_t score;
+  uint64_t type_to_score;
+  uint64_t game_state;
+  uint64_t stick_visible;
+  uint64_t cue_in_hole;
+  if (!ReadBallNumbers(input, state.ball_numbers_scored,
+                       state.num_ball_numbers_scored) ||
+      !ReadUnsigned(input, score, 4) ||
+      !ReadUnsigned(input, type_to_score, 1) || type_to_score > Ball::eight ||
+      !ReadUnsigned(input, game_state, 1) || game_state > Player::playing ||
+      !ReadBallNumbers(input, state.pocketed_this_shot,
+                       state.num_pocketed_this_shot) ||
+      !ReadUnsigned(input, stick_visible, 1) ||
+      !ReadUnsigned(input, cue_in_hole, 1) ||
+      !ReadDouble(input, state.frame_remainder)) {
+    return false;
+  }
+  state.player_score = (size_t)score;
+  state.ball_type_to_score = (Ball::Type)type_to_score;
+  state.game_state = (Player::GameState)game_state;
+  state.stick_visible = stick_visible != 0;
+  state.cue_in_hole = cue_in_hole != 0;
+  return true;
+}
+}  // namespace
+
+template <typename Spec>
+constexpr const uint64_t BasicReplay<Spec>::kDefaultKeyframeInterval;
+
+template <typename Spec>
+BasicReplay<Spec>::BasicReplay()
+    : simulation_mode_(Board::frame_stepping), frames_per_step_(1) {
+}
+
+template <typename Spec>
+BasicReplay<Spec>::BasicReplay(const Board &board, double frames_per_step)
+    : initial_balls_(board.GetPoolBalls()),
+      simulation_mode_(board.GetSimulationMode()),
+      frames_per_step_(frames_per_step) {
+}
+
+template <typename Spec>
+void BasicReplay<Spec>::AddInput(const Input &input) {
+  inputs_.push_back(input);
+}
+
+template <typename Spec>
+void BasicReplay<Spec>::AddKeyframe(const Keyframe &keyframe) {
+  keyframes_.push_back(keyframe);
+}
+
+template <typename Spec>
+void BasicReplay<Spec>::Reserve(size_t num_inputs, size_t num_keyframes) {
+  inputs_.reserve(num_inputs);
+  keyframes_.reserve(num_keyframes);
+}
+
+template <typename Spec>
+const vector<Ball> &BasicReplay<Spec>::GetInitialBalls() const {
+  return initial_balls_;
+}
+
+template <typename Spec>
+const vector<typename BasicReplay<Spec>::Input> &BasicReplay<Spec>::GetInputs()
+    const {
+  return inputs_;
+}
+
+template <typename Spec>
+const vector<typename BasicReplay<Spec>::Keyframe> &
+BasicReplay<Spec>::GetKeyframes() const {
+  return keyframes_;
+}
+
+template <typename Spec>
+typename BasicBoard<Spec>::SimulationMode
+BasicReplay<Spec>::GetSimulationMode() const {
+  return simulation_mode_;
+}
+
+template <typename Spec>
+double BasicReplay<Spec>::GetFramesPerStep() const {
+  return frames_per_step_;
+}
+
+template <typename Spec>
+bool BasicReplay<Spec>::Write(std::ostream &output) const {
+  if (!WriteHeader(output, simulation_mode_, frames_per_step_,
+                   initial_balls_)) {
+    return false;
+  }
+  uint64_t previous_step = 0;
+  size_t next_keyframe = 0;
+  for (const Input &input : inputs_) {
+    // a keyframe comes before the inputs of its step
+    while (next_keyframe < keyframes_.size() &&
+           keyframes_[next_keyframe].step <= input.step) {
+      if (!WriteKeyframe(output, keyframes_[next_keyframe], previous_step)) {
+        return false;
+      }
+      previous_step = keyframes_[next_keyframe].step;
+      next_keyframe += 1;
+    }
+    if (!WriteInput(output, input, previous_step)) {
+      return false;
+    }
+    previous_step = input.step;
+  }
+  for (; next_keyframe < keyframes_.size(); next_keyframe++) {
+    if (!WriteKeyframe(output, keyframes_[next_keyframe], previous_step)) {
+      return false;
+    }
+    previous_step = keyframes_[next_keyframe].step;
+  }
+  return true;
+}
+
+template <typename Spec>
+bool BasicReplay<Spec>::Read(std::istream &input) {
+  char magic[4];
+  uint64_t version;
+  uint64_t mode;
+  uint64_t num_balls;
+  if (!input.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kMagic, sizeof(magic)) != 0 ||
+      !ReadUnsigned(input, version, 1) || version < 1 || version > kVersion ||
+      !ReadUnsigned(input, mode, 1) || mode > Board::fixed_point ||
+      !ReadDouble(input, frames_per_step_) ||
+      !ReadUnsigned(input, num_balls, 1)) {
+    return false;
+  }
+  simulation_mode_ = (typename Board::SimulationMode)mode;
+  initial_balls_.clear();
+  for (size_t i = 0; i < num_balls; i++) {
+    uint64_t number;
+    uint64_t type;
+    dvec2 position;
+    if (!ReadUnsigned(input, number, 1) || !ReadUnsigned(input, type, 1) ||
+        type > Ball::eight || !ReadDouble(input, position.x) ||
+        !ReadDouble(input, position.y)) {
+      return false;
+    }
+    initial_balls_.push_back(
+        Ball((size_t)number, (Ball::Type)type, position, {0, 0}));
+  }
+  inputs_.clear();
+  keyframes_.clear();
+  uint64_t step = 0;
+  while (true) {
+    Input replay_input;
+    uint64_t type;
+    uint64_t steps_since_last;
+    if (!ReadUnsigned(input, type, 1) ||
+        !ReadUnsigned(input, steps_since_last, 4)) {
+      // end of file, or a record cut short which is dropped
+      return true;
+    }
+    if (type > kKeyframeRecord) {
+      return false;
+    }
+    step += steps_since_last;
+    if (type == kKeyframeRecord) {
+      Keyframe keyframe;
+      keyframe.step = step;
+      if (!ReadKeyframeState(input, keyframe.state)) {
+        // a keyframe cut short is dropped, one with bad values isn't a
+        // replay this can read
+        return !input;
+      }
+      keyframes_.push_back(keyframe);
+      continue;
+    }
+    double values[2];
+    if (!ReadDouble(input, values[0]) || !ReadDouble(input, values[1])) {
+      return true;
+    }
+    replay_input.type = (InputType)type;
+    replay_input.step = step;
+    replay_input.angle = 0;
+    replay_input.power = 0;
+    replay_input.position = dvec2(0, 0);
+    if (replay_input.type == shot) {
+      replay_input.angle = values[0];
+      replay_input.power = values[1];
+    } else {
+      replay_input.position = dvec2(values[0], values[1]);
+    }
+    inputs_.push_back(replay_input);
+  }
+}
+
+template <typename Spec>
+bool BasicReplay<Spec>::WriteHeader(std::ostream &output,
+                                    typename Board::SimulationMode mode,
+                                    double frames_per_step,
+                                    const vector<Ball> &balls) {
+  if (!Fits(balls.size(), 1)) {
+    return false;
+  }
+  for (const Ball &ball : balls) {
+    if (!Fits(ball.GetBallNumber(), 1)) {
+      return false;
+    }
+  }
+  output.write(kMagic, sizeof(kMagic));
+  WriteUnsigned(output, kVersion, 1);
+  WriteUnsigned(output, (uint64_t)mode, 1);
+  WriteDouble(output, frames_per_step);
+  WriteUnsigned(output, balls.size(), 1);
+  for (const Ball &ball : balls) {
+    WriteUnsigned(output, ball.GetBallNumber(), 1);
+    WriteUnsigned(output, (uint64_t)ball.GetBallType(), 1);
+    WriteDouble(output, ball.GetPosition().x);
+    WriteDouble(output, ball.GetPosition().y);
+  }
+  return true;
+}
+
+template <typename Spec>
+bool BasicReplay<Spec>::WriteInput(std::ostream &output, const Input &input,
+                                   uint64_t previous_step) {
+  if (input.step < previous_step || !Fits(input.step - previous_step, 4)) {
+    return false;
+  }
+  WriteUnsigned(output, (uint64_t)input.type, 1);
+  WriteUnsigned(output, input.step - previous_step, 4);
+  if (input.type == shot) {
+    WriteDouble(output, input.angle);
+    WriteDouble(output, input.power);
+  } else {
+    WriteDouble(output, input.position.x);
+    WriteDouble(output, input.position.y);
+  }
+  return true;
+}
+
+template <typename Spec>
+bool BasicReplay<Spec>::WriteKeyframe(std::ostream &output,
+                                      const Keyframe &keyframe,
+                                      uint64_t previous_step) {
+  const BoardState &state = keyframe.state;
+  if (keyframe.step < previous_step ||
+      !Fits(keyframe.step - previous_step, 4) ||
+      !Fits(state.num_balls, 1) || !Fits(state.player_score, 4) ||
+      !BallNumbersFit(state.ball_numbers_scored,
+                      state.num_ball_numbers_scored) ||
+      !BallNumbersFit(state.pocketed_this_shot,
+                      state.num_pocketed_this_shot)) {
+    return false;
+  }
+  for (size_t i = 0; i < state.num_balls; i++) {
+    if (!Fits(state.balls[i].GetBallNumber(), 1)) {
+      return false;
+    }
+  }
+  WriteUnsigned(output, kKeyframeRecord, 1);
+  WriteUnsigned(output, keyframe.step - previous_step, 4);
+  WriteUnsigned(output, state.num_balls, 1);
+  for (size_t i = 0; i < state.num_balls; i++) {
+    const Ball &ball = state.balls[i];
+    WriteUnsigned(output, ball.GetBallNumber(), 1);
+    WriteUnsigned(output, (uint64_t)ball.GetBallType(), 1);
+    WriteDouble(output, ball.GetPosition().x);
+    WriteDouble(output, ball.GetPosition().y);
+    WriteDouble(output, ball.GetVelocity().x);
+    WriteDouble(output, ball.GetVelocity().y);
+    WriteDouble(output, ball.GetVelocityBoost());
+  }
+  WriteBallNumbers(output, state.ball_numbers_scored,
+                   state.num_ball_numbers_scored);
+  WriteUnsigned(output, state.player_score, 4);
+  WriteUnsigned(output, (uint64_t)state.ball_type_to_score, 1);
+  WriteUnsigned(output, (uint64_t)state.game_state, 1);
+  WriteBallNumbers(output, state.pocketed_this_shot,
+                   state.num_pocketed_this_shot);
+  WriteUnsigned(output, state.stick_visible ? 1 : 0, 1);
+  WriteUnsigned(output, state.cue_in_hole ? 1 : 0, 1);
+  WriteDouble(output, state.frame_remainder);
+  return true;
+}
+
+template <typename Spec>
+void BasicReplay<Spec>::Begin(Board &board) const {
+  board.ResetBoard();
+  board.SetSimulationMode(simulation_mode_);
+  board.SetPoolBalls(initial_balls_);
+}
+
+template <typename Spec>
+void BasicReplay<Spec>::Apply(Board &board, const Input &input) {
+  if (input.type == shot) {
+    board.HitCueBall(input.angle, input.power);
+  } else if (input.type == cue_position) {
+    board.SetCueBallPosition(input.position);
+  } else {
+    board.RepositionCueBall(input.position);
+  }
+}
+
+template <typename Spec>
+uint64_t BasicReplay<Spec>::Play(Board &board) const {
+  return Play(board, 0, nullptr);
+}
+
+template <typename Spec>
+uint64_t BasicReplay<Spec>::Seek(Board &board, uint64_t step) const {
+  Begin(board);
+  // first keyframe after the step, the one before it is where to start
+  auto keyframe = std::upper_bound(
+      keyframes_.begin(), keyframes_.end(), step,
+      [](uint64_t value, const Keyframe &other) {
+        return value < other.step;
+      });
+  uint64_t current_step = 0;
+  if (keyframe != keyframes_.begin()) {
+    --keyframe;
+    BoardState state = keyframe->state;
+    // stick and aim line stay as they were at the start of the game
+    BoardState start = board.Save();
+    state.stick = start.stick;
+    state.aim_line_length = start.aim_line_length;
+    board.Restore(state);
+    current_step = keyframe->step;
+  }
+  // inputs before the keyframe are already part of its state
+  size_t next_input =
+      std::lower_bound(inputs_.begin(), inputs_.end(), current_step,
+                       [](const Input &input, uint64_t value) {
+                         return input.step < value;
+                       }) -
+      inputs_.begin();
+  uint64_t start_step = current_step;
+  for (; current_step < step; current_step++) {
+    ApplyInputs(board, current_step, next_input);
+    if (board.GetPlayerState() == Player::playing) {
+      board.Advance(frames_per_step_);
+    }
+  }
+  return step - start_step;
+}
+
+template <typename Spec>
+void BasicReplay<Spec>::BuildKeyframes(Board &board, uint64_t interval) {
+  vector<Keyframe> keyframes;
+  Play(board, interval, &keyframes);
+  keyframes_ = keyframes;
+}
+
+template <typename Spec>
+uint64_t BasicReplay<Spec>::Play(Board &board, uint64_t keyframe_interval,
+                                 vector<Keyframe> *keyframes) const {
+  Begin(board);
+  uint64_t step = 0;
+  size_t next_input = 0;
+  uint64_t steps_after_last_input = 0;
+  while (steps_after_last_input < kMaxStepsAfterLastInput) {
+    if (keyframe_interval > 0 && step > 0 && step % keyframe_interval == 0) {
+      keyframes->push_back({step, board.Save()});
+    }
+    ApplyInputs(board, step, next_input);
+    if (next_input == inputs_.size()) {
+      // stick comes back once every ball has stopped
+      if (board.GetStickVisibility() ||
+          board.GetPlayerState() != Player::playing) {
+        break;
+      }
+      steps_after_last_input += 1;
+    }
+    // same as the simulation thread, which stops stepping once the game ends
+    if (board.GetPlayerState() == Player::playing) {
+      board.Advance(frames_per_step_);
+    }
+    step += 1;
+  }
+  return step;
+}
+
+template <typename Spec>
+void BasicReplay<Spec>::ApplyInputs(Board &board, uint64_t step,
+                                    size_t &next_input) const {
+  while (next_input < inputs_.size() && inputs_[next_input].step <= step) {
+    Apply(board, inputs_[next_input]);
+    next_input += 1;
+  }
+}
+
+template class BasicReplay<ClassicTable>;
+template class BasicReplay<SevenFootTable>;
+template class BasicReplay<EightFootTable>;
+template class BasicReplay<NineFootTable>;
+template class BasicReplay<SnookerTable>;
+template class BasicReplay<CaromTable>;
+}  // namespace pool
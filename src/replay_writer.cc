@@ -0,0 +1,174 @@
+#include "replay_writer.h"
+
+#include <chrono>
+namespace pool {
+template <typename Spec>
+constexpr const char *BasicReplayWriter<Spec>::kFileExtension;
+template <typename Spec>
+constexpr const double BasicReplayWriter<Spec>::kIdleSeconds;
+
+template <typename Spec>
+BasicReplayWriter<Spec>::BasicReplayWriter(const string &path_prefix)
+    : path_prefix_(path_prefix), num_dropped_(0), running_(false) {
+}
+
+template <typename Spec>
+BasicReplayWriter<Spec>::~BasicReplayWriter() {
+  Stop();
+}
+
+template <typename Spec>
+void BasicReplayWriter<Spec>::Start() {
+  if (!running_) {
+    running_ = true;
+    thread_ = std::thread(&BasicReplayWriter::Run, this);
+  }
+}
+
+template <typename Spec>
+void BasicReplayWriter<Spec>::Stop() {
+  running_ = false;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+template <typename Spec>
+bool BasicReplayWriter<Spec>::BeginGame(const Board &board,
+                                        double frames_per_step) {
+  num_games_ += 1;
+  const vector<Ball> &balls = board.GetPoolBalls();
+  // the whole game header has to fit or none of it is queued, only the
+  // writer thread frees space so the size can only get smaller meanwhile
+  if (kQueueCapacity - items_.GetSize() < balls.size() + 1) {
+    game_dropped_ = true;
+    num_dropped_ += 1;
+    return false;
+  }
+  game_dropped_ = false;
+  Item item;
+  item.type = new_game;
+  item.game_number = num_games_ - 1;
+  item.mode = board.GetSimulationMode();
+  item.frames_per_step = frames_per_step;
+  item.num_balls = balls.size();
+  items_.TryPush(item);
+  item.type = initial_ball;
+  for (const Ball &ball : balls) {
+    item.ball = ball;
+    items_.TryPush(item);
+  }
+  return true;
+}
+
+template <typename Spec>
+bool BasicReplayWriter<Spec>::Record(const typename Replay::Input &input) {
+  if (num_games_ == 0 || game_dropped_) {
+    num_dropped_ += 1;
+    return false;
+  }
+  Item item;
+  item.type = game_input;
+  item.input = input;
+  if (!items_.TryPush(item)) {
+    game_dropped_ = true;
+    num_dropped_ += 1;
+    return false;
+  }
+  return true;
+}
+
+template <typename Spec>
+bool BasicReplayWriter<Spec>::RecordKeyframe(
+    const typename Replay::Keyframe &keyframe) {
+  // the keyframe is only queued if the item saying where it goes fits too,
+  // otherwise the writer would take it at the wrong place
+  if (num_games_ == 0 || game_dropped_ ||
+      items_.GetSize() == kQueueCapacity || !keyframes_.TryPush(keyframe)) {
+    num_dropped_ += 1;
+    return false;
+  }
+  Item item;
+  item.type = game_keyframe;
+  items_.TryPush(item);
+  return true;
+}
+
+template <typename Spec>
+string BasicReplayWriter<Spec>::GetPath(size_t game_number) const {
+  return path_prefix_ + std::to_string(game_number) + kFileExtension;
+}
+
+template <typename Spec>
+size_t BasicReplayWriter<Spec>::GetGameCount() const {
+  return num_games_;
+}
+
+template <typename Spec>
+size_t BasicReplayWriter<Spec>::GetDroppedCount() const {
+  return num_dropped_;
+}
+
+template <typename Spec>
+void BasicReplayWriter<Spec>::Run() {
+  while (running_) {
+    WriteQueued();
+    file_.flush();
+    std::this_thread::sleep_for(std::chrono::duration<double>(kIdleSeconds));
+  }
+  // anything queued before Stop still gets written
+  WriteQueued();
+  file_.close();
+}
+
+template <typename Spec>
+void BasicReplayWriter<Spec>::WriteQueued() {
+  Item item;
+  while (items_.TryPop(item)) {
+    if (item.type == new_game) {
+      pending_game_number_ = item.game_number;
+      pending_mode_ = item.mode;
+      pending_frames_per_step_ = item.frames_per_step;
+      num_pending_balls_ = item.num_balls;
+      pending_balls_.clear();
+    } else if (item.type == initial_ball) {
+      pending_balls_.push_back(item.ball);
+    } else if (item.type == game_keyframe) {
+      // pushed before its item so it is always there
+      typename Replay::Keyframe keyframe;
+      keyframes_.TryPop(keyframe);
+      // one that doesn't fit the file format is skipped like a dropped one
+      if (file_.is_open() &&
+          Replay::WriteKeyframe(file_, keyframe, last_step_)) {
+        last_step_ = keyframe.step;
+      }
+    } else if (file_.is_open()) {
+      // the game couldn't be played back past an input that doesn't fit,
+      // so its file ends there
+      if (!Replay::WriteInput(file_, item.input, last_step_)) {
+        file_.close();
+      }
+      last_step_ = item.input.step;
+    }
+    if ((item.type == new_game || item.type == initial_ball) &&
+        pending_balls_.size() == num_pending_balls_) {
+      file_.close();
+      file_.clear();
+      file_.open(GetPath(pending_game_number_),
+                 std::ios::binary | std::ios::trunc);
+      if (!Replay::WriteHeader(file_, pending_mode_, pending_frames_per_step_,
+                               pending_balls_)) {
+        file_.close();
+      }
+      last_step_ = 0;
+    }
+  }
+}
+
+template class BasicReplayWriter<ClassicTable>;
+template class BasicReplayWriter<SevenFootTable>;
+template class BasicReplayWriter<EightFootTable>;
+template class BasicReplayWriter<NineFootTable>;
+template class BasicReplayWriter<SnookerTable>;
+template class BasicReplayWriter<CaromTable>;
+}  // namespace pool
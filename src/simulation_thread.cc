@@ -0,0 +1,269 @@
+#include "simulation_thread.h"
+
+#include <algorithm>
+
+#include "profiler.h"
+namespace pool {
+template <typename Spec>
+BasicSimulationThread<Spec>::BasicSimulationThread(
+    const Board &board, const FixedTimestep &timestep)
+    : board_(board),
+      timestep_(timestep),
+      game_frames_per_step_(timestep.GetStepSeconds() / Ball::kSecondsPerFrame),
+      playing_back_(false),
+      snapshots_(Snapshot{board, std::chrono::steady_clock::now(), 0}),
+      running_(false) {
+  ReserveRecording();
+}
+
+template <typename Spec>
+BasicSimulationThread<Spec>::~BasicSimulationThread() {
+  Stop();
+}
+
+template <typename Spec>
+void BasicSimulationThread<Spec>::SetReplayWriter(ReplayWriter *writer) {
+  replay_writer_ = writer;
+}
+
+template <typename Spec>
+void BasicSimulationThread<Spec>::SetKeyframeInterval(uint64_t interval) {
+  keyframe_interval_ = interval;
+  ReserveRecording();
+}
+
+template <typename Spec>
+bool BasicSimulationThread<Spec>::LoadReplay(const Replay &replay) {
+  if (running_) {
+    return false;
+  }
+  BeginPlayback(replay);
+  Publish();
+  return true;
+}
+
+template <typename Spec>
+bool BasicSimulationThread<Spec>::IsPlayingBack() const {
+  return playing_back_;
+}
+
+template <typename Spec>
+void BasicSimulationThread<Spec>::Start() {
+  if (!running_) {
+    running_ = true;
+    thread_ = std::thread(&BasicSimulationThread::Run, this);
+  }
+}
+
+template <typename Spec>
+void BasicSimulationThread<Spec>::Stop() {
+  running_ = false;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+template <typename Spec>
+bool BasicSimulationThread<Spec>::Send(CommandType type,
+                                       const dvec2 &position) {
+  Command command = {type, position, 0, 0};
+  return commands_.TryPush(command);
+}
+
+template <typename Spec>
+bool BasicSimulationThread<Spec>::SendShot(double angle, double power) {
+  Command command = {shoot, dvec2(0, 0), angle, power};
+  return commands_.TryPush(command);
+}
+
+template <typename Spec>
+const typename BasicSimulationThread<Spec>::Snapshot &
+BasicSimulationThread<Spec>::GetLatestSnapshot() {
+  snapshots_.Update();
+  return snapshots_.Read();
+}
+
+template <typename Spec>
+double BasicSimulationThread<Spec>::GetInterpolationFactor(
+    const Snapshot &snapshot) const {
+  std::chrono::duration<double> since_step =
+      std::chrono::steady_clock::now() - snapshot.time;
+  return std::min(since_step.count() / timestep_.GetStepSeconds(), 1.0);
+}
+
+template <typename Spec>
+void BasicSimulationThread<Spec>::Run() {
+  std::chrono::steady_clock::time_point last_time =
+      std::chrono::steady_clock::now();
+  while (running_) {
+    std::chrono::steady_clock::time_point now =
+        std::chrono::steady_clock::now();
+    RunOnce(std::chrono::duration<double>(now - last_time).count());
+    last_time = now;
+    // sleep until the next step is due
+    double until_next_step = (1 - timestep_.GetInterpolationFactor()) *
+                             timestep_.GetStepSeconds();
+    std::this_thread::sleep_for(std::chrono::duration<double>(until_next_step));
+  }
+}
+
+template <typename Spec>
+size_t BasicSimulationThread<Spec>::RunOnce(double elapsed_seconds) {
+  bool board_changed = false;
+  Command command;
+  while (commands_.TryPop(command)) {
+    POOL_PROFILE_SCOPE("simulation/command");
+    Apply(command);
+    board_changed = true;
+  }
+  size_t num_steps = timestep_.Update(elapsed_seconds);
+  POOL_PROFILE_COUNT("simulation/steps", num_steps);
+  for (size_t step = 0; step < num_steps; step++) {
+    POOL_PROFILE_SCOPE("simulation/step");
+    // replayed inputs go in before the same step they were recorded at
+    const vector<typename Replay::Input> &inputs = playback_.GetInputs();
+    while (playing_back_ && next_playback_input_ < inputs.size() &&
+           inputs[next_playback_input_].step <= step_ - game_start_step_) {
+      ApplyInput(inputs[next_playback_input_]);
+      next_playback_input_ += 1;
+    }
+    if (next_playback_input_ == inputs.size()) {
+      playing_back_ = false;
+    }
+    if (board_.GetPlayerState() == Player::playing) {
+      board_.Advance(game_frames_per_step_);
+    }
+    step_ += 1;
+    RecordKeyframe();
+  }
+  if (num_steps > 0 || board_changed) {
+    Publish();
+  }
+  return num_steps;
+}
+
+template <typename Spec>
+void BasicSimulationThread<Spec>::Apply(const Command &command) {
+  if (command.type == reset) {
+    board_.ResetBoard();
+    board_.CreatePoolBalls();
+    timestep_.Reset();
+    playing_back_ = false;
+    BeginGame(timestep_.GetStepSeconds() / Ball::kSecondsPerFrame);
+    return;
+  }
+  if (command.type == replay) {
+    // copied since playing back records the game again
+    Replay game = recording_;
+    BeginPlayback(game);
+    return;
+  }
+  if (board_.GetPlayerState() != Player::playing || playing_back_) {
+    return;
+  }
+  typename Replay::Input input = {Replay::shot, step_ - game_start_step_, 0,
+                                  0, command.position};
+  if (command.type == rotate_right) {
+    board_.UpdateStickRight();
+  } else if (command.type == rotate_left) {
+    board_.UpdateStickLeft();
+  } else if (command.type == pull_back) {
+    board_.PullStickBackForShot();
+  } else if (command.type == hit || command.type == shoot) {
+    // same as a stick hit, only while the stick is waiting for a shot
+    if (board_.GetStickVisibility() &&
+        (command.type == hit || !board_.IsCueInHole())) {
+      if (command.type == hit) {
+        input.angle = board_.GetShotAngle();
+        input.power = board_.GetBallPool()[0].GetVelocityBoost();
+      } else {
+        input.angle = command.angle;
+        input.power = command.power;
+      }
+      ApplyInput(input);
+    }
+  } else if (board_.IsCueInHole()) {
+    if (command.type == set_cue_position) {
+      input.type = Replay::cue_position;
+      ApplyInput(input);
+    } else if (command.type == reposition_cue) {
+      input.type = Replay::cue_placement;
+      ApplyInput(input);
+    }
+  }
+}
+
+template <typename Spec>
+void BasicSimulationThread<Spec>::ApplyInput(typename Replay::Input input) {
+  // recorded at the step it is applied, which is the replayed step when
+  // playing back
+  input.step = step_ - game_start_step_;
+  Replay::Apply(board_, input);
+  recording_.AddInput(input);
+  if (replay_writer_ != nullptr) {
+    replay_writer_->Record(input);
+  }
+}
+
+template <typename Spec>
+void BasicSimulationThread<Spec>::RecordKeyframe() {
+  uint64_t game_step = step_ - game_start_step_;
+  if (keyframe_interval_ == 0 || game_step % keyframe_interval_ != 0) {
+    return;
+  }
+  // taken before any input of the step, which come with the next commands
+  typename Replay::Keyframe keyframe = {game_step, board_.Save()};
+  recording_.AddKeyframe(keyframe);
+  if (replay_writer_ != nullptr) {
+    replay_writer_->RecordKeyframe(keyframe);
+  }
+}
+
+template <typename Spec>
+void BasicSimulationThread<Spec>::BeginGame(double frames_per_step) {
+  game_start_step_ = step_;
+  game_frames_per_step_ = frames_per_step;
+  recording_ = Replay(board_, frames_per_step);
+  ReserveRecording();
+  if (replay_writer_ != nullptr) {
+    replay_writer_->BeginGame(board_, frames_per_step);
+  }
+}
+
+template <typename Spec>
+void BasicSimulationThread<Spec>::ReserveRecording() {
+  size_t num_keyframes = 0;
+  if (keyframe_interval_ > 0) {
+    num_keyframes = kReservedGameSteps / keyframe_interval_ + 1;
+  }
+  recording_.Reserve(kReservedInputs, num_keyframes);
+}
+
+template <typename Spec>
+void BasicSimulationThread<Spec>::BeginPlayback(const Replay &replay) {
+  replay.Begin(board_);
+  timestep_.Reset();
+  playback_ = replay;
+  next_playback_input_ = 0;
+  playing_back_ = true;
+  BeginGame(replay.GetFramesPerStep());
+}
+
+template <typename Spec>
+void BasicSimulationThread<Spec>::Publish() {
+  POOL_PROFILE_SCOPE("simulation/publish");
+  Snapshot &snapshot = snapshots_.GetWriteBuffer();
+  // assignment reuses the ball vectors already in the buffer
+  snapshot.board = board_;
+  snapshot.time = std::chrono::steady_clock::now();
+  snapshot.step = step_;
+  snapshots_.Publish();
+}
+
+template class BasicSimulationThread<ClassicTable>;
+template class BasicSimulationThread<SevenFootTable>;
+template class BasicSimulationThread<EightFootTable>;
+template class BasicSimulationThread<NineFootTable>;
+template class BasicSimulationThread<SnookerTable>;
+template class BasicSimulationThread<CaromTable>;
+}  // namespace pool
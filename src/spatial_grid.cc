@@ -0,0 +1,114 @@
+#include "spatial_grid.h"
+
+#include <algorithm>
+#include <cmath>
+namespace pool {
+SpatialGrid::SpatialGrid() {
+  cell_size_ = Ball::GetDiameter();
+  num_columns_ = 1;
+  num_rows_ = 1;
+  num_balls_ = 0;
+  cell_starts_.assign(GetNumberOfCells() + 1, 0);
+}
+
+SpatialGrid::SpatialGrid(const dvec2 &top_left_pos,
+                         const dvec2 &bottom_right_pos, double cell_size,
+                         size_t max_balls) {
+  top_left_pos_ = top_left_pos;
+  cell_size_ = cell_size;
+  num_columns_ =
+      (size_t)std::ceil((bottom_right_pos.x - top_left_pos.x) / cell_size) + 1;
+  num_rows_ =
+      (size_t)std::ceil((bottom_right_pos.y - top_left_pos.y) / cell_size) + 1;
+  num_balls_ = 0;
+  // sizes never change after this, so copying a grid over another made
+  // the same way reuses its storage
+  ball_cells_.resize(max_balls);
+  cell_starts_.assign(GetNumberOfCells() + 1, 0);
+  cell_entries_.resize(max_balls);
+}
+
+void SpatialGrid::FindCell(const dvec2 &position, size_t &column,
+                           size_t &row) const {
+  double x = std::floor((position.x - top_left_pos_.x) / cell_size_);
+  double y = std::floor((position.y - top_left_pos_.y) / cell_size_);
+  // balls off the board (dragged or hit into holes) go to the edge cells
+  column = x < 0 ? 0 : std::min((size_t)x, num_columns_ - 1);
+  row = y < 0 ? 0 : std::min((size_t)y, num_rows_ - 1);
+}
+
+void SpatialGrid::Build(const vector<Ball> &balls) {
+  Build(balls.data(), balls.data() + balls.size());
+}
+
+void SpatialGrid::Build(const Ball *first, const Ball *last) {
+  double radius = Ball::GetDiameter() / 2;
+  size_t num_cells = GetNumberOfCells();
+  num_balls_ = last - first;
+  std::fill(cell_starts_.begin(), cell_starts_.end(), 0);
+  // counting sort of balls by cell
+  for (size_t i = 0; i < num_balls_; i++) {
+    dvec2 center = {first[i].GetPosition().x + radius,
+                    first[i].GetPosition().y + radius};
+    size_t column = 0;
+    size_t row = 0;
+    FindCell(center, column, row);
+    ball_cells_[i] = row * num_columns_ + column;
+    cell_starts_[ball_cells_[i] + 1] += 1;
+  }
+  for (size_t cell = 0; cell < num_cells; cell++) {
+    cell_starts_[cell + 1] += cell_starts_[cell];
+  }
+  // balls are added in index order so each cell lists them in order
+  for (size_t i = 0; i < num_balls_; i++) {
+    size_t cell = ball_cells_[i];
+    size_t entry = cell_starts_[cell];
+    cell_entries_[entry] = i;
+    cell_starts_[cell] += 1;
+  }
+  // filling moved each start to the next cell's start, shift them back
+  for (size_t cell = num_cells; cell > 0; cell--) {
+    cell_starts_[cell] = cell_starts_[cell - 1];
+  }
+  cell_starts_[0] = 0;
+}
+
+void SpatialGrid::FindCandidatePairs(
+    vector<pair<size_t, size_t>> &pairs) const {
+  pairs.clear();
+  for (size_t i = 0; i < num_balls_; i++) {
+    size_t column = ball_cells_[i] % num_columns_;
+    size_t row = ball_cells_[i] / num_columns_;
+    size_t first_new_pair = pairs.size();
+    size_t min_row = row == 0 ? 0 : row - 1;
+    size_t min_column = column == 0 ? 0 : column - 1;
+    for (size_t r = min_row; r <= row + 1 && r < num_rows_; r++) {
+      for (size_t c = min_column; c <= column + 1 && c < num_columns_; c++) {
+        size_t cell = r * num_columns_ + c;
+        for (size_t entry = cell_starts_[cell];
+             entry < cell_starts_[cell + 1]; entry++) {
+          size_t j = cell_entries_[entry];
+          if (j > i) {
+            pairs.push_back(std::make_pair(i, j));
+          }
+        }
+      }
+    }
+    // insertion sort the few neighbours of i so pairs are in index order
+    for (size_t k = first_new_pair + 1; k < pairs.size(); k++) {
+      pair<size_t, size_t> current = pairs[k];
+      size_t position = k;
+      while (position > first_new_pair &&
+             pairs[position - 1].second > current.second) {
+        pairs[position] = pairs[position - 1];
+        position -= 1;
+      }
+      pairs[position] = current;
+    }
+  }
+}
+
+size_t SpatialGrid::GetNumberOfCells() const {
+  return num_columns_ * num_rows_;
+}
+}  // namespace pool
@@ -0,0 +1,54 @@
+#include "sprite_atlas.h"
+
+#include <algorithm>
+#include <cmath>
+namespace pool {
+constexpr const int SpriteAtlas::kDefaultPadding;
+
+SpriteAtlas::SpriteAtlas() : size_(0, 0) {
+}
+
+SpriteAtlas::SpriteAtlas(const vector<ivec2> &image_sizes, int padding) {
+  ivec2 cell_size = {0, 0};
+  for (const ivec2 &image_size : image_sizes) {
+    cell_size.x = std::max(cell_size.x, image_size.x);
+    cell_size.y = std::max(cell_size.y, image_size.y);
+  }
+  cell_size += ivec2(padding, padding);
+  // smallest number of columns that fits the images in as many rows
+  int columns = (int)std::ceil(std::sqrt((double)image_sizes.size()));
+  int rows =
+      columns == 0 ? 0 : ((int)image_sizes.size() + columns - 1) / columns;
+  for (size_t i = 0; i < image_sizes.size(); i++) {
+    int column = (int)i % columns;
+    int row = (int)i / columns;
+    Region region;
+    region.position = {column * cell_size.x + padding,
+                       row * cell_size.y + padding};
+    region.size = image_sizes[i];
+    regions_.push_back(region);
+  }
+  size_ = {columns * cell_size.x + padding, rows * cell_size.y + padding};
+}
+
+ivec2 SpriteAtlas::GetSize() const {
+  return size_;
+}
+
+size_t SpriteAtlas::GetImageCount() const {
+  return regions_.size();
+}
+
+const SpriteAtlas::Region &SpriteAtlas::GetRegion(size_t image) const {
+  return regions_[image];
+}
+
+vec4 SpriteAtlas::GetUvRect(size_t image) const {
+  const Region &region = regions_[image];
+  float width = (float)size_.x;
+  float height = (float)size_.y;
+  return {region.position.x / width, region.position.y / height,
+          (region.position.x + region.size.x) / width,
+          (region.position.y + region.size.y) / height};
+}
+}  // namespace pool
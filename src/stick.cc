@@ -2,6 +2,8 @@
 // Created by neha konjeti on 4/16/21.
 //
 #include "stick.h"
+
+#include <cmath>
 namespace pool {
 Stick::Stick() {
   // set starting angle of stick
@@ -56,19 +58,13 @@ double Stick::GetMaxPullBackDistance() const {
 double Stick::GetStickHeight() const {
   return height_;
 }
-void Stick::Display(Ball& ball) const {
-  ci::gl::color(ci::Color("chocolate"));
-  ci::gl::pushModelMatrix();
-  // grid is rotated by rad
-  double x = ball.GetPosition().x + ball.GetDiameter() / 2;
-  double y = ball.GetPosition().y + ball.GetDiameter() / 2;
-  ci::gl::translate({x, y});
-  ci::gl::rotate(angle_);
-  // change position to match rotated grid
-  ci::gl::drawSolidRect(
-      ci::Rectf({-width_, pull_from_ball_ + kInitialSpaceFromCueBall},
-                {width_, height_}));
-  ci::gl::popModelMatrix();
+
+double Stick::GetStickWidth() const {
+  return width_;
+}
+
+double Stick::GetInitialSpaceFromCueBall() const {
+  return kInitialSpaceFromCueBall;
 }
 
 void Stick::ResetStick() {
@@ -0,0 +1,19 @@
+#include "table_spec.h"
+
+namespace pool {
+constexpr const size_t SixPockets::kNumPockets;
+constexpr const double SixPockets::kPocketX[];
+constexpr const double SixPockets::kPocketY[];
+constexpr const size_t EightBallSet::kNumberOfBallsPerType;
+constexpr const size_t EightBallSet::kNumberOfBalls;
+constexpr const size_t EightBallSet::kRackOrder[];
+constexpr const size_t SnookerTable::kNumberOfBallsPerType;
+constexpr const size_t SnookerTable::kNumberOfBalls;
+constexpr const size_t SnookerTable::kRackOrder[];
+constexpr const size_t CaromTable::kNumPockets;
+constexpr const double CaromTable::kPocketX[];
+constexpr const double CaromTable::kPocketY[];
+constexpr const size_t CaromTable::kNumberOfBallsPerType;
+constexpr const size_t CaromTable::kNumberOfBalls;
+constexpr const size_t CaromTable::kRackOrder[];
+}  // namespace pool
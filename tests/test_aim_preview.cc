@@ -0,0 +1,143 @@
+#include <catch2/catch.hpp>
+
+#include "aim_preview.h"
+#include "board.h"
+using glm::dvec2;
+using pool::AimPreview;
+using pool::Ball;
+using pool::Board;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Straight and cut hits give the ghost ball position and the directions both
+ * balls leave in
+ * Paths bounce off sides up to the bounce limit and end at the path length
+ * Paths end where the cue ball center enters a hole
+ * Path is only traced again when the stick, pull back or balls change
+ */
+
+namespace {
+/**
+ * Ball with its center at a position.
+ */
+Ball MakeBall(size_t number, Ball::Type type, const dvec2 &center) {
+  double radius = Ball::GetDiameter() / 2;
+  return Ball(number, type, center - dvec2(radius, radius), {0, 0});
+}
+}  // namespace
+
+// board of size 1000 has sides at x = 100 and 900, y = 250 and 750, the
+// stick starts aimed in the positive x direction and paths are 300 long
+TEST_CASE("aim preview hits balls") {
+  Board board = Board(1000);
+  REQUIRE(AimPreview::GetPathLength(board) == Approx(300));
+  AimPreview preview;
+  SECTION("straight on") {
+    board.SetPoolBalls({MakeBall(0, Ball::cue, {300, 500}),
+                        MakeBall(5, Ball::striped, {500, 500})});
+    const AimPreview::Path &path = preview.Update(board);
+    REQUIRE(path.hits_ball);
+    REQUIRE_FALSE(path.cue_pocketed);
+    REQUIRE(path.object_ball_number == 5);
+    REQUIRE(path.points.size() == 2);
+    REQUIRE(path.ghost_position.x == Approx(475));
+    REQUIRE(path.ghost_position.y == Approx(500));
+    REQUIRE(path.object_ball_direction.x == Approx(1));
+    REQUIRE(path.object_ball_direction.y == Approx(0).margin(1e-9));
+    REQUIRE(path.cue_ball_direction == dvec2(0, 0));
+  }
+  SECTION("cut") {
+    board.SetPoolBalls({MakeBall(0, Ball::cue, {300, 500}),
+                        MakeBall(5, Ball::striped, {500, 510})});
+    const AimPreview::Path &path = preview.Update(board);
+    REQUIRE(path.hits_ball);
+    double offset = std::sqrt(25.0 * 25.0 - 10.0 * 10.0);
+    REQUIRE(path.ghost_position.x == Approx(500 - offset));
+    REQUIRE(path.ghost_position.y == Approx(500));
+    REQUIRE(path.object_ball_direction.x == Approx(offset / 25));
+    REQUIRE(path.object_ball_direction.y == Approx(10.0 / 25));
+    // cue ball goes off at a right angle to the object ball
+    REQUIRE(path.cue_ball_direction.x == Approx(10.0 / 25));
+    REQUIRE(path.cue_ball_direction.y == Approx(-offset / 25));
+  }
+  SECTION("ball behind the cue ball is ignored") {
+    board.SetPoolBalls({MakeBall(0, Ball::cue, {300, 500}),
+                        MakeBall(5, Ball::striped, {200, 500})});
+    REQUIRE_FALSE(preview.Update(board).hits_ball);
+  }
+}
+
+TEST_CASE("aim preview bounces and ends") {
+  Board board = Board(1000);
+  SECTION("bounces off side") {
+    board.SetPoolBalls({MakeBall(0, Ball::cue, {800, 500})});
+    AimPreview preview = AimPreview(1);
+    const AimPreview::Path &path = preview.Update(board);
+    REQUIRE(path.points.size() == 3);
+    REQUIRE(path.points[1].x == Approx(887.5));
+    // rest of the length is used going back
+    REQUIRE(path.points[2].x == Approx(675));
+    REQUIRE(path.points[2].y == Approx(500));
+    REQUIRE_FALSE(path.hits_ball);
+  }
+  SECTION("bounce limit") {
+    board.SetPoolBalls({MakeBall(0, Ball::cue, {800, 500})});
+    AimPreview preview = AimPreview(0);
+    const AimPreview::Path &path = preview.Update(board);
+    REQUIRE(path.points.size() == 2);
+    REQUIRE(path.points[1].x == Approx(887.5));
+  }
+  SECTION("path length") {
+    board.SetPoolBalls({MakeBall(0, Ball::cue, {300, 500})});
+    AimPreview preview;
+    const AimPreview::Path &path = preview.Update(board);
+    REQUIRE(path.points.size() == 2);
+    REQUIRE(path.points[1].x == Approx(600));
+  }
+  SECTION("hole") {
+    // along the top side into the top right hole at (900, 250)
+    board.SetPoolBalls({MakeBall(0, Ball::cue, {700, 262.5})});
+    AimPreview preview;
+    const AimPreview::Path &path = preview.Update(board);
+    REQUIRE(path.cue_pocketed);
+    REQUIRE(path.points.size() == 2);
+    double entry = std::sqrt(25.0 * 25.0 - 12.5 * 12.5);
+    REQUIRE(path.points[1].x == Approx(900 - entry));
+  }
+}
+
+TEST_CASE("aim preview is only traced when the board changes") {
+  Board board = Board(1000);
+  board.CreatePoolBalls();
+  AimPreview preview;
+  preview.Update(board);
+  REQUIRE(preview.GetTraceCount() == 1);
+  SECTION("same board") {
+    preview.Update(board);
+    Board copy = board;
+    preview.Update(copy);
+    REQUIRE(preview.GetTraceCount() == 1);
+  }
+  SECTION("stick rotated") {
+    board.UpdateStickRight();
+    const AimPreview::Path &path = preview.Update(board);
+    REQUIRE(preview.GetTraceCount() == 2);
+    dvec2 first_segment = path.points[1] - path.points[0];
+    double angle = board.GetShotAngle();
+    REQUIRE(first_segment.x * -sin(angle) ==
+            Approx(first_segment.y * -cos(angle)));
+  }
+  SECTION("stick pulled back") {
+    board.PullStickBackForShot();
+    preview.Update(board);
+    REQUIRE(preview.GetTraceCount() == 2);
+  }
+  SECTION("balls moved") {
+    vector<Ball> balls = board.GetPoolBalls();
+    balls[3].SetPosition(balls[3].GetPosition() + dvec2(1, 0));
+    board.SetPoolBalls(balls);
+    preview.Update(board);
+    REQUIRE(preview.GetTraceCount() == 2);
+  }
+}
@@ -0,0 +1,113 @@
+#include <catch2/catch.hpp>
+
+#include "aim_preview.h"
+#include "allocation_counter.h"
+#include "board.h"
+#include "simulation_thread.h"
+using pool::AimPreview;
+using pool::Ball;
+using pool::Board;
+using pool::FixedTimestep;
+using pool::GetAllocationCount;
+using pool::Replay;
+using pool::SimulationThread;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Once warmed up, a frame of a rolling shot allocates nothing: stepping the
+ * simulation, publishing and reading the snapshot, interpolating the balls
+ * into a kept vector and reading the player, stick and holes the way the
+ * renderer does
+ * Same over several keyframe intervals, as the shot rolls to a stop and the
+ * game waits for the next one, so recording keyframes doesn't allocate
+ * Same while aiming with the aim preview traced again every frame
+ * Checked for frame stepping and event driven simulation
+ */
+
+namespace {
+/**
+ * Reads the board the way BoardRenderer does every frame.
+ * @return something depending on everything read, so it isn't optimized
+ * away.
+ */
+double ReadLikeRenderer(const Board &board, double interpolation_factor,
+                        vector<Ball> &balls) {
+  board.GetInterpolatedPoolBalls(interpolation_factor, balls);
+  double total = 0;
+  for (const Ball &ball : balls) {
+    total += ball.GetPosition().x + ball.GetBallNumber();
+  }
+  for (size_t ball_number : board.GetPlayer().GetBallNumbers()) {
+    total += ball_number;
+  }
+  for (const glm::dvec2 &hole : board.GetHolePositions()) {
+    total += hole.x;
+  }
+  return total + board.GetStick().GetAngle() + board.GetBallPool().GetCount();
+}
+}  // namespace
+
+TEST_CASE("steady state frames don't allocate") {
+  Board board = Board(1000);
+  board.CreatePoolBalls();
+  SECTION("frame stepping") {
+    board.SetSimulationMode(Board::frame_stepping);
+  }
+  SECTION("event driven") {
+    board.SetSimulationMode(Board::event_driven);
+  }
+  FixedTimestep timestep = FixedTimestep(1 / Ball::kSecondsPerFrame, 8);
+  SimulationThread simulation(board, timestep);
+  vector<Ball> balls;
+  double total = 0;
+  // a soft break keeps balls rolling and hitting each other for a while
+  // without pocketing any
+  simulation.SendShot(board.GetShotAngle(), Board::GetMinShotPower() * 2);
+  for (size_t i = 0; i < 10; i++) {
+    simulation.RunOnce(timestep.GetStepSeconds());
+    total += ReadLikeRenderer(simulation.GetLatestSnapshot().board, 0.5,
+                              balls);
+  }
+  size_t allocations_before = GetAllocationCount();
+  size_t num_steps = 0;
+  size_t num_rolling_steps = 0;
+  // past several keyframes, which are recorded every interval
+  while (num_steps < 5 * Replay::kDefaultKeyframeInterval) {
+    num_steps += simulation.RunOnce(timestep.GetStepSeconds());
+    const SimulationThread::Snapshot &snapshot =
+        simulation.GetLatestSnapshot();
+    total += ReadLikeRenderer(snapshot.board,
+                              simulation.GetInterpolationFactor(snapshot),
+                              balls);
+    if (!snapshot.board.GetStickVisibility()) {
+      num_rolling_steps += 1;
+    }
+  }
+  size_t allocations = GetAllocationCount() - allocations_before;
+  const Board &latest = simulation.GetLatestSnapshot().board;
+  REQUIRE(num_rolling_steps > 50);
+  REQUIRE(latest.GetPoolBalls().size() == 16);
+  REQUIRE(total != 0);
+  REQUIRE(allocations == 0);
+}
+
+TEST_CASE("aiming doesn't allocate") {
+  Board board = Board(1000);
+  board.CreatePoolBalls();
+  AimPreview preview;
+  vector<Ball> balls;
+  double total = 0;
+  preview.Update(board);
+  total += ReadLikeRenderer(board, 1, balls);
+  size_t allocations_before = GetAllocationCount();
+  for (size_t i = 0; i < 50; i++) {
+    // new angle every frame so the path is traced again
+    board.UpdateStickRight();
+    total += preview.Update(board).points.size();
+    total += ReadLikeRenderer(board, 1, balls);
+  }
+  size_t allocations = GetAllocationCount() - allocations_before;
+  REQUIRE(total != 0);
+  REQUIRE(allocations == 0);
+}
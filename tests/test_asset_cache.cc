@@ -0,0 +1,78 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "asset_cache.h"
+using pool::AssetCache;
+using std::string;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Preloaded and not preloaded assets are loaded and given back
+ * Each path is loaded once however often it is preloaded or got
+ * Preloading runs the loader on several threads at once
+ */
+
+TEST_CASE("asset cache loads once") {
+  std::atomic<size_t> loads(0);
+  AssetCache<string> cache(
+      [&loads](const string &path) {
+        loads += 1;
+        return "asset at " + path;
+      },
+      2);
+  SECTION("preloaded") {
+    cache.Preload({"a.png", "b.png", "c.png"});
+    REQUIRE(cache.IsCached("a.png"));
+    REQUIRE_FALSE(cache.IsCached("d.png"));
+    REQUIRE(cache.Get("b.png") == "asset at b.png");
+    REQUIRE(cache.Get("a.png") == "asset at a.png");
+    REQUIRE(cache.Get("c.png") == "asset at c.png");
+    cache.Preload({"a.png", "c.png"});
+    REQUIRE(cache.Get("a.png") == "asset at a.png");
+    REQUIRE(loads == 3);
+  }
+  SECTION("not preloaded") {
+    REQUIRE(cache.Get("d.png") == "asset at d.png");
+    REQUIRE(cache.IsCached("d.png"));
+    REQUIRE(cache.Get("d.png") == "asset at d.png");
+    cache.Preload({"d.png"});
+    REQUIRE(loads == 1);
+  }
+  SECTION("same reference") {
+    cache.Preload({"a.png"});
+    REQUIRE(&cache.Get("a.png") == &cache.Get("a.png"));
+  }
+}
+
+TEST_CASE("asset cache loads in parallel") {
+  std::atomic<size_t> loading(0);
+  std::atomic<size_t> most_loading(0);
+  AssetCache<size_t> cache(
+      [&](const string &path) {
+        size_t now_loading = ++loading;
+        size_t most = most_loading;
+        while (now_loading > most &&
+               !most_loading.compare_exchange_weak(most, now_loading)) {
+        }
+        // wait for another loader to start, the deadline only matters if
+        // they don't run in parallel
+        auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (most_loading < 2 &&
+               std::chrono::steady_clock::now() < deadline) {
+          std::this_thread::yield();
+        }
+        loading -= 1;
+        return path.size();
+      },
+      4);
+  cache.Preload({"1.png", "2.png", "3.png", "4.png", "10.png"});
+  REQUIRE(cache.Get("10.png") == 6);
+  REQUIRE(cache.Get("1.png") == 5);
+  REQUIRE(most_loading >= 2);
+}
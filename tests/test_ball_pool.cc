@@ -0,0 +1,187 @@
+#include <catch2/catch.hpp>
+
+#include "ball_pool.h"
+#include "board.h"
+using glm::dvec2;
+using pool::Ball;
+using pool::BallPool;
+using pool::Board;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Balls are in play after being assigned or added, numbers not in play
+ * aren't, the balls are listed in the order they were put in
+ * Removing takes the number off the list keeping the order of the rest,
+ * every other ball stays in its slot, so references to it stay valid
+ * Removing every ball leaves an empty pool, assigning again reuses the
+ * same slots
+ * Balls start awake, a sleep flag stays with its slot when another ball is
+ * removed, waking all clears every flag
+ * Sleep version changes when a flag changes or balls come and go, and not
+ * when a flag is set to what it already was
+ * Packed copies are in list order and copy back into the slots by number
+ * Board takes off every ball scored in the same frame, including balls
+ * next to each other (erasing by index skipped the second one), and keeps
+ * the others in the order they were set
+ */
+
+namespace {
+vector<Ball> MakeBalls(size_t count) {
+  vector<Ball> balls;
+  for (size_t number = 0; number < count; number++) {
+    balls.push_back(Ball(number, number == 0 ? Ball::cue : Ball::solid,
+                         {100.0 + 50 * number, 400}, {0, 0}));
+  }
+  return balls;
+}
+}  // namespace
+
+TEST_CASE("ball pool finds balls") {
+  BallPool pool = BallPool(16);
+  REQUIRE(pool.GetCount() == 0);
+  REQUIRE(pool.GetCapacity() == 16);
+  REQUIRE_FALSE(pool.IsInPlay(0));
+  SECTION("assigned") {
+    pool.Assign(MakeBalls(4));
+    REQUIRE(pool.GetCount() == 4);
+    REQUIRE(pool.IsInPlay(2));
+    REQUIRE(pool[2].GetPosition() == dvec2(200, 400));
+    REQUIRE_FALSE(pool.IsInPlay(4));
+    REQUIRE(pool.GetNumbers() == vector<size_t>{0, 1, 2, 3});
+  }
+  SECTION("added out of order") {
+    pool.Add(Ball(9, Ball::striped, {0, 0}, {0, 0}));
+    pool.Add(Ball(3, Ball::solid, {0, 0}, {0, 0}));
+    REQUIRE(pool[9].GetBallNumber() == 9);
+    REQUIRE(pool[3].GetBallNumber() == 3);
+    REQUIRE_FALSE(pool.IsInPlay(5));
+    REQUIRE(pool.GetNumbers() == vector<size_t>{9, 3});
+  }
+  SECTION("numbers past the capacity") {
+    REQUIRE_FALSE(pool.IsInPlay(16));
+  }
+  SECTION("cleared") {
+    pool.Assign(MakeBalls(4));
+    pool.Clear();
+    REQUIRE(pool.GetCount() == 0);
+    REQUIRE_FALSE(pool.IsInPlay(1));
+  }
+}
+
+TEST_CASE("ball pool removes balls") {
+  BallPool pool = BallPool(6);
+  pool.Assign(MakeBalls(6));
+  const Ball &ball_5 = pool[5];
+  const Ball *storage = &pool[0];
+  SECTION("middle ball") {
+    pool.Remove(2);
+    REQUIRE(pool.GetCount() == 5);
+    REQUIRE_FALSE(pool.IsInPlay(2));
+    REQUIRE(pool.GetNumbers() == vector<size_t>{0, 1, 3, 4, 5});
+    // nothing moved into the gap
+    REQUIRE(&pool[5] == &ball_5);
+    REQUIRE(ball_5.GetBallNumber() == 5);
+    REQUIRE(ball_5.GetPosition() == dvec2(350, 400));
+  }
+  SECTION("neighbors in any order") {
+    pool.Remove(3);
+    pool.Remove(4);
+    pool.Remove(1);
+    REQUIRE(pool.GetNumbers() == vector<size_t>{0, 2, 5});
+    REQUIRE(pool[2].GetBallNumber() == 2);
+    REQUIRE(ball_5.GetPosition() == dvec2(350, 400));
+  }
+  SECTION("every ball") {
+    for (size_t number = 0; number < 6; number++) {
+      pool.Remove(number);
+    }
+    REQUIRE(pool.GetCount() == 0);
+    pool.Assign(MakeBalls(6));
+    REQUIRE(&pool[0] == storage);
+    REQUIRE(&pool[5] == &ball_5);
+  }
+}
+
+TEST_CASE("ball pool sleep flags") {
+  BallPool pool = BallPool(8);
+  pool.Assign(MakeBalls(4));
+  for (size_t number = 0; number < 4; number++) {
+    REQUIRE_FALSE(pool.IsAsleep(number));
+  }
+  pool.SetAsleep(3, true);
+  pool.Remove(1);
+  REQUIRE(pool.IsAsleep(3));
+  REQUIRE_FALSE(pool.IsAsleep(0));
+  REQUIRE_FALSE(pool.IsAsleep(2));
+  pool.Add(Ball(7, Ball::striped, {500, 500}, {0, 0}));
+  REQUIRE_FALSE(pool.IsAsleep(7));
+  REQUIRE(pool.IsAsleep(3));
+  pool.WakeAll();
+  REQUIRE_FALSE(pool.IsAsleep(3));
+}
+
+TEST_CASE("ball pool sleep version") {
+  BallPool pool = BallPool(8);
+  pool.Assign(MakeBalls(4));
+  size_t version = pool.GetSleepVersion();
+  pool.SetAsleep(2, false);
+  REQUIRE(pool.GetSleepVersion() == version);
+  pool.SetAsleep(2, true);
+  REQUIRE(pool.GetSleepVersion() != version);
+  version = pool.GetSleepVersion();
+  pool.SetAsleep(2, true);
+  REQUIRE(pool.GetSleepVersion() == version);
+  pool.Remove(1);
+  REQUIRE(pool.GetSleepVersion() != version);
+  version = pool.GetSleepVersion();
+  pool.WakeAll();
+  REQUIRE(pool.GetSleepVersion() != version);
+  version = pool.GetSleepVersion();
+  pool.Assign(MakeBalls(4));
+  REQUIRE(pool.GetSleepVersion() != version);
+}
+
+TEST_CASE("ball pool packed copies") {
+  BallPool pool = BallPool(8);
+  pool.Assign({Ball(4, Ball::solid, {10, 10}, {0, 0}),
+               Ball(0, Ball::cue, {20, 20}, {0, 0}),
+               Ball(2, Ball::solid, {30, 30}, {0, 0})});
+  vector<Ball> balls;
+  pool.GetBalls(balls);
+  REQUIRE(balls.size() == 3);
+  REQUIRE(balls[0].GetBallNumber() == 4);
+  REQUIRE(balls[2].GetBallNumber() == 2);
+  balls[0].SetPosition({40, 40});
+  balls.erase(balls.begin() + 1);
+  pool.Update(balls);
+  REQUIRE(pool[4].GetPosition() == dvec2(40, 40));
+  REQUIRE(pool[0].GetPosition() == dvec2(20, 20));
+  REQUIRE(pool.GetCount() == 3);
+}
+
+TEST_CASE("board removes neighboring scored balls") {
+  Board board = Board(1000);
+  // 1 and 2 are next to each other in the balls and both over the top left
+  // hole at (100, 250), 3 is over the bottom right hole at (900, 750)
+  double radius = Ball::GetDiameter() / 2;
+  dvec2 to_corner = {radius, radius};
+  board.SetPoolBalls(
+      {Ball(0, Ball::cue, dvec2(500, 500) - to_corner, {0, 0}),
+       Ball(1, Ball::solid, dvec2(100, 250) - to_corner, {0, 0}),
+       Ball(2, Ball::solid, dvec2(102, 252) - to_corner, {0, 0}),
+       Ball(4, Ball::solid, dvec2(400, 400) - to_corner, {0, 0}),
+       Ball(3, Ball::solid, dvec2(900, 750) - to_corner, {0, 0})});
+  SECTION("frame stepping") {
+    board.AdvanceOneFrame();
+  }
+  SECTION("event driven") {
+    board.SetSimulationMode(Board::event_driven);
+    board.AdvanceOneFrame();
+  }
+  const vector<Ball> &balls = board.GetPoolBalls();
+  REQUIRE(balls.size() == 2);
+  REQUIRE(balls[0].GetBallNumber() == 0);
+  REQUIRE(balls[1].GetBallNumber() == 4);
+  REQUIRE(board.GetPlayer().GetPlayerScore() == 3);
+}
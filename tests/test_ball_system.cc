@@ -0,0 +1,182 @@
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <cstdint>
+
+#include "ball_system.h"
+#include "board.h"
+using glm::dvec2;
+using pool::Ball;
+using pool::BallSystem;
+using pool::BasicBall;
+using pool::BasicBallSystem;
+using pool::Board;
+using std::pair;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Arrays are aligned and padded to the lane width
+ * Loading balls keeps positions
+ * Pair kernel finds touching balls whichever way they move and skips ones
+ * far apart or in padding lanes
+ * Float kernel, twice as many lanes wide, finds the pairs in every lane of
+ * a block
+ * Board with simd_all_pairs broad phase matches brute force
+ */
+
+namespace {
+/**
+ * Balls spread over the board, some touching the sides.
+ */
+vector<Ball> MakeTestBalls(const Board &board) {
+  double left = board.GetLeftXBoundary();
+  double right = board.GetRightXBoundary();
+  double top = board.GetTopYBoundary();
+  double bottom = board.GetBottomYBoundary();
+  double diameter = Ball::GetDiameter();
+  return {Ball(0, Ball::cue, {left + 100, top + 100}, {3.3, -2.2}),
+          Ball(1, Ball::solid, {left, top + 100}, {-1.5, 0.5}),
+          Ball(2, Ball::solid, {right - diameter, top + 100}, {1.5, 0.05}),
+          Ball(3, Ball::solid, {left + 100, top}, {-0.01, -4}),
+          Ball(4, Ball::solid, {left + 100, bottom - diameter}, {0, 4}),
+          Ball(5, Ball::solid, {left, top}, {-2, -2}),
+          Ball(6, Ball::solid, {left + 200, top + 200}, {0, 0})};
+}
+
+/**
+ * Number of pairs with the first ball.
+ */
+size_t CountPairsWithFirst(const vector<pair<size_t, size_t>> &pairs) {
+  size_t num_pairs = 0;
+  for (size_t k = 0; k < pairs.size(); k++) {
+    if (pairs[k].first == 0) {
+      num_pairs += 1;
+    }
+  }
+  return num_pairs;
+}
+}  // namespace
+
+TEST_CASE("ball system storage") {
+  Board board = Board(1000);
+  vector<Ball> balls = MakeTestBalls(board);
+  BallSystem system;
+  system.Load(balls);
+  SECTION("arrays are padded") {
+    REQUIRE(system.GetSize() == balls.size());
+    REQUIRE(system.GetPaddedSize() % BallSystem::kLaneWidth == 0);
+    REQUIRE(system.GetPaddedSize() >= balls.size());
+  }
+  SECTION("arrays are aligned") {
+    REQUIRE(reinterpret_cast<uintptr_t>(system.GetX()) %
+                BallSystem::kAlignment ==
+            0);
+    REQUIRE(reinterpret_cast<uintptr_t>(system.GetY()) %
+                BallSystem::kAlignment ==
+            0);
+  }
+  SECTION("load keeps positions") {
+    for (size_t i = 0; i < balls.size(); i++) {
+      REQUIRE(system.GetX()[i] == balls[i].GetPosition().x);
+      REQUIRE(system.GetY()[i] == balls[i].GetPosition().y);
+    }
+  }
+}
+
+TEST_CASE("ball system finds touching pairs") {
+  double diameter = Ball::GetDiameter();
+  vector<pair<size_t, size_t>> pairs;
+  BallSystem system;
+  SECTION("touching balls moving towards each other") {
+    system.Load({Ball(0, Ball::cue, {300, 400}, {2, 0}),
+                 Ball(1, Ball::solid, {300 + diameter - 1, 400}, {0, 0})});
+    system.FindTouchingPairs(pairs, diameter);
+    REQUIRE(pairs.size() == 1);
+    REQUIRE(pairs[0] == std::make_pair<size_t, size_t>(0, 1));
+  }
+  SECTION("touching balls moving apart") {
+    system.Load({Ball(0, Ball::cue, {300, 400}, {-2, 0}),
+                 Ball(1, Ball::solid, {300 + diameter - 1, 400}, {0, 0})});
+    system.FindTouchingPairs(pairs, diameter);
+    REQUIRE(pairs.size() == 1);
+  }
+  SECTION("far apart balls") {
+    system.Load({Ball(0, Ball::cue, {300, 400}, {2, 0}),
+                 Ball(1, Ball::solid, {300 + 2 * diameter, 400}, {0, 0})});
+    system.FindTouchingPairs(pairs, diameter);
+    REQUIRE(pairs.empty());
+  }
+  SECTION("padding lanes are never paired") {
+    // padding sits at the origin, a ball there would touch it
+    system.Load({Ball(0, Ball::cue, {0, 0}, {0, 0}),
+                 Ball(1, Ball::solid, {300, 400}, {0, 0}),
+                 Ball(2, Ball::solid, {0, 1}, {0, -1})});
+    system.FindTouchingPairs(pairs, diameter);
+    REQUIRE(pairs.size() == 1);
+    REQUIRE(pairs[0] == std::make_pair<size_t, size_t>(0, 2));
+  }
+  SECTION("every lane of a block") {
+    vector<Ball> balls = {Ball(0, Ball::cue, {300, 400}, {0, 0})};
+    for (size_t k = 1; k <= 9; k++) {
+      dvec2 offset = {diameter * std::cos(k * 0.6),
+                      diameter * std::sin(k * 0.6)};
+      balls.push_back(Ball(k, Ball::solid, dvec2(300, 400) + offset * 0.9,
+                           -offset));
+    }
+    system.Load(balls);
+    system.FindTouchingPairs(pairs, diameter);
+    REQUIRE(CountPairsWithFirst(pairs) == 9);
+  }
+}
+
+TEST_CASE("float ball system finds touching pairs") {
+  float diameter = Ball::GetDiameter();
+  BasicBallSystem<float> system;
+  REQUIRE(BasicBallSystem<float>::kLaneWidth == 2 * BallSystem::kLaneWidth);
+  vector<BasicBall<float>> block = {
+      BasicBall<float>(0, BasicBall<float>::cue, {300, 400}, {0, 0})};
+  for (size_t k = 1; k <= 17; k++) {
+    glm::vec2 offset = {diameter * std::cos(k * 0.35f),
+                        diameter * std::sin(k * 0.35f)};
+    block.push_back(BasicBall<float>(k, BasicBall<float>::solid,
+                                     glm::vec2(300, 400) + offset * 0.9f,
+                                     -offset));
+  }
+  system.Load(block);
+  REQUIRE(system.GetPaddedSize() % BasicBallSystem<float>::kLaneWidth == 0);
+  vector<pair<size_t, size_t>> pairs;
+  system.FindTouchingPairs(pairs, diameter);
+  REQUIRE(CountPairsWithFirst(pairs) == 17);
+}
+
+TEST_CASE("simd broad phase matches brute force") {
+  Board brute_force_board = Board(1000);
+  Board simd_board = Board(1000);
+  // compares the double pair search, fixed_point rounds the positions
+  brute_force_board.SetSimulationMode(Board::frame_stepping);
+  simd_board.SetSimulationMode(Board::frame_stepping);
+  simd_board.SetBroadPhase(Board::simd_all_pairs);
+  brute_force_board.CreatePoolBalls();
+  simd_board.CreatePoolBalls();
+  brute_force_board.UpdateStickLeft();
+  simd_board.UpdateStickLeft();
+  brute_force_board.HitCueBall();
+  simd_board.HitCueBall();
+  size_t brute_force_pairs = 0;
+  size_t simd_pairs = 0;
+  for (size_t frame = 0; frame < 200; frame++) {
+    brute_force_board.AdvanceOneFrame();
+    simd_board.AdvanceOneFrame();
+    brute_force_pairs += brute_force_board.GetCandidatePairCount();
+    simd_pairs += simd_board.GetCandidatePairCount();
+  }
+  vector<Ball> brute_force_balls = brute_force_board.GetPoolBalls();
+  vector<Ball> simd_balls = simd_board.GetPoolBalls();
+  REQUIRE(brute_force_balls.size() == simd_balls.size());
+  for (size_t i = 0; i < simd_balls.size(); i++) {
+    REQUIRE(simd_balls[i].GetPosition() == brute_force_balls[i].GetPosition());
+    REQUIRE(simd_balls[i].GetVelocity() == brute_force_balls[i].GetVelocity());
+  }
+  REQUIRE(simd_pairs < brute_force_pairs);
+}
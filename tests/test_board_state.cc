@@ -0,0 +1,127 @@
+#include <catch2/catch.hpp>
+#include <cstring>
+
+#include "board.h"
+#include "board_state.h"
+using glm::dvec2;
+using pool::Ball;
+using pool::Board;
+using pool::BoardState;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Restoring a saved board puts back balls, player, stick and flags
+ * A board played on from a restored state ends the same as the original
+ * State saved from one board can be restored into another
+ * State can be copied byte for byte
+ */
+
+TEST_CASE("board state round trip") {
+  Board board = Board(1000);
+  board.CreatePoolBalls();
+  board.UpdateStickRight();
+  board.PullStickBackForShot();
+  BoardState state = board.Save();
+  vector<Ball> saved_balls = board.GetPoolBalls();
+  REQUIRE(state.num_balls == saved_balls.size());
+  SECTION("balls restored") {
+    board.HitCueBall();
+    for (size_t frame = 0; frame < 20; frame++) {
+      board.AdvanceOneFrame();
+    }
+    REQUIRE(board.GetPoolBalls()[0].GetPosition() !=
+            saved_balls[0].GetPosition());
+    board.Restore(state);
+    vector<Ball> balls = board.GetPoolBalls();
+    REQUIRE(balls.size() == saved_balls.size());
+    for (size_t i = 0; i < balls.size(); i++) {
+      REQUIRE(balls[i].GetBallNumber() == saved_balls[i].GetBallNumber());
+      REQUIRE(balls[i].GetPosition() == saved_balls[i].GetPosition());
+      REQUIRE(balls[i].GetVelocity() == saved_balls[i].GetVelocity());
+      REQUIRE(balls[i].GetVelocityBoost() == saved_balls[i].GetVelocityBoost());
+    }
+    REQUIRE(board.GetStickVisibility());
+    REQUIRE(board.GetBallsPocketedThisShot().empty());
+  }
+  SECTION("stick restored") {
+    double angle = board.GetStick().GetAngle();
+    double pull = board.GetStick().GetPullBackDistance();
+    double line_length = board.GetAimLineLength();
+    board.UpdateStickLeft();
+    board.UpdateStickLeft();
+    board.PullStickBackForShot();
+    board.Restore(state);
+    REQUIRE(board.GetStick().GetAngle() == angle);
+    REQUIRE(board.GetStick().GetPullBackDistance() == pull);
+    REQUIRE(board.GetAimLineLength() == line_length);
+  }
+  SECTION("player restored") {
+    double left = board.GetLeftXBoundary();
+    double top = board.GetTopYBoundary();
+    // cue ball already rolling along the diagonal knocks ball 5 into the top
+    // left hole
+    board.SetPoolBalls({Ball(0, Ball::cue, {left + 120, top + 120}, {-5, -5}),
+                        Ball(5, Ball::striped, {left + 60, top + 60}, {0, 0})});
+    board.SetSimulationMode(Board::event_driven);
+    BoardState before_shot = board.Save();
+    board.SimulateUntilRest();
+    REQUIRE(board.GetPlayer().GetPlayerScore() == 1);
+    BoardState after_shot = board.Save();
+    REQUIRE(after_shot.num_ball_numbers_scored == 1);
+    REQUIRE(after_shot.ball_numbers_scored[0] == 5);
+
+    board.Restore(before_shot);
+    REQUIRE(board.GetPlayer().GetPlayerScore() == 0);
+    REQUIRE(board.GetPlayer().GetBallNumbers().empty());
+    REQUIRE(board.GetPlayer().GetBallTypeToScore() == Ball::cue);
+    REQUIRE(board.GetPoolBalls().size() == 2);
+    REQUIRE(board.GetPoolBalls()[0].GetVelocity() == dvec2(-5, -5));
+
+    board.Restore(after_shot);
+    REQUIRE(board.GetPlayer().GetPlayerScore() == 1);
+    REQUIRE(board.GetPlayer().GetBallNumbers() == vector<size_t>{5});
+    REQUIRE(board.GetPlayer().GetBallTypeToScore() == Ball::striped);
+    REQUIRE(board.GetBallsPocketedThisShot() == vector<size_t>{5});
+    REQUIRE(board.GetPoolBalls().size() == 1);
+  }
+}
+
+TEST_CASE("restored board plays the same") {
+  Board board = Board(1000);
+  board.CreatePoolBalls();
+  board.SetSimulationMode(Board::event_driven);
+  for (size_t i = 0; i < 3; i++) {
+    board.PullStickBackForShot();
+  }
+  board.HitCueBall();
+  // save partway through the shot
+  board.Advance(15);
+  BoardState state = board.Save();
+  Board other_board = Board(1000);
+  other_board.SetSimulationMode(Board::event_driven);
+  other_board.Restore(state);
+
+  board.SimulateUntilRest();
+  Board restored_board = Board(1000);
+  restored_board.SetSimulationMode(Board::event_driven);
+  // byte copies of the state are as good as the original
+  BoardState copied_state;
+  std::memcpy(&copied_state, &state, sizeof(BoardState));
+  restored_board.Restore(copied_state);
+  restored_board.SimulateUntilRest();
+  other_board.SimulateUntilRest();
+
+  vector<Ball> balls = board.GetPoolBalls();
+  vector<Ball> restored_balls = restored_board.GetPoolBalls();
+  vector<Ball> other_balls = other_board.GetPoolBalls();
+  REQUIRE(restored_balls.size() == balls.size());
+  REQUIRE(other_balls.size() == balls.size());
+  for (size_t i = 0; i < balls.size(); i++) {
+    REQUIRE(restored_balls[i].GetPosition() == balls[i].GetPosition());
+    REQUIRE(other_balls[i].GetPosition() == balls[i].GetPosition());
+  }
+  REQUIRE(restored_board.GetBallsPocketedThisShot() ==
+          board.GetBallsPocketedThisShot());
+  REQUIRE(restored_board.GetPlayerState() == board.GetPlayerState());
+}
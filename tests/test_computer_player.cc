@@ -0,0 +1,170 @@
+#include <catch2/catch.hpp>
+
+#include "board.h"
+#include "computer_player.h"
+using glm::dvec2;
+using pool::Ball;
+using pool::Board;
+using pool::BoardState;
+using pool::ComputerPlayer;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Outcomes score wins and losses above balls, balls above not scratching
+ * Player finds the shot that pockets a ball and avoids pocketing the cue ball
+ * Same seed gives the same shot whatever the number of threads
+ * Search stops at the time budget but always tries something
+ * Board searched from isn't changed
+ * Shots are simulated in the board's simulation mode, so a chosen shot
+ * played out frame by frame ends where it and PlayShot predicted
+ */
+
+namespace {
+/**
+ * Settings without noise that try every shot.
+ */
+ComputerPlayer::Settings MakeExactSettings(size_t num_threads) {
+  ComputerPlayer::Settings settings;
+  settings.num_angles = 72;
+  settings.num_powers = 2;
+  settings.samples_per_shot = 1;
+  settings.angle_noise = 0;
+  settings.power_noise = 0;
+  settings.time_budget_seconds = 60;
+  settings.num_threads = num_threads;
+  return settings;
+}
+}  // namespace
+
+TEST_CASE("computer player scores outcomes") {
+  Board board = Board(1000);
+  board.CreatePoolBalls();
+  BoardState before = board.Save();
+  BoardState after = before;
+  SECTION("nothing happens") {
+    REQUIRE(ComputerPlayer::ScoreOutcome(before, after) == 0);
+  }
+  SECTION("ball scored") {
+    after.player_score = 2;
+    REQUIRE(ComputerPlayer::ScoreOutcome(before, after) > 0);
+  }
+  SECTION("cue ball in hole") {
+    after.cue_in_hole = true;
+    REQUIRE(ComputerPlayer::ScoreOutcome(before, after) < 0);
+  }
+  SECTION("win and loss outweigh balls") {
+    after.player_score = 7;
+    double seven_balls = ComputerPlayer::ScoreOutcome(before, after);
+    after.game_state = pool::Player::won;
+    REQUIRE(ComputerPlayer::ScoreOutcome(before, after) > seven_balls);
+    after.game_state = pool::Player::lost;
+    REQUIRE(ComputerPlayer::ScoreOutcome(before, after) < 0);
+  }
+}
+
+TEST_CASE("computer player chooses shot") {
+  Board board = Board(1000);
+  double left = board.GetLeftXBoundary();
+  double top = board.GetTopYBoundary();
+  SECTION("pockets a ball") {
+    // ball 5 lines up with the top left hole along the diagonal
+    board.SetPoolBalls({Ball(0, Ball::cue, {left + 200, top + 200}, {0, 0}),
+                        Ball(5, Ball::striped, {left + 60, top + 60}, {0, 0})});
+    ComputerPlayer player = ComputerPlayer(MakeExactSettings(2), 1);
+    ComputerPlayer::Shot shot = player.ChooseShot(board);
+    REQUIRE(shot.candidates_tried == 144);
+    REQUIRE(shot.shots_simulated == 144);
+    REQUIRE(shot.shots_per_second > 0);
+    REQUIRE(shot.expected_score > 0);
+    Board::ShotResult result = board.SimulateShot(shot.angle, shot.power);
+    REQUIRE(result.player_score >= 1);
+    REQUIRE_FALSE(result.cue_in_hole);
+    // board searched from is left alone
+    REQUIRE(board.GetPoolBalls().size() == 2);
+    REQUIRE(board.GetPoolBalls()[0].GetVelocity() == dvec2(0, 0));
+    REQUIRE(board.GetStickVisibility());
+  }
+  SECTION("avoids pocketing the cue ball") {
+    board.SetPoolBalls(
+        {Ball(0, Ball::cue, {left + 60, top + 60}, {0, 0}),
+         Ball(5, Ball::striped, {left + 400, top + 200}, {0, 0})});
+    ComputerPlayer player = ComputerPlayer(MakeExactSettings(2), 1);
+    ComputerPlayer::Shot shot = player.ChooseShot(board);
+    REQUIRE(shot.expected_score >= 0);
+    REQUIRE_FALSE(board.SimulateShot(shot.angle, shot.power).cue_in_hole);
+  }
+}
+
+TEST_CASE("computer player search") {
+  Board board = Board(1000);
+  board.CreatePoolBalls();
+  SECTION("same shot with any number of threads") {
+    ComputerPlayer::Settings settings = MakeExactSettings(1);
+    settings.num_angles = 16;
+    settings.samples_per_shot = 2;
+    settings.angle_noise = 0.01;
+    settings.power_noise = 0.1;
+    ComputerPlayer::Shot one_thread =
+        ComputerPlayer(settings, 3).ChooseShot(board);
+    settings.num_threads = 4;
+    ComputerPlayer::Shot four_threads =
+        ComputerPlayer(settings, 3).ChooseShot(board);
+    REQUIRE(one_thread.angle == four_threads.angle);
+    REQUIRE(one_thread.power == four_threads.power);
+    REQUIRE(one_thread.expected_score == four_threads.expected_score);
+    REQUIRE(four_threads.shots_simulated == 64);
+  }
+  SECTION("time budget") {
+    ComputerPlayer::Settings settings = MakeExactSettings(2);
+    settings.num_angles = 3600;
+    settings.time_budget_seconds = 0;
+    ComputerPlayer::Shot shot = ComputerPlayer(settings, 3).ChooseShot(board);
+    REQUIRE(shot.candidates_tried >= 1);
+    REQUIRE(shot.candidates_tried <= 2);
+    REQUIRE(shot.shots_simulated == shot.candidates_tried);
+  }
+  SECTION("difficulties search more shots") {
+    ComputerPlayer::Settings easy =
+        ComputerPlayer::GetDifficultySettings(ComputerPlayer::easy);
+    ComputerPlayer::Settings hard =
+        ComputerPlayer::GetDifficultySettings(ComputerPlayer::hard);
+    REQUIRE(easy.num_angles * easy.num_powers * easy.samples_per_shot <
+            hard.num_angles * hard.num_powers * hard.samples_per_shot);
+    REQUIRE(easy.angle_noise > hard.angle_noise);
+    REQUIRE(ComputerPlayer(ComputerPlayer::hard).GetSettings().num_angles ==
+            hard.num_angles);
+  }
+}
+
+TEST_CASE("computer player predicts the table") {
+  Board board = Board(1000);
+  board.CreatePoolBalls();
+  SECTION("frame stepping") {
+    board.SetSimulationMode(Board::frame_stepping);
+  }
+  SECTION("fixed point") {
+    board.SetSimulationMode(Board::fixed_point);
+  }
+  ComputerPlayer::Settings settings = MakeExactSettings(2);
+  settings.num_angles = 16;
+  ComputerPlayer::Shot shot = ComputerPlayer(settings, 3).ChooseShot(board);
+  Board scratch = Board(1000);
+  Board::ShotResult result = board.PlayShot(shot.angle, shot.power, scratch);
+  BoardState before = board.Save();
+  board.HitCueBall(shot.angle, shot.power);
+  size_t frames = 0;
+  while (!board.GetStickVisibility() &&
+         board.GetPlayerState() == pool::Player::playing && frames < 10000) {
+    board.AdvanceOneFrame();
+    frames += 1;
+  }
+  REQUIRE(ComputerPlayer::ScoreOutcome(before, board.Save()) ==
+          shot.expected_score);
+  const vector<Ball> &balls = board.GetPoolBalls();
+  REQUIRE(result.balls.size() == balls.size());
+  for (size_t i = 0; i < balls.size(); i++) {
+    REQUIRE(result.balls[i].GetBallNumber() == balls[i].GetBallNumber());
+    REQUIRE(result.balls[i].GetPosition() == balls[i].GetPosition());
+  }
+}
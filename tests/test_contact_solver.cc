@@ -0,0 +1,310 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include "board.h"
+using glm::dvec2;
+using pool::Ball;
+using pool::Board;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Boards start with the sequential solver, and the break comes to rest no
+ * later with it than with the simultaneous solver
+ * With the simultaneous solver the break ends with every ball in the same
+ * place whatever order the balls are stored in, the sequential solver
+ * depends on the order
+ * Every broad phase gives the same result with the simultaneous solver
+ * A tightly packed rack hit at the apex has no balls moving into each other
+ * after one frame with the simultaneous solver, the sequential solver
+ * leaves some for later frames
+ * Same for the stock rack from CreatePoolBalls on the break: every ball is
+ * moving and none are moving into each other from the frame the cue ball
+ * reaches the rack, while the sequential solver takes several frames
+ * Balls pocketed in the same frame go through the rules in number order
+ * with the simultaneous solver and in fixed_point mode, so the last solid
+ * and the eight ball going down together win whatever order they are
+ * stored in, the sequential solver takes them in storage order
+ * A push into a resting chain reaches the end of the chain in one frame, the
+ * sequential solver only does when the chain is stored in order
+ */
+
+namespace {
+/**
+ * Board with the starting rack, the balls stored in the reverse order
+ * after the cue ball if reversed.
+ */
+Board MakeRack(Board::ContactSolver solver, bool reversed) {
+  Board board = Board(1000);
+  board.SetSimulationMode(Board::frame_stepping);
+  board.SetContactSolver(solver);
+  board.CreatePoolBalls();
+  if (reversed) {
+    vector<Ball> balls = board.GetPoolBalls();
+    std::reverse(balls.begin() + 1, balls.end());
+    board.SetPoolBalls(balls);
+  }
+  return board;
+}
+
+/**
+ * Hits the break and runs it until every ball stops.
+ * @return number of frames the break took.
+ */
+size_t PlayBreak(Board &board) {
+  board.HitCueBall(board.GetShotAngle(), Board::GetMaxShotPower());
+  size_t frames = 0;
+  while (!board.GetStickVisibility() && frames < 10000) {
+    board.AdvanceOneFrame();
+    frames += 1;
+  }
+  return frames;
+}
+
+/**
+ * Counts pairs of balls that are touching and moving into each other.
+ */
+size_t CountApproachingPairs(const Board &board) {
+  const vector<Ball> &balls = board.GetPoolBalls();
+  size_t count = 0;
+  for (size_t i = 0; i < balls.size(); i++) {
+    for (size_t j = i + 1; j < balls.size(); j++) {
+      dvec2 position_difference =
+          balls[i].GetPosition() - balls[j].GetPosition();
+      dvec2 velocity_difference =
+          balls[i].GetVelocity() - balls[j].GetVelocity();
+      if (glm::length(position_difference) <= Ball::GetDiameter() &&
+          glm::dot(position_difference, velocity_difference) < 0) {
+        count += 1;
+      }
+    }
+  }
+  return count;
+}
+
+/**
+ * Runs the break until every ball stops.
+ * @return number of frames from the one the cue ball reached the rack in
+ * to the last one ending with balls moving into each other, 0 if none do
+ * after it.
+ */
+size_t FramesToSeparate(Board &board) {
+  board.HitCueBall(board.GetShotAngle(), Board::GetMaxShotPower());
+  size_t frames = 0;
+  size_t contact_frame = 0;
+  size_t last_approaching_frame = 0;
+  while (!board.GetStickVisibility() && frames < 10000) {
+    board.AdvanceOneFrame();
+    frames += 1;
+    size_t num_moving = 0;
+    for (const Ball &ball : board.GetPoolBalls()) {
+      if (ball.GetVelocity() != dvec2(0, 0)) {
+        num_moving += 1;
+      }
+    }
+    if (contact_frame == 0 && num_moving > 1) {
+      contact_frame = frames;
+    }
+    if (contact_frame != 0 && CountApproachingPairs(board) > 0) {
+      last_approaching_frame = frames;
+    }
+  }
+  REQUIRE(contact_frame != 0);
+  return last_approaching_frame == 0 ? 0
+                                     : last_approaching_frame - contact_frame +
+                                           1;
+}
+
+/**
+ * Board with the cue ball rolling, the last solid and the eight ball over
+ * holes and the player one solid short of the eight ball, the eight ball
+ * stored first if eight_first.
+ */
+Board MakeLastSolidAndEight(Board::SimulationMode mode,
+                            Board::ContactSolver solver, bool eight_first) {
+  Board board = Board(1000);
+  board.SetSimulationMode(mode);
+  board.SetContactSolver(solver);
+  double radius = Ball::GetDiameter() / 2;
+  dvec2 to_corner = {radius, radius};
+  // over the top left and bottom right holes
+  Ball seven = Ball(7, Ball::solid, dvec2(100, 250) - to_corner, {0, 0});
+  Ball eight = Ball(8, Ball::eight, dvec2(900, 750) - to_corner, {0, 0});
+  vector<Ball> balls = {
+      Ball(0, Ball::cue, dvec2(500, 500) - to_corner, {1, 0}),
+      eight_first ? eight : seven, eight_first ? seven : eight,
+      Ball(12, Ball::striped, dvec2(300, 600) - to_corner, {0, 0})};
+  board.SetPoolBalls(balls);
+  pool::BoardState state = board.Save();
+  state.ball_type_to_score = Ball::solid;
+  state.num_ball_numbers_scored = 6;
+  for (size_t number = 1; number <= 6; number++) {
+    state.ball_numbers_scored[number - 1] = number;
+  }
+  state.player_score = 6;
+  board.Restore(state);
+  board.AdvanceOneFrame();
+  return board;
+}
+
+/**
+ * Checks if every ball on one board is in the same place on the other,
+ * finding balls by number.
+ */
+bool SameBalls(const Board &first, const Board &second) {
+  const vector<Ball> &first_balls = first.GetPoolBalls();
+  const vector<Ball> &second_balls = second.GetPoolBalls();
+  if (first_balls.size() != second_balls.size()) {
+    return false;
+  }
+  for (const Ball &ball : first_balls) {
+    auto same_number = [&ball](const Ball &other) {
+      return other.GetBallNumber() == ball.GetBallNumber();
+    };
+    auto other = std::find_if(second_balls.begin(), second_balls.end(),
+                              same_number);
+    if (other == second_balls.end() ||
+        other->GetPosition() != ball.GetPosition() ||
+        other->GetVelocity() != ball.GetVelocity()) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+TEST_CASE("sequential solver is the default") {
+  REQUIRE(Board(1000).GetContactSolver() == Board::sequential);
+  Board board = MakeRack(Board::sequential, false);
+  Board simultaneous_board = MakeRack(Board::simultaneous, false);
+  REQUIRE(PlayBreak(board) <= PlayBreak(simultaneous_board));
+}
+
+TEST_CASE("break doesn't depend on ball order") {
+  SECTION("simultaneous") {
+    Board board = MakeRack(Board::simultaneous, false);
+    Board reversed_board = MakeRack(Board::simultaneous, true);
+    PlayBreak(board);
+    PlayBreak(reversed_board);
+    REQUIRE(SameBalls(board, reversed_board));
+  }
+  SECTION("sequential resolves pairs in storage order") {
+    Board board = MakeRack(Board::sequential, false);
+    Board reversed_board = MakeRack(Board::sequential, true);
+    PlayBreak(board);
+    PlayBreak(reversed_board);
+    REQUIRE_FALSE(SameBalls(board, reversed_board));
+  }
+}
+
+TEST_CASE("simultaneous solver is the same for every broad phase") {
+  Board board = MakeRack(Board::simultaneous, false);
+  Board grid_board = MakeRack(Board::simultaneous, false);
+  grid_board.SetBroadPhase(Board::uniform_grid);
+  Board simd_board = MakeRack(Board::simultaneous, false);
+  simd_board.SetBroadPhase(Board::simd_all_pairs);
+  PlayBreak(board);
+  PlayBreak(grid_board);
+  PlayBreak(simd_board);
+  REQUIRE(SameBalls(board, grid_board));
+  REQUIRE(SameBalls(board, simd_board));
+}
+
+TEST_CASE("tight rack separates in the frame it is hit") {
+  // packed like the rack from MakeTriangle but a little tighter, so every
+  // ball overlaps its neighbours, with the cue ball touching the apex
+  Board board = Board(1000);
+  board.SetSimulationMode(Board::frame_stepping);
+  double diameter = Ball::GetDiameter() * 0.999;
+  double x = board.GetLeftXBoundary() + 400;
+  double y = board.GetTopYBoundary() + 250;
+  vector<Ball> balls = {Ball(0, Ball::cue, {x - diameter, y}, {5, 0})};
+  for (size_t column = 0; column < 5; column++) {
+    for (size_t row = 0; row <= column; row++) {
+      balls.push_back(Ball(balls.size(), Ball::solid,
+                           {x + column * diameter * std::sqrt(3.0) / 2,
+                            y + (row - column / 2.0) * diameter},
+                           {0, 0}));
+    }
+  }
+  SECTION("simultaneous") {
+    board.SetContactSolver(Board::simultaneous);
+    board.SetPoolBalls(balls);
+    board.AdvanceOneFrame();
+    REQUIRE(CountApproachingPairs(board) == 0);
+    for (const Ball &ball : board.GetPoolBalls()) {
+      REQUIRE(ball.GetVelocity() != dvec2(0, 0));
+    }
+  }
+  SECTION("sequential takes frames") {
+    board.SetPoolBalls(balls);
+    board.AdvanceOneFrame();
+    REQUIRE(CountApproachingPairs(board) > 0);
+  }
+}
+
+TEST_CASE("stock rack separates in the frame it is hit") {
+  Board board = MakeRack(Board::simultaneous, false);
+  Board sequential_board = MakeRack(Board::sequential, false);
+  REQUIRE(FramesToSeparate(board) == 0);
+  REQUIRE(FramesToSeparate(sequential_board) > 1);
+}
+
+TEST_CASE("balls pocketed together go through the rules in number order") {
+  SECTION("simultaneous") {
+    for (bool eight_first : {false, true}) {
+      Board board = MakeLastSolidAndEight(Board::frame_stepping,
+                                          Board::simultaneous, eight_first);
+      REQUIRE(board.GetPlayerState() == pool::Player::won);
+      REQUIRE(board.GetPlayer().GetPlayerScore() == 8);
+    }
+  }
+  SECTION("fixed point") {
+    for (bool eight_first : {false, true}) {
+      Board board = MakeLastSolidAndEight(Board::fixed_point,
+                                          Board::simultaneous, eight_first);
+      REQUIRE(board.GetPlayerState() == pool::Player::won);
+    }
+  }
+  SECTION("sequential takes them in storage order") {
+    Board board = MakeLastSolidAndEight(Board::frame_stepping,
+                                        Board::sequential, false);
+    Board eight_first = MakeLastSolidAndEight(Board::frame_stepping,
+                                              Board::sequential, true);
+    REQUIRE(board.GetPlayerState() == pool::Player::won);
+    REQUIRE(eight_first.GetPlayerState() == pool::Player::lost);
+  }
+}
+
+TEST_CASE("push goes through a resting chain in one frame") {
+  Board board = Board(1000);
+  board.SetSimulationMode(Board::frame_stepping);
+  double diameter = Ball::GetDiameter();
+  double x = board.GetLeftXBoundary() + 300;
+  double y = board.GetTopYBoundary() + 200;
+  // cue ball touching the first of three touching balls, moving into it
+  vector<Ball> balls = {Ball(0, Ball::cue, {x - diameter, y}, {2, 0})};
+  for (size_t i = 0; i < 3; i++) {
+    balls.push_back(Ball(i + 1, Ball::solid, {x + i * diameter, y}, {0, 0}));
+  }
+  SECTION("simultaneous") {
+    board.SetPoolBalls(balls);
+    board.AdvanceOneFrame();
+    const vector<Ball> &after = board.GetPoolBalls();
+    // equal masses head on, the last ball takes all the speed
+    REQUIRE(after[3].GetVelocity().x > 1.9);
+    REQUIRE(after[0].GetVelocity().x == Approx(0).margin(1e-9));
+    REQUIRE(after[1].GetVelocity().x == Approx(0).margin(1e-9));
+  }
+  SECTION("sequential with the chain stored back to front") {
+    // the far ball's pair with the middle ball is done before the middle
+    // ball is pushed
+    board.SetContactSolver(Board::sequential);
+    std::swap(balls[1], balls[3]);
+    board.SetPoolBalls(balls);
+    board.AdvanceOneFrame();
+    REQUIRE(board.GetPoolBalls()[1].GetVelocity().x == 0);
+  }
+}
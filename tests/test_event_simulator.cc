@@ -0,0 +1,286 @@
+#include <catch2/catch.hpp>
+
+#include "board.h"
+using glm::dvec2;
+using pool::Ball;
+using pool::Board;
+using pool::EventSimulator;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Closed form motion: ball slows down and stops at the friction deceleration
+ * Next event time and type for cushion, ball on ball, pocket and stopping
+ * Collision event resolves to the same velocities as the frame collision
+ * Board in event driven mode: balls stop, go in holes, shot needs far fewer
+ * events than frames and balls don't pass through each other
+ * Balls rolling along each other don't get stuck resolving the same contact
+ * Simulating a shot leaves the board alone and ends where hitting the cue
+ * ball and simulating until rest in event driven mode ends, whatever the
+ * board's mode, with pocketed balls and rules applied
+ * A scratch board reused for several shots gives the same results as a new
+ * one, and playing a shot ends where stepping it frame by frame ends
+ */
+
+TEST_CASE("closed form motion stops ball") {
+  Ball ball = Ball(0, Ball::cue, {100, 100}, {3.0, -1.5});
+  double deceleration = Ball::GetFrictionDeceleration();
+  SECTION("time until stopped per axis") {
+    REQUIRE(ball.GetTimeUntilStopped(0) == Approx(3.0 / deceleration));
+    REQUIRE(ball.GetTimeUntilStopped(1) == Approx(1.5 / deceleration));
+  }
+  SECTION("position follows parabola") {
+    double time = 10;
+    dvec2 position = ball.GetPositionAfter(time);
+    REQUIRE(position.x ==
+            Approx(100 + 3.0 * time - deceleration * time * time / 2));
+    REQUIRE(position.y ==
+            Approx(100 - 1.5 * time + deceleration * time * time / 2));
+  }
+  SECTION("ball doesn't move after stopping") {
+    ball.MoveFor(1000);
+    dvec2 no_velocity = {0, 0};
+    REQUIRE(ball.GetVelocity() == no_velocity);
+    double x_distance = 3.0 * 3.0 / (2 * deceleration);
+    REQUIRE(ball.GetPosition().x == Approx(100 + x_distance));
+  }
+}
+
+TEST_CASE("finds next event") {
+  Board board = Board(1000);
+  double left = board.GetLeftXBoundary();
+  double right = board.GetRightXBoundary();
+  double top = board.GetTopYBoundary();
+  double bottom = board.GetBottomYBoundary();
+  double diameter = Ball::GetDiameter();
+  const Board::HolePositions &holes = board.GetHolePositions();
+  EventSimulator simulator = EventSimulator(left, right, top, bottom, holes,
+                                            board.GetHoleRadius());
+  double middle_y = (top + bottom) / 2;
+  SECTION("ball comes to rest") {
+    vector<Ball> balls = {Ball(0, Ball::cue, {400, middle_y}, {0.5, 0})};
+    EventSimulator::Event event = simulator.FindNextEvent(balls, 1000);
+    REQUIRE(event.type == EventSimulator::came_to_rest);
+    REQUIRE(event.time == Approx(balls[0].GetTimeUntilStopped(0)));
+  }
+  SECTION("ball hits right side") {
+    vector<Ball> balls = {
+        Ball(0, Ball::cue, {right - diameter - 10, middle_y}, {5, 0})};
+    EventSimulator::Event event = simulator.FindNextEvent(balls, 1000);
+    REQUIRE(event.type == EventSimulator::cushion_collision);
+    REQUIRE(event.second == 0);
+    dvec2 position = balls[0].GetPositionAfter(event.time);
+    REQUIRE(position.x + diameter == Approx(right));
+  }
+  SECTION("balls moving towards each other collide") {
+    vector<Ball> balls = {Ball(0, Ball::cue, {300, middle_y}, {4, 0}),
+                          Ball(1, Ball::solid, {400, middle_y}, {0, 0})};
+    EventSimulator::Event event = simulator.FindNextEvent(balls, 1000);
+    REQUIRE(event.type == EventSimulator::ball_collision);
+    dvec2 position = balls[0].GetPositionAfter(event.time);
+    REQUIRE(400 - position.x == Approx(diameter));
+  }
+  SECTION("balls moving apart don't collide") {
+    vector<Ball> balls = {Ball(0, Ball::cue, {300, middle_y}, {-1, 0}),
+                          Ball(1, Ball::solid, {400, middle_y}, {1, 0})};
+    EventSimulator::Event event = simulator.FindNextEvent(balls, 1000);
+    REQUIRE(event.type != EventSimulator::ball_collision);
+  }
+  SECTION("ball goes into hole") {
+    double radius = diameter / 2;
+    vector<Ball> balls = {Ball(5, Ball::striped,
+                               {left + 60 - radius, top + 60 - radius},
+                               {-2, -2})};
+    EventSimulator::Event event = simulator.FindNextEvent(balls, 1000);
+    REQUIRE(event.type == EventSimulator::pocketed);
+    dvec2 center = balls[0].GetPositionAfter(event.time);
+    center.x += radius;
+    center.y += radius;
+    REQUIRE(glm::distance(center, dvec2(left, top)) ==
+            Approx(board.GetHoleRadius()));
+  }
+  SECTION("nothing happens before time limit") {
+    vector<Ball> balls = {Ball(0, Ball::cue, {400, middle_y}, {0.5, 0})};
+    EventSimulator::Event event = simulator.FindNextEvent(balls, 1);
+    REQUIRE(event.type == EventSimulator::no_event);
+    REQUIRE(event.time == 1);
+  }
+}
+
+TEST_CASE("collision event updates velocities") {
+  Board board = Board(1000);
+  double middle_y = (board.GetTopYBoundary() + board.GetBottomYBoundary()) / 2;
+  EventSimulator simulator = EventSimulator(
+      board.GetLeftXBoundary(), board.GetRightXBoundary(),
+      board.GetTopYBoundary(), board.GetBottomYBoundary(),
+      board.GetHolePositions(), board.GetHoleRadius());
+  vector<Ball> balls = {Ball(0, Ball::cue, {300, middle_y}, {4, 0}),
+                        Ball(1, Ball::solid, {400, middle_y}, {0, 0})};
+  EventSimulator::Event event = simulator.FindNextEvent(balls, 1000);
+  EventSimulator::AdvanceBalls(balls, event.time);
+  dvec2 cue_velocity = balls[0].GetVelocity();
+  EventSimulator::ResolveEvent(balls, event);
+  // head on collision swaps velocities
+  REQUIRE(balls[0].GetVelocity().x == Approx(0).margin(1e-9));
+  REQUIRE(balls[1].GetVelocity().x == Approx(cue_velocity.x));
+}
+
+TEST_CASE("board simulates shot with events") {
+  Board board = Board(1000);
+  double left = board.GetLeftXBoundary();
+  double top = board.GetTopYBoundary();
+  double bottom = board.GetBottomYBoundary();
+  double middle_y = (top + bottom) / 2;
+  board.SetSimulationMode(Board::event_driven);
+  SECTION("ball stops and stick is visible") {
+    Ball cue_ball = Ball(0, Ball::cue, {left + 60, middle_y}, {6, 2});
+    board.SetPoolBalls({cue_ball});
+    board.HitCueBall();
+    REQUIRE(board.SimulateUntilRest() > 0);
+    dvec2 no_velocity = {0, 0};
+    REQUIRE(board.GetPoolBalls()[0].GetVelocity() == no_velocity);
+    REQUIRE(board.GetStickVisibility());
+  }
+  SECTION("ball goes into hole") {
+    Ball cue_ball = Ball(0, Ball::cue, {600, middle_y}, {0, 0});
+    Ball ball = Ball(5, Ball::striped, {left + 40, top + 40}, {-2.3, -2.3});
+    board.SetPoolBalls({cue_ball, ball});
+    board.SimulateUntilRest();
+    REQUIRE(board.GetPoolBalls().size() == 1);
+    REQUIRE(board.GetPlayer().GetBallTypeToScore() == Ball::striped);
+  }
+  SECTION("advance one frame matches frame stepping for one ball") {
+    Ball ball = Ball(0, Ball::cue, {left + 60, middle_y}, {1.5, 0});
+    board.SetPoolBalls({ball});
+    board.AdvanceOneFrame();
+    Board stepped_board = Board(1000);
+    stepped_board.SetPoolBalls({ball});
+    stepped_board.AdvanceOneFrame();
+    REQUIRE(board.GetPoolBalls()[0].GetPosition().x ==
+            Approx(stepped_board.GetPoolBalls()[0].GetPosition().x)
+                .epsilon(1e-4));
+  }
+  SECTION("break shot needs few events and balls don't overlap") {
+    board.CreatePoolBalls();
+    for (size_t i = 0; i < 4; i++) {
+      board.PullStickBackForShot();
+    }
+    board.HitCueBall();
+    size_t num_events = board.SimulateUntilRest();
+    // frame stepping runs until the fastest ball stops, which is hundreds
+    // of frames
+    double frames = 9 / Ball::GetFrictionDeceleration();
+    REQUIRE(num_events < frames);
+    vector<Ball> balls = board.GetPoolBalls();
+    for (size_t i = 0; i < balls.size(); i++) {
+      for (size_t j = i + 1; j < balls.size(); j++) {
+        double distance =
+            glm::distance(balls[i].GetPosition(), balls[j].GetPosition());
+        REQUIRE(distance > Ball::GetDiameter() * 0.99);
+      }
+    }
+  }
+}
+
+TEST_CASE("board simulates shot without changing board") {
+  Board board = Board(1000);
+  double left = board.GetLeftXBoundary();
+  double top = board.GetTopYBoundary();
+  SECTION("same as hitting and simulating until rest") {
+    board.CreatePoolBalls();
+    board.SetSimulationMode(Board::frame_stepping);
+    Board played_board = board;
+    played_board.SetSimulationMode(Board::event_driven);
+    for (size_t i = 0; i < 4; i++) {
+      played_board.PullStickBackForShot();
+    }
+    double power = played_board.GetPoolBalls()[0].GetVelocityBoost();
+    REQUIRE(power <= Board::GetMaxShotPower());
+    played_board.HitCueBall();
+    played_board.SimulateUntilRest();
+    Board::ShotResult result = board.SimulateShot(board.GetShotAngle(), power);
+    vector<Ball> played_balls = played_board.GetPoolBalls();
+    REQUIRE(result.balls.size() == played_balls.size());
+    for (size_t i = 0; i < played_balls.size(); i++) {
+      REQUIRE(result.balls[i].GetPosition() == played_balls[i].GetPosition());
+      REQUIRE(result.balls[i].GetVelocity() == dvec2(0, 0));
+    }
+    REQUIRE(result.pocketed_ball_numbers ==
+            played_board.GetBallsPocketedThisShot());
+    REQUIRE(result.num_events > 0);
+    // board hasn't moved
+    REQUIRE(board.GetPoolBalls()[0].GetVelocity() == dvec2(0, 0));
+    REQUIRE(board.GetStickVisibility());
+  }
+  SECTION("ball pocketed") {
+    // cue ball hits ball 5 along the diagonal into the top left hole
+    board.SetPoolBalls({Ball(0, Ball::cue, {left + 120, top + 120}, {0, 0}),
+                        Ball(5, Ball::striped, {left + 60, top + 60}, {0, 0})});
+    Board::ShotResult result =
+        board.SimulateShot(M_PI / 4, Board::GetMaxShotPower());
+    REQUIRE(result.pocketed_ball_numbers.size() >= 1);
+    REQUIRE(result.pocketed_ball_numbers[0] == 5);
+    REQUIRE(result.ball_type_to_score == Ball::striped);
+    REQUIRE(result.player_score == 1);
+    REQUIRE(result.game_state == pool::Player::playing);
+  }
+  SECTION("balls rolling along each other") {
+    // this shot ends with the cue ball rolling along a ball it stopped
+    // against, which used to repeat the same collision until the event limit
+    board.CreatePoolBalls();
+    Board::ShotResult result = board.SimulateShot(M_PI / 2 + 0.66, 6);
+    REQUIRE(result.num_events < 1000);
+    for (size_t i = 0; i < result.balls.size(); i++) {
+      REQUIRE(result.balls[i].GetVelocity() == dvec2(0, 0));
+    }
+  }
+  SECTION("cue ball pocketed") {
+    board.SetPoolBalls({Ball(0, Ball::cue, {left + 60, top + 60}, {0, 0})});
+    Board::ShotResult result =
+        board.SimulateShot(M_PI / 4, Board::GetMinShotPower());
+    REQUIRE(result.pocketed_ball_numbers == vector<size_t>{0});
+    REQUIRE(result.cue_in_hole);
+    REQUIRE(result.balls.size() == 1);
+  }
+  SECTION("eight ball pocketed early loses") {
+    board.SetPoolBalls({Ball(0, Ball::cue, {left + 120, top + 120}, {0, 0}),
+                        Ball(8, Ball::eight, {left + 60, top + 60}, {0, 0})});
+    Board::ShotResult result =
+        board.SimulateShot(M_PI / 4, Board::GetMaxShotPower());
+    REQUIRE(result.game_state == pool::Player::lost);
+    REQUIRE(board.GetPlayerState() == pool::Player::playing);
+  }
+}
+
+TEST_CASE("board reuses a scratch board for shots") {
+  Board board = Board(1000);
+  board.CreatePoolBalls();
+  board.SetSimulationMode(Board::frame_stepping);
+  Board scratch = Board(1000);
+  SECTION("same results as a new scratch board") {
+    for (double angle : {M_PI / 2, M_PI / 3, M_PI / 2 + 0.1}) {
+      Board::ShotResult reused =
+          board.SimulateShot(angle, Board::GetMaxShotPower(), scratch);
+      Board::ShotResult fresh =
+          board.SimulateShot(angle, Board::GetMaxShotPower());
+      REQUIRE(reused.num_events == fresh.num_events);
+      REQUIRE(reused.pocketed_ball_numbers == fresh.pocketed_ball_numbers);
+      REQUIRE(reused.balls.size() == fresh.balls.size());
+      for (size_t i = 0; i < fresh.balls.size(); i++) {
+        REQUIRE(reused.balls[i].GetPosition() == fresh.balls[i].GetPosition());
+      }
+    }
+  }
+  SECTION("playing a shot steps frames") {
+    Board::ShotResult result =
+        board.PlayShot(M_PI / 2, Board::GetMaxShotPower(), scratch);
+    board.HitCueBall(M_PI / 2, Board::GetMaxShotPower());
+    size_t frames = board.SimulateUntilRest();
+    REQUIRE(result.num_events == frames);
+    vector<Ball> balls = board.GetPoolBalls();
+    REQUIRE(result.balls.size() == balls.size());
+    for (size_t i = 0; i < balls.size(); i++) {
+      REQUIRE(result.balls[i].GetPosition() == balls[i].GetPosition());
+    }
+  }
+}
@@ -0,0 +1,243 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "board.h"
+#include "fixed_point.h"
+using glm::dvec2;
+using pool::Ball;
+using pool::Board;
+using pool::Fixed;
+using pool::FixedBall;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Fixed point products and quotients round to the nearest step, halfway
+ * cases away from zero, and converting to double and back is exact
+ * Fixed point sine and cosine are within a few steps of std::sin/std::cos
+ * for angles of any size
+ * A ball loaded into fixed point and stored back is unchanged once its
+ * values are on the fixed point grid
+ * Collisions in fixed point keep the total velocity exactly, and balls
+ * with centers too close to have a direction between them don't collide
+ * A break in fixed_point mode comes to rest with every ball on the fixed
+ * point grid, in the same place whatever order the balls are stored in
+ * Replaying a saved shot gives the same bits, and SimulateUntilRest agrees
+ * with stepping frame by frame
+ * The break ends in a recorded checksum of every ball's position, which
+ * has to be the same for every compiler, optimization level and machine
+ * Every broad phase ends the break in the recorded checksum, and once balls
+ * sleep fewer pairs are checked than stepping every ball would
+ */
+
+namespace {
+// checksum of the positions at the end of the recorded break, changes only
+// when the fixed point physics themselves change
+constexpr uint64_t kRecordedBreakChecksum = 1137510150927316966u;
+
+/**
+ * Board with the starting rack in fixed_point mode, the balls stored in the
+ * reverse order after the cue ball if reversed.
+ */
+Board MakeFixedRack(bool reversed) {
+  Board board = Board(1000);
+  board.SetSimulationMode(Board::fixed_point);
+  board.CreatePoolBalls();
+  if (reversed) {
+    vector<Ball> balls = board.GetPoolBalls();
+    std::reverse(balls.begin() + 1, balls.end());
+    board.SetPoolBalls(balls);
+  }
+  return board;
+}
+
+/**
+ * Runs a board until every ball stops.
+ * @return number of frames.
+ */
+size_t RunUntilRest(Board &board) {
+  size_t frames = 0;
+  while (!board.GetStickVisibility() && frames < 10000) {
+    board.AdvanceOneFrame();
+    frames += 1;
+  }
+  return frames;
+}
+
+/**
+ * Mixes every ball's number and fixed point position, ordered by number, so
+ * storage order doesn't change it.
+ */
+uint64_t Checksum(const Board &board) {
+  vector<Ball> balls = board.GetPoolBalls();
+  std::sort(balls.begin(), balls.end(), [](const Ball &one, const Ball &two) {
+    return one.GetBallNumber() < two.GetBallNumber();
+  });
+  uint64_t checksum = 14695981039346656037u;
+  for (const Ball &ball : balls) {
+    uint64_t values[3] = {
+        ball.GetBallNumber(),
+        (uint64_t)Fixed::FromDouble(ball.GetPosition().x).GetRaw(),
+        (uint64_t)Fixed::FromDouble(ball.GetPosition().y).GetRaw()};
+    for (uint64_t value : values) {
+      checksum = (checksum ^ value) * 1099511628211u;
+    }
+  }
+  return checksum;
+}
+
+/**
+ * Checks if a double is a whole number of fixed point steps.
+ */
+bool IsOnGrid(double value) {
+  return Fixed::FromDouble(value).ToDouble() == value;
+}
+}  // namespace
+
+TEST_CASE("fixed point arithmetic") {
+  SECTION("exact values") {
+    REQUIRE(Fixed::FromDouble(1.5) * Fixed::FromDouble(2.25) ==
+            Fixed::FromDouble(3.375));
+    REQUIRE(Fixed::FromDouble(3.375) / Fixed::FromDouble(1.5) ==
+            Fixed::FromDouble(2.25));
+    REQUIRE(Fixed::FromDouble(-1.5) * Fixed::FromDouble(2) ==
+            Fixed::FromDouble(-3));
+    REQUIRE((Fixed::FromDouble(7) - Fixed::FromDouble(2.5)).ToDouble() == 4.5);
+  }
+  SECTION("rounding") {
+    Fixed two = Fixed::FromDouble(2);
+    // 1.5 steps rounds away from zero either way
+    REQUIRE((Fixed::FromRaw(3) / two).GetRaw() == 2);
+    REQUIRE((Fixed::FromRaw(-3) / two).GetRaw() == -2);
+    REQUIRE((Fixed::FromRaw(5) / Fixed::FromDouble(4)).GetRaw() == 1);
+    REQUIRE((Fixed::FromRaw(3) * Fixed::FromDouble(0.5)).GetRaw() == 2);
+    REQUIRE(Fixed::FromDouble(0.5 / Fixed::kOne).GetRaw() == 1);
+    REQUIRE(Fixed::FromDouble(-0.5 / Fixed::kOne).GetRaw() == -1);
+  }
+  SECTION("conversion") {
+    Fixed tenth = Fixed::FromDouble(0.1);
+    REQUIRE(std::abs(tenth.ToDouble() - 0.1) <= 0.5 / Fixed::kOne);
+    REQUIRE(Fixed::FromDouble(tenth.ToDouble()) == tenth);
+    REQUIRE(Fixed::FromRaw(Fixed::kOne).ToDouble() == 1);
+  }
+}
+
+TEST_CASE("fixed point sine and cosine") {
+  for (double angle = -20; angle <= 20; angle += 0.37) {
+    Fixed fixed_angle = Fixed::FromDouble(angle);
+    double rounded = fixed_angle.ToDouble();
+    INFO("angle " << angle);
+    REQUIRE(std::abs(Fixed::Sin(fixed_angle).ToDouble() - std::sin(rounded)) <
+            1e-5);
+    REQUIRE(std::abs(Fixed::Cos(fixed_angle).ToDouble() - std::cos(rounded)) <
+            1e-5);
+  }
+  REQUIRE(Fixed::Sin(Fixed()) == Fixed());
+  REQUIRE(Fixed::Cos(Fixed()) == Fixed::FromDouble(1));
+}
+
+TEST_CASE("fixed point ball") {
+  SECTION("load and store") {
+    Ball ball = Ball(5, Ball::solid, {300.25, 412.5}, {-1.75, 0.125});
+    Ball stored = ball;
+    FixedBall(ball).Store(stored);
+    REQUIRE(stored.GetPosition() == ball.GetPosition());
+    REQUIRE(stored.GetVelocity() == ball.GetVelocity());
+    REQUIRE(stored.GetBallNumber() == 5);
+  }
+  SECTION("collision keeps total velocity") {
+    FixedBall one = FixedBall(Ball(1, Ball::solid, {300, 300}, {3.1, 0.7}));
+    FixedBall two =
+        FixedBall(Ball(2, Ball::striped, {323.3, 307.1}, {-0.4, 0.2}));
+    Fixed total_x = one.GetVelocity().x + two.GetVelocity().x;
+    Fixed total_y = one.GetVelocity().y + two.GetVelocity().y;
+    REQUIRE(FixedBall::HandlePoolBallsColliding(one, two));
+    REQUIRE(one.GetVelocity().x + two.GetVelocity().x == total_x);
+    REQUIRE(one.GetVelocity().y + two.GetVelocity().y == total_y);
+    // now moving apart
+    REQUIRE_FALSE(FixedBall::HandlePoolBallsColliding(one, two));
+  }
+  SECTION("centers too close to collide") {
+    // 2^-12 apart, the squared distance rounds to zero steps
+    FixedBall one = FixedBall(Ball(1, Ball::solid, {300, 300}, {3, 0}));
+    FixedBall two =
+        FixedBall(Ball(2, Ball::striped, {300 + 1.0 / 4096, 300}, {0, 0}));
+    REQUIRE_FALSE(FixedBall::HandlePoolBallsColliding(one, two));
+    REQUIRE(one.GetVelocity().x == Fixed::FromDouble(3));
+    REQUIRE(two.GetVelocity().x == Fixed());
+  }
+  SECTION("friction stops the ball") {
+    FixedBall ball = FixedBall(Ball(0, Ball::cue, {300, 300}, {0.3, -5}));
+    size_t frames = 0;
+    while (ball.IsMoving() && frames < 1000) {
+      ball.DecreaseVelocity();
+      ball.Move();
+      frames += 1;
+    }
+    REQUIRE_FALSE(ball.IsMoving());
+    REQUIRE(frames > 10);
+  }
+}
+
+TEST_CASE("fixed point break") {
+  Board board = MakeFixedRack(false);
+  Board reversed = MakeFixedRack(true);
+  board.HitCueBall(board.GetShotAngle(), Board::GetMaxShotPower());
+  reversed.HitCueBall(reversed.GetShotAngle(), Board::GetMaxShotPower());
+  RunUntilRest(board);
+  RunUntilRest(reversed);
+  REQUIRE(board.GetStickVisibility());
+  REQUIRE(reversed.GetStickVisibility());
+  for (const Ball &ball : board.GetPoolBalls()) {
+    REQUIRE(IsOnGrid(ball.GetPosition().x));
+    REQUIRE(IsOnGrid(ball.GetPosition().y));
+    REQUIRE(ball.GetVelocity() == dvec2(0, 0));
+  }
+  REQUIRE(board.GetPoolBalls().size() == reversed.GetPoolBalls().size());
+  REQUIRE(Checksum(board) == Checksum(reversed));
+}
+
+TEST_CASE("fixed point replay") {
+  Board board = MakeFixedRack(false);
+  pool::BoardState rack = board.Save();
+  board.HitCueBall(1.1, Board::GetMaxShotPower() * 0.8);
+  size_t frames = RunUntilRest(board);
+
+  Board replay = Board(1000);
+  replay.SetSimulationMode(Board::fixed_point);
+  replay.Restore(rack);
+  replay.HitCueBall(1.1, Board::GetMaxShotPower() * 0.8);
+  REQUIRE(replay.SimulateUntilRest() == frames);
+  REQUIRE(Checksum(replay) == Checksum(board));
+  REQUIRE(replay.GetPlayerState() == board.GetPlayerState());
+}
+
+TEST_CASE("recorded fixed point break") {
+  Board board = MakeFixedRack(false);
+  board.HitCueBall(board.GetShotAngle(), Board::GetMaxShotPower());
+  RunUntilRest(board);
+  REQUIRE(Checksum(board) == kRecordedBreakChecksum);
+}
+
+TEST_CASE("fixed point break with every broad phase") {
+  for (Board::BroadPhase broad_phase :
+       {Board::brute_force, Board::uniform_grid, Board::simd_all_pairs}) {
+    Board board = MakeFixedRack(false);
+    board.SetBroadPhase(broad_phase);
+    board.HitCueBall(board.GetShotAngle(), Board::GetMaxShotPower());
+    size_t num_balls = board.GetPoolBalls().size();
+    size_t min_pair_count = num_balls * (num_balls - 1) / 2;
+    size_t frames = 0;
+    while (!board.GetStickVisibility() && frames < 10000) {
+      board.AdvanceOneFrame();
+      min_pair_count = std::min(min_pair_count,
+                                board.GetCandidatePairCount());
+      frames += 1;
+    }
+    REQUIRE(Checksum(board) == kRecordedBreakChecksum);
+    REQUIRE(min_pair_count == 0);
+  }
+}
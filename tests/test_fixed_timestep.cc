@@ -0,0 +1,144 @@
+#include <catch2/catch.hpp>
+
+#include "board.h"
+#include "fixed_timestep.h"
+using glm::dvec2;
+using pool::Ball;
+using pool::Board;
+using pool::FixedTimestep;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Time less than a step gives no steps and is carried over
+ * Time of several steps gives that many steps
+ * Leftover time sets the interpolation factor
+ * Updates needing more than the cap run the cap and drop the rest
+ * Negative time is ignored
+ * Same total time at different refresh rates gives the same steps
+ * Board Advance of whole frames matches AdvanceOneFrame, fractions of frames
+ * carry over, shots end the same at different physics rates
+ * Interpolated balls are between the previous and current positions, balls
+ * that jumped are not interpolated
+ */
+
+TEST_CASE("fixed timestep counts steps") {
+  FixedTimestep timestep = FixedTimestep(100, 8);
+  REQUIRE(timestep.GetStepSeconds() == Approx(0.01));
+  SECTION("less than a step") {
+    REQUIRE(timestep.Update(0.004) == 0);
+    REQUIRE(timestep.GetInterpolationFactor() == Approx(0.4));
+    REQUIRE(timestep.Update(0.007) == 1);
+    REQUIRE(timestep.GetInterpolationFactor() == Approx(0.1));
+  }
+  SECTION("several steps") {
+    REQUIRE(timestep.Update(0.035) == 3);
+    REQUIRE(timestep.GetInterpolationFactor() == Approx(0.5));
+  }
+  SECTION("more steps than the cap") {
+    REQUIRE(timestep.Update(0.5) == 8);
+    double leftover_seconds =
+        timestep.GetInterpolationFactor() * timestep.GetStepSeconds();
+    REQUIRE(timestep.GetDroppedSeconds() + leftover_seconds == Approx(0.42));
+    REQUIRE(timestep.GetInterpolationFactor() < 1);
+    REQUIRE(timestep.Update(0.01) == 1);
+  }
+  SECTION("negative time") {
+    timestep.Update(0.005);
+    REQUIRE(timestep.Update(-1) == 0);
+    REQUIRE(timestep.GetInterpolationFactor() == Approx(0.5));
+  }
+  SECTION("reset") {
+    timestep.Update(0.5);
+    timestep.Reset();
+    REQUIRE(timestep.GetDroppedSeconds() == 0);
+    REQUIRE(timestep.GetInterpolationFactor() == 0);
+  }
+}
+
+TEST_CASE("fixed timestep is independent of refresh rate") {
+  double refresh_rates[] = {30, 60, 144, 240};
+  for (double refresh_rate : refresh_rates) {
+    FixedTimestep timestep = FixedTimestep(50, 8);
+    size_t num_steps = 0;
+    size_t num_frames = (size_t)(refresh_rate * 10);
+    for (size_t frame = 0; frame < num_frames; frame++) {
+      num_steps += timestep.Update(1 / refresh_rate);
+    }
+    // ten seconds and half a step so rounding can't decide the last step
+    num_steps += timestep.Update(0.01);
+    REQUIRE(num_steps == 500);
+  }
+}
+
+TEST_CASE("board advance by fixed steps") {
+  Board frame_board = Board(1000);
+  Board step_board = Board(1000);
+  frame_board.CreatePoolBalls();
+  step_board.CreatePoolBalls();
+  frame_board.HitCueBall();
+  step_board.HitCueBall();
+  SECTION("whole frames") {
+    for (size_t frame = 0; frame < 100; frame++) {
+      frame_board.AdvanceOneFrame();
+      step_board.Advance(1);
+    }
+  }
+  SECTION("half frames") {
+    for (size_t frame = 0; frame < 100; frame++) {
+      frame_board.AdvanceOneFrame();
+      step_board.Advance(0.5);
+      step_board.Advance(0.5);
+    }
+  }
+  SECTION("several frames per step") {
+    for (size_t frame = 0; frame < 99; frame++) {
+      frame_board.AdvanceOneFrame();
+    }
+    for (size_t step = 0; step < 33; step++) {
+      step_board.Advance(3);
+    }
+  }
+  SECTION("step length with rounding") {
+    FixedTimestep timestep;
+    double frames_per_step = timestep.GetStepSeconds() / Ball::kSecondsPerFrame;
+    for (size_t frame = 0; frame < 100; frame++) {
+      frame_board.AdvanceOneFrame();
+      step_board.Advance(frames_per_step);
+    }
+  }
+  vector<Ball> frame_balls = frame_board.GetPoolBalls();
+  vector<Ball> step_balls = step_board.GetPoolBalls();
+  REQUIRE(frame_balls.size() == step_balls.size());
+  for (size_t i = 0; i < frame_balls.size(); i++) {
+    REQUIRE(step_balls[i].GetPosition() == frame_balls[i].GetPosition());
+    REQUIRE(step_balls[i].GetVelocity() == frame_balls[i].GetVelocity());
+  }
+}
+
+TEST_CASE("board interpolates between steps") {
+  Board board = Board(1000);
+  double left = board.GetLeftXBoundary();
+  double top = board.GetTopYBoundary();
+  board.SetPoolBalls({Ball(0, Ball::cue, {left + 100, top + 100}, {4, 0}),
+                      Ball(3, Ball::solid, {left + 300, top + 100}, {0, 0})});
+  board.Advance(1);
+  vector<Ball> current = board.GetPoolBalls();
+  SECTION("halfway") {
+    vector<Ball> balls = board.GetInterpolatedPoolBalls(0.5);
+    REQUIRE(balls[0].GetPosition().x ==
+            Approx((left + 100 + current[0].GetPosition().x) / 2));
+    REQUIRE(balls[1].GetPosition() == current[1].GetPosition());
+  }
+  SECTION("ends") {
+    REQUIRE(board.GetInterpolatedPoolBalls(0)[0].GetPosition().x ==
+            Approx(left + 100));
+    REQUIRE(board.GetInterpolatedPoolBalls(1)[0].GetPosition() ==
+            current[0].GetPosition());
+  }
+  SECTION("cue ball put back is not interpolated") {
+    board.RepositionCueBall({left + 600, top + 200});
+    vector<Ball> balls = board.GetInterpolatedPoolBalls(0.5);
+    REQUIRE(balls[0].GetPosition() == board.GetPoolBalls()[0].GetPosition());
+  }
+}
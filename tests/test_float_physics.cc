@@ -0,0 +1,146 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "board.h"
+using glm::dvec2;
+using pool::Ball;
+using pool::BasicBall;
+using pool::Board;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Converting a ball to float keeps its number, type and boost and rounds
+ * its position and velocity to the nearest float
+ * A rolling ball in float follows the double one's path to within a
+ * thousandth of a unit and stops on the same frame
+ * Shots from the rack, float balls stepped one at a time against Ball from
+ * the same start, stay within kMaxShotDivergence of each other for the
+ * whole shot on all but an occasional shot, where a grazing contact goes
+ * the other way, over a fixed set of shots
+ */
+
+namespace {
+// largest distance a ball in float is allowed to be from the same ball in
+// double at any frame of a shot, a hundredth of a ball
+constexpr double kMaxShotDivergence = Ball::kDiameter / 100;
+// shots of the set that may go past kMaxShotDivergence, one of the 50 does
+// by about 8
+constexpr size_t kMaxDivergedShots = 2;
+// frames every ball has stopped by after the hardest shot
+constexpr size_t kFramesPerShot = 1500;
+// number of shots in the recorded set
+constexpr size_t kNumShots = 50;
+
+struct Shot {
+  double angle;
+  double power;
+};
+
+/**
+ * Shots at every angle and power the player can hit from the starting rack,
+ * from a fixed seed so every run plays the same ones.
+ */
+vector<Shot> MakeRecordedShots() {
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+  std::uniform_real_distribution<double> power(Board::GetMinShotPower(),
+                                               Board::GetMaxShotPower());
+  vector<Shot> shots;
+  for (size_t i = 0; i < kNumShots; i++) {
+    Shot shot;
+    shot.angle = angle(generator);
+    shot.power = power(generator);
+    shots.push_back(shot);
+  }
+  return shots;
+}
+
+/**
+ * Balls of the starting rack just after the cue ball is hit.
+ */
+vector<Ball> HitRack(const Board &rack, const Shot &shot) {
+  Board board = rack;
+  board.HitCueBall(shot.angle, shot.power);
+  return board.GetPoolBalls();
+}
+
+/**
+ * Distance between a float ball and a double ball.
+ */
+double Distance(const BasicBall<float> &float_ball, const Ball &ball) {
+  return glm::length(dvec2(float_ball.GetPosition()) - ball.GetPosition());
+}
+}  // namespace
+
+TEST_CASE("ball converts to float") {
+  Ball ball = Ball(3, Ball::striped, {100.1, 200.2}, {1.3, -0.7});
+  ball.SetVelocityBoost(5.5);
+  BasicBall<float> float_ball = BasicBall<float>(ball);
+  REQUIRE(float_ball.GetBallNumber() == 3);
+  REQUIRE(float_ball.GetBallType() == BasicBall<float>::striped);
+  REQUIRE(float_ball.GetVelocityBoost() == 5.5f);
+  REQUIRE(float_ball.GetPosition() == glm::vec2(100.1f, 200.2f));
+  REQUIRE(float_ball.GetVelocity() == glm::vec2(1.3f, -0.7f));
+  Ball back = Ball(float_ball);
+  REQUIRE(back.GetPosition().x == Approx(100.1).epsilon(1e-6));
+  REQUIRE(back.GetVelocity().y == Approx(-0.7).epsilon(1e-6));
+}
+
+TEST_CASE("rolling ball in float") {
+  Ball ball = Ball(0, Ball::cue, {300, 400}, {0, 0});
+  ball.StickHit(0.3);
+  BasicBall<float> float_ball = BasicBall<float>(ball);
+  size_t frames = 0;
+  while (ball.GetVelocity() != dvec2(0, 0) && frames < 1000) {
+    ball.DecreaseVelocity();
+    ball.Move();
+    float_ball.DecreaseVelocity();
+    float_ball.Move();
+    frames += 1;
+    REQUIRE(Distance(float_ball, ball) < 1e-3);
+  }
+  REQUIRE(frames > 100);
+  REQUIRE(float_ball.GetVelocity() == glm::vec2(0, 0));
+}
+
+TEST_CASE("recorded shots with float balls") {
+  Board rack = Board(1000);
+  rack.CreatePoolBalls();
+  double left = rack.GetLeftXBoundary();
+  double right = rack.GetRightXBoundary();
+  double top = rack.GetTopYBoundary();
+  double bottom = rack.GetBottomYBoundary();
+  vector<double> divergences;
+  for (const Shot &shot : MakeRecordedShots()) {
+    vector<Ball> balls = HitRack(rack, shot);
+    vector<BasicBall<float>> float_balls(balls.begin(), balls.end());
+    double divergence = 0;
+    for (size_t frame = 0; frame < kFramesPerShot; frame++) {
+      for (size_t i = 0; i < balls.size(); i++) {
+        balls[i].HandleBoardCollision(right, left, top, bottom);
+        balls[i].DecreaseVelocity();
+        float_balls[i].HandleBoardCollision(right, left, top, bottom);
+        float_balls[i].DecreaseVelocity();
+        for (size_t j = i + 1; j < balls.size(); j++) {
+          Ball::HandlePoolBallsColliding(balls[i], balls[j]);
+          BasicBall<float>::HandlePoolBallsColliding(float_balls[i],
+                                                     float_balls[j]);
+        }
+        balls[i].Move();
+        float_balls[i].Move();
+      }
+      for (size_t i = 0; i < balls.size(); i++) {
+        divergence = std::max(divergence, Distance(float_balls[i], balls[i]));
+      }
+    }
+    divergences.push_back(divergence);
+  }
+  std::sort(divergences.begin(), divergences.end());
+  REQUIRE(divergences[kNumShots - kMaxDivergedShots - 1] <
+          kMaxShotDivergence);
+  REQUIRE(divergences[kNumShots / 2] < kMaxShotDivergence / 10);
+}
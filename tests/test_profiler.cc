@@ -0,0 +1,241 @@
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "board.h"
+#include "profiler.h"
+using pool::Board;
+using pool::Profiler;
+using pool::ScopedProfilerPause;
+using pool::ScopedTimer;
+using std::string;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Nothing is recorded while the profiler is off
+ * Scopes and counters add up per frame, stats give the last frame, average
+ * and worst frame over the history, scopes before counters
+ * History only keeps the last kHistoryFrames frames
+ * Scopes can be recorded from several threads
+ * A paused thread records nothing until its outermost pause ends, other
+ * threads keep recording
+ * Chrome trace has every scope and frame counter, and only the newest
+ * kMaxTraceEvents once full
+ * Board records its physics scopes and collision pairs to the shared
+ * profiler, but not for shots it only simulates
+ */
+
+namespace {
+/**
+ * Finds the stats with a name.
+ */
+const Profiler::Stats &FindStats(const vector<Profiler::Stats> &stats,
+                                 const string &name) {
+  for (const Profiler::Stats &named_stats : stats) {
+    if (name == named_stats.name) {
+      return named_stats;
+    }
+  }
+  FAIL("no stats named " << name);
+  return stats[0];
+}
+
+size_t CountOccurrences(const string &text, const string &part) {
+  size_t count = 0;
+  for (size_t i = text.find(part); i != string::npos;
+       i = text.find(part, i + 1)) {
+    count += 1;
+  }
+  return count;
+}
+}  // namespace
+
+TEST_CASE("profiler off") {
+  Profiler profiler;
+  REQUIRE_FALSE(profiler.IsEnabled());
+  { ScopedTimer timer("off/scope", profiler); }
+  profiler.RecordScope("off/scope", 0, 10);
+  profiler.AddCount("off/count", 1);
+  profiler.EndFrame();
+  REQUIRE(profiler.GetStats().empty());
+  std::stringstream trace;
+  profiler.WriteChromeTrace(trace);
+  REQUIRE(trace.str().find("off/") == string::npos);
+}
+
+TEST_CASE("profiler stats") {
+  Profiler profiler;
+  profiler.SetEnabled(true);
+  SECTION("frame totals") {
+    // 2 ms then 4 ms frames, the second one in two parts
+    profiler.RecordScope("test/scope", 0, 2000000);
+    profiler.AddCount("test/count", 5);
+    profiler.EndFrame();
+    profiler.RecordScope("test/scope", 0, 1000000);
+    profiler.RecordScope("test/scope", 0, 3000000);
+    profiler.AddCount("test/count", 1);
+    profiler.AddCount("test/count", 2);
+    profiler.EndFrame();
+    vector<Profiler::Stats> stats = profiler.GetStats();
+    REQUIRE(stats.size() == 2);
+    // scopes come before counters
+    REQUIRE_FALSE(stats[0].is_counter);
+    REQUIRE(stats[1].is_counter);
+    const Profiler::Stats &scope = FindStats(stats, "test/scope");
+    REQUIRE(scope.last == Approx(4));
+    REQUIRE(scope.average == Approx(3));
+    REQUIRE(scope.worst == Approx(4));
+    const Profiler::Stats &count = FindStats(stats, "test/count");
+    REQUIRE(count.last == 3);
+    REQUIRE(count.average == 4);
+    REQUIRE(count.worst == 5);
+  }
+  SECTION("frames without a scope count as 0") {
+    profiler.RecordScope("test/scope", 0, 6000000);
+    profiler.EndFrame();
+    profiler.EndFrame();
+    vector<Profiler::Stats> stats = profiler.GetStats();
+    const Profiler::Stats &scope = FindStats(stats, "test/scope");
+    REQUIRE(scope.last == 0);
+    REQUIRE(scope.average == Approx(3));
+    REQUIRE(scope.worst == Approx(6));
+  }
+  SECTION("history is rolling") {
+    profiler.RecordScope("test/scope", 0, 100000000);
+    profiler.EndFrame();
+    for (size_t i = 0; i < Profiler::kHistoryFrames; i++) {
+      profiler.RecordScope("test/scope", 0, 1000000);
+      profiler.EndFrame();
+    }
+    vector<Profiler::Stats> stats = profiler.GetStats();
+    const Profiler::Stats &scope = FindStats(stats, "test/scope");
+    REQUIRE(scope.average == Approx(1));
+    REQUIRE(scope.worst == Approx(1));
+  }
+  SECTION("scoped timer") {
+    {
+      ScopedTimer timer("test/timer", profiler);
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    profiler.EndFrame();
+    REQUIRE(FindStats(profiler.GetStats(), "test/timer").last >= 2);
+  }
+  SECTION("threads") {
+    std::thread other([&profiler]() {
+      for (size_t i = 0; i < 1000; i++) {
+        profiler.RecordScope("test/thread", 0, 1000);
+      }
+    });
+    for (size_t i = 0; i < 1000; i++) {
+      profiler.RecordScope("test/thread", 0, 1000);
+    }
+    other.join();
+    profiler.EndFrame();
+    REQUIRE(FindStats(profiler.GetStats(), "test/thread").last ==
+            Approx(2));
+  }
+  SECTION("clear") {
+    profiler.RecordScope("test/scope", 0, 1000);
+    profiler.EndFrame();
+    profiler.Clear();
+    REQUIRE(profiler.GetStats().empty());
+  }
+}
+
+TEST_CASE("profiler pause") {
+  Profiler profiler;
+  profiler.SetEnabled(true);
+  {
+    ScopedProfilerPause pause;
+    REQUIRE(profiler.IsEnabled());
+    REQUIRE_FALSE(profiler.IsRecording());
+    {
+      ScopedProfilerPause inner_pause;
+      profiler.RecordScope("test/paused", 0, 1000);
+    }
+    // still in the outer pause
+    REQUIRE_FALSE(profiler.IsRecording());
+    { ScopedTimer timer("test/paused", profiler); }
+    profiler.AddCount("test/paused count", 1);
+    bool other_recording = false;
+    std::thread other([&profiler, &other_recording]() {
+      other_recording = profiler.IsRecording();
+      profiler.RecordScope("test/other thread", 0, 1000);
+    });
+    other.join();
+    REQUIRE(other_recording);
+  }
+  REQUIRE(profiler.IsRecording());
+  profiler.RecordScope("test/resumed", 0, 1000);
+  profiler.EndFrame();
+  vector<Profiler::Stats> stats = profiler.GetStats();
+  REQUIRE(stats.size() == 2);
+  REQUIRE(string(stats[0].name) == "test/other thread");
+  REQUIRE(string(stats[1].name) == "test/resumed");
+}
+
+TEST_CASE("profiler chrome trace") {
+  Profiler profiler;
+  profiler.SetEnabled(true);
+  SECTION("scopes and counters") {
+    profiler.RecordScope("test/\"quoted\"", 1500, 4000);
+    profiler.AddCount("test/count", 7);
+    profiler.EndFrame();
+    std::stringstream stream;
+    profiler.WriteChromeTrace(stream);
+    string trace = stream.str();
+    REQUIRE(trace.find("{\"traceEvents\":[") == 0);
+    REQUIRE(trace.find("\"name\":\"test/\\\"quoted\\\"\"") != string::npos);
+    REQUIRE(trace.find("\"ph\":\"X\",\"ts\":1.500,\"dur\":2.500") !=
+            string::npos);
+    REQUIRE(trace.find("\"ph\":\"C\"") != string::npos);
+    REQUIRE(trace.find("\"args\":{\"value\":7}") != string::npos);
+  }
+  SECTION("only the newest events") {
+    for (size_t i = 0; i < Profiler::kMaxTraceEvents + 10; i++) {
+      profiler.RecordScope("test/scope", i * 1000, i * 1000 + 1);
+    }
+    std::stringstream stream;
+    profiler.WriteChromeTrace(stream);
+    string trace = stream.str();
+    REQUIRE(CountOccurrences(trace, "test/scope") ==
+            Profiler::kMaxTraceEvents);
+    // oldest kept event is first
+    REQUIRE(trace.find("\"ts\":10.000") < trace.find("\"ts\":11.000"));
+    REQUIRE(trace.find("\"ts\":9.000,") == string::npos);
+  }
+}
+
+TEST_CASE("board profiling") {
+  Profiler &profiler = Profiler::GetInstance();
+  profiler.Clear();
+  profiler.SetEnabled(true);
+  Board board = Board(1000);
+  board.SetSimulationMode(Board::frame_stepping);
+  board.CreatePoolBalls();
+  // simulating a shot that isn't played records nothing
+  board.SimulateShot(board.GetShotAngle(), Board::GetMaxShotPower());
+  profiler.EndFrame();
+  bool simulated_shot_recorded = !profiler.GetStats().empty();
+  board.HitCueBall(board.GetShotAngle(), Board::GetMaxShotPower());
+  for (size_t i = 0; i < 10; i++) {
+    board.AdvanceOneFrame();
+  }
+  profiler.EndFrame();
+  profiler.SetEnabled(false);
+  vector<Profiler::Stats> stats = profiler.GetStats();
+  profiler.Clear();
+  REQUIRE_FALSE(simulated_shot_recorded);
+#ifdef POOL_DISABLE_PROFILER
+  REQUIRE(stats.empty());
+#else
+  REQUIRE(FindStats(stats, "physics/frame").last > 0);
+  // every ball is awake for the first frame and brute force checks every
+  // pair, then the rest sleep while only the cue ball rolls towards them
+  REQUIRE(FindStats(stats, "physics/collision pairs").last == 120);
+  REQUIRE(FindStats(stats, "physics/awake balls").last == 16 + 9);
+#endif
+}
@@ -0,0 +1,422 @@
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "replay.h"
+#include "replay_writer.h"
+#include "simulation_thread.h"
+using glm::dvec2;
+using pool::Ball;
+using pool::Board;
+using pool::BoardState;
+using pool::FixedTimestep;
+using pool::Replay;
+using pool::ReplayWriter;
+using pool::SimulationThread;
+using std::string;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Replays written and read back are exactly the same, files that aren't
+ * replays or have values out of range are rejected and files cut short keep
+ * the inputs before the cut
+ * Files are written as version 3, versions 1 and 2 are still read and later
+ * versions are rejected
+ * Values too big for their field aren't written
+ * Games recorded by the simulation thread and written by the writer thread
+ * play back to exactly the same balls, in both simulation modes and with
+ * steps that aren't whole frames
+ * Replay command plays the current game back on the simulation thread
+ * Each game goes to its own file
+ * Keyframes are recorded every interval, match the board when the game is
+ * played through and seeking from them gives the same board as simulating
+ * from the start while simulating less than an interval
+ */
+
+namespace {
+// short so a test game has a few keyframes
+uint64_t const kKeyframeInterval = 50;
+
+/**
+ * Requires every ball to be exactly the same.
+ */
+void RequireSameBalls(const vector<Ball> &balls, const vector<Ball> &others) {
+  REQUIRE(balls.size() == others.size());
+  for (size_t i = 0; i < balls.size(); i++) {
+    REQUIRE(balls[i].GetBallNumber() == others[i].GetBallNumber());
+    REQUIRE(balls[i].GetPosition() == others[i].GetPosition());
+    REQUIRE(balls[i].GetVelocity() == others[i].GetVelocity());
+  }
+}
+
+/**
+ * Runs the simulation until the balls stop after a shot.
+ */
+void RunUntilRest(SimulationThread &simulation, double step_seconds) {
+  for (size_t i = 0; i < 100000; i++) {
+    simulation.RunOnce(step_seconds);
+    const Board &board = simulation.GetLatestSnapshot().board;
+    if (board.GetStickVisibility() && !simulation.IsPlayingBack()) {
+      return;
+    }
+  }
+  FAIL("balls never stopped");
+}
+
+/**
+ * Requires every ball and the player's progress to be exactly the same.
+ */
+void RequireSameState(const BoardState &state, const Board &board) {
+  RequireSameBalls(vector<Ball>(state.balls, state.balls + state.num_balls),
+                   board.GetPoolBalls());
+  REQUIRE(state.player_score == board.GetPlayer().GetPlayerScore());
+  REQUIRE(state.game_state == board.GetPlayerState());
+  REQUIRE(state.stick_visible == board.GetStickVisibility());
+}
+
+/**
+ * Plays a few shots on a fresh game, recording to writer.
+ */
+Board PlayGame(Board::SimulationMode mode, double steps_per_second,
+               ReplayWriter &writer) {
+  Board board = Board(1000);
+  board.SetSimulationMode(mode);
+  FixedTimestep timestep = FixedTimestep(steps_per_second, 8);
+  SimulationThread simulation(board, timestep);
+  simulation.SetReplayWriter(&writer);
+  simulation.SetKeyframeInterval(kKeyframeInterval);
+  simulation.Send(SimulationThread::reset);
+  simulation.RunOnce(0);
+  double step_seconds = timestep.GetStepSeconds();
+  for (size_t shot = 0; shot < 3; shot++) {
+    for (size_t i = 0; i <= shot; i++) {
+      simulation.Send(SimulationThread::rotate_left);
+      simulation.Send(SimulationThread::pull_back);
+    }
+    simulation.Send(SimulationThread::hit);
+    // ignored while the balls are rolling, so not recorded
+    simulation.Send(SimulationThread::hit);
+    RunUntilRest(simulation, step_seconds * 3);
+  }
+  simulation.SendShot(M_PI / 3, Board::GetMaxShotPower());
+  RunUntilRest(simulation, step_seconds);
+  return simulation.GetLatestSnapshot().board;
+}
+}  // namespace
+
+TEST_CASE("replay file") {
+  Board board = Board(1000);
+  board.CreatePoolBalls();
+  Replay replay = Replay(board, 2.0 / 3);
+  replay.AddInput({Replay::shot, 10, 0.1 + 0.2, 6.123456789, {0, 0}});
+  replay.AddInput({Replay::cue_position, 250, 0, 0, {300.1, 400.7}});
+  replay.AddInput({Replay::cue_placement, 250, 0, 0, {301.3, 1e-300}});
+  std::stringstream stream;
+  REQUIRE(replay.Write(stream));
+  string data = stream.str();
+  // header of 16 balls, records start after it
+  size_t const header_size = 15 + 16 * 18;
+  SECTION("read back exactly") {
+    Replay read;
+    REQUIRE(read.Read(stream));
+    REQUIRE(read.GetFramesPerStep() == 2.0 / 3);
+    REQUIRE(read.GetSimulationMode() == board.GetSimulationMode());
+    RequireSameBalls(read.GetInitialBalls(), board.GetPoolBalls());
+    REQUIRE(read.GetInputs().size() == 3);
+    for (size_t i = 0; i < 3; i++) {
+      const Replay::Input &input = read.GetInputs()[i];
+      const Replay::Input &original = replay.GetInputs()[i];
+      REQUIRE(input.type == original.type);
+      REQUIRE(input.step == original.step);
+      REQUIRE(input.angle == original.angle);
+      REQUIRE(input.power == original.power);
+      REQUIRE(input.position == original.position);
+    }
+  }
+  SECTION("small") {
+    // 21 bytes an input
+    REQUIRE(data.size() == header_size + 3 * 21);
+  }
+  SECTION("not a replay") {
+    std::stringstream other("PRE");
+    Replay read;
+    REQUIRE_FALSE(read.Read(other));
+    data[0] = 'X';
+    std::stringstream bad_magic(data);
+    REQUIRE_FALSE(read.Read(bad_magic));
+  }
+  SECTION("version") {
+    REQUIRE(data[4] == 3);
+    Replay read;
+    for (char version = 1; version <= 3; version++) {
+      string versioned = data;
+      versioned[4] = version;
+      std::stringstream versioned_stream(versioned);
+      REQUIRE(read.Read(versioned_stream));
+      REQUIRE(read.GetInputs().size() == 3);
+    }
+    string newer = data;
+    newer[4] = 4;
+    std::stringstream newer_stream(newer);
+    REQUIRE_FALSE(read.Read(newer_stream));
+  }
+  SECTION("cut short") {
+    std::stringstream cut(data.substr(0, data.size() - 5));
+    Replay read;
+    REQUIRE(read.Read(cut));
+    REQUIRE(read.GetInputs().size() == 2);
+  }
+  SECTION("values out of range") {
+    Replay read;
+    string bad_mode = data;
+    bad_mode[5] = 3;
+    std::stringstream bad_mode_stream(bad_mode);
+    REQUIRE_FALSE(read.Read(bad_mode_stream));
+    string bad_ball_type = data;
+    bad_ball_type[16] = 4;
+    std::stringstream bad_ball_type_stream(bad_ball_type);
+    REQUIRE_FALSE(read.Read(bad_ball_type_stream));
+    string bad_record = data;
+    bad_record[header_size] = 4;
+    std::stringstream bad_record_stream(bad_record);
+    REQUIRE_FALSE(read.Read(bad_record_stream));
+  }
+  SECTION("keyframe out of range") {
+    Replay keyframed = Replay(board, 1);
+    keyframed.AddKeyframe({300, board.Save()});
+    std::stringstream keyframe_stream;
+    REQUIRE(keyframed.Write(keyframe_stream));
+    string keyframe_data = keyframe_stream.str();
+    Replay read;
+    std::stringstream cut(keyframe_data.substr(0, keyframe_data.size() - 1));
+    REQUIRE(read.Read(cut));
+    REQUIRE(read.GetKeyframes().empty());
+    // type of the keyframe's first ball
+    keyframe_data[header_size + 7] = 4;
+    std::stringstream bad(keyframe_data);
+    REQUIRE_FALSE(read.Read(bad));
+  }
+  SECTION("values too big to write") {
+    std::stringstream output;
+    vector<Ball> balls = board.GetPoolBalls();
+    balls[3] = Ball(256, Ball::solid, {300, 300}, {0, 0});
+    REQUIRE_FALSE(Replay::WriteHeader(output, Board::frame_stepping, 1,
+                                      balls));
+    REQUIRE_FALSE(Replay::WriteHeader(
+        output, Board::frame_stepping, 1,
+        vector<Ball>(256, board.GetPoolBalls()[0])));
+    Replay::Input far = {Replay::shot, 250 + (uint64_t(1) << 32), 0, 1,
+                         {0, 0}};
+    REQUIRE_FALSE(Replay::WriteInput(output, far, 250));
+    REQUIRE_FALSE(Replay::WriteInput(output, far, far.step + 1));
+    Replay::Keyframe keyframe = {far.step, board.Save()};
+    REQUIRE_FALSE(Replay::WriteKeyframe(output, keyframe, 250));
+    keyframe.step = 300;
+    keyframe.state.player_score = uint64_t(1) << 32;
+    REQUIRE_FALSE(Replay::WriteKeyframe(output, keyframe, 250));
+    REQUIRE(output.str().empty());
+    Replay too_far = replay;
+    too_far.AddInput(far);
+    std::stringstream too_far_stream;
+    REQUIRE_FALSE(too_far.Write(too_far_stream));
+    // the records before it are still written
+    REQUIRE(too_far_stream.str() == data);
+  }
+}
+
+TEST_CASE("recorded games play back exactly") {
+  string prefix = "test_replay_game_";
+  ReplayWriter writer(prefix);
+  writer.Start();
+  SECTION("frame stepping") {
+    Board played = PlayGame(Board::frame_stepping, 90, writer);
+    writer.Stop();
+    std::ifstream file(writer.GetPath(0), std::ios::binary);
+    Replay replay;
+    REQUIRE(replay.Read(file));
+    REQUIRE(replay.GetInputs().size() == 4);
+    REQUIRE(replay.GetFramesPerStep() ==
+            Approx(1 / (90 * Ball::kSecondsPerFrame)));
+    Board board = Board(1000);
+    replay.Play(board);
+    RequireSameBalls(board.GetPoolBalls(), played.GetPoolBalls());
+    REQUIRE(board.GetPlayer().GetPlayerScore() ==
+            played.GetPlayer().GetPlayerScore());
+  }
+  SECTION("event driven") {
+    Board played = PlayGame(Board::event_driven, 45, writer);
+    writer.Stop();
+    std::ifstream file(writer.GetPath(0), std::ios::binary);
+    Replay replay;
+    REQUIRE(replay.Read(file));
+    Board board = Board(1000);
+    replay.Play(board);
+    REQUIRE(board.GetSimulationMode() == Board::event_driven);
+    RequireSameBalls(board.GetPoolBalls(), played.GetPoolBalls());
+  }
+  writer.Stop();
+  std::remove(writer.GetPath(0).c_str());
+}
+
+TEST_CASE("simulation thread plays back") {
+  ReplayWriter writer("test_replay_thread_");
+  writer.Start();
+  Board board = Board(1000);
+  FixedTimestep timestep = FixedTimestep(60, 8);
+  SimulationThread simulation(board, timestep);
+  simulation.SetReplayWriter(&writer);
+  simulation.Send(SimulationThread::reset);
+  simulation.Send(SimulationThread::pull_back);
+  simulation.Send(SimulationThread::hit);
+  RunUntilRest(simulation, 1.0 / 60);
+  simulation.Send(SimulationThread::rotate_right);
+  simulation.Send(SimulationThread::hit);
+  RunUntilRest(simulation, 1.0 / 60);
+  vector<Ball> played = simulation.GetLatestSnapshot().board.GetPoolBalls();
+  SECTION("replay command") {
+    simulation.Send(SimulationThread::replay);
+    simulation.RunOnce(0);
+    REQUIRE(simulation.IsPlayingBack());
+    // input is ignored while playing back
+    simulation.Send(SimulationThread::rotate_left);
+    RunUntilRest(simulation, 1.0 / 60);
+    RequireSameBalls(simulation.GetLatestSnapshot().board.GetPoolBalls(),
+                     played);
+    // played back game is recorded again so play can go on from it
+    writer.Stop();
+    REQUIRE(writer.GetGameCount() == 2);
+    std::remove(writer.GetPath(1).c_str());
+  }
+  SECTION("loaded replay") {
+    writer.Stop();
+    std::ifstream file(writer.GetPath(0), std::ios::binary);
+    Replay replay;
+    REQUIRE(replay.Read(file));
+    SimulationThread other(Board(1000), timestep);
+    REQUIRE(other.LoadReplay(replay));
+    REQUIRE(other.IsPlayingBack());
+    RunUntilRest(other, 1.0 / 60);
+    RequireSameBalls(other.GetLatestSnapshot().board.GetPoolBalls(), played);
+    other.Start();
+    REQUIRE_FALSE(other.LoadReplay(replay));
+    other.Stop();
+  }
+  writer.Stop();
+  std::remove(writer.GetPath(0).c_str());
+}
+
+TEST_CASE("replay writer files") {
+  ReplayWriter writer("test_replay_writer_");
+  writer.Start();
+  Board board = Board(1000);
+  board.CreatePoolBalls();
+  REQUIRE_FALSE(writer.Record({Replay::shot, 0, 1, 1, {0, 0}}));
+  REQUIRE(writer.BeginGame(board, 1));
+  REQUIRE(writer.Record({Replay::shot, 5, 1, 2, {0, 0}}));
+  board.SetPoolBalls({board.GetPoolBalls()[0]});
+  REQUIRE(writer.BeginGame(board, 0.5));
+  REQUIRE(writer.Record({Replay::shot, 7, 3, 4, {0, 0}}));
+  REQUIRE(writer.Record({Replay::cue_placement, 9, 0, 0, {5, 6}}));
+  writer.Stop();
+  REQUIRE(writer.GetGameCount() == 2);
+  REQUIRE(writer.GetDroppedCount() == 1);
+  Replay first;
+  Replay second;
+  std::ifstream first_file(writer.GetPath(0), std::ios::binary);
+  std::ifstream second_file(writer.GetPath(1), std::ios::binary);
+  REQUIRE(first.Read(first_file));
+  REQUIRE(second.Read(second_file));
+  REQUIRE(first.GetInitialBalls().size() == 16);
+  REQUIRE(first.GetInputs().size() == 1);
+  REQUIRE(first.GetInputs()[0].step == 5);
+  REQUIRE(second.GetInitialBalls().size() == 1);
+  REQUIRE(second.GetFramesPerStep() == 0.5);
+  REQUIRE(second.GetInputs().size() == 2);
+  REQUIRE(second.GetInputs()[1].step == 9);
+  REQUIRE(second.GetInputs()[1].position == dvec2(5, 6));
+  first_file.close();
+  second_file.close();
+  std::remove(writer.GetPath(0).c_str());
+  std::remove(writer.GetPath(1).c_str());
+}
+
+TEST_CASE("replay keyframes") {
+  ReplayWriter writer("test_replay_keyframes_");
+  writer.Start();
+  Board played = PlayGame(Board::frame_stepping, 70, writer);
+  writer.Stop();
+  std::ifstream file(writer.GetPath(0), std::ios::binary);
+  Replay replay;
+  REQUIRE(replay.Read(file));
+  file.close();
+  std::remove(writer.GetPath(0).c_str());
+  // the test plays faster than the writer thread wakes up, so some
+  // keyframes may have been dropped
+  const vector<Replay::Keyframe> &keyframes = replay.GetKeyframes();
+  REQUIRE_FALSE(keyframes.empty());
+  Board board = Board(1000);
+  Replay rebuilt = replay;
+  rebuilt.BuildKeyframes(board, kKeyframeInterval);
+  const vector<Replay::Keyframe> &all_keyframes = rebuilt.GetKeyframes();
+  REQUIRE(all_keyframes.size() > 3);
+  SECTION("recorded every interval") {
+    for (size_t i = 0; i < all_keyframes.size(); i++) {
+      REQUIRE(all_keyframes[i].step == (i + 1) * kKeyframeInterval);
+    }
+    for (size_t i = 0; i < keyframes.size(); i++) {
+      REQUIRE(keyframes[i].step % kKeyframeInterval == 0);
+      REQUIRE((i == 0 || keyframes[i].step > keyframes[i - 1].step));
+    }
+  }
+  SECTION("same as playing through") {
+    for (const Replay::Keyframe &keyframe : keyframes) {
+      size_t index = keyframe.step / kKeyframeInterval - 1;
+      REQUIRE(index < all_keyframes.size());
+      Board rebuilt_board = Board(1000);
+      rebuilt_board.Restore(all_keyframes[index].state);
+      RequireSameState(keyframe.state, rebuilt_board);
+    }
+  }
+  SECTION("seek matches simulating from the start") {
+    Replay without_keyframes = replay;
+    without_keyframes.BuildKeyframes(board, 0);
+    REQUIRE(without_keyframes.GetKeyframes().empty());
+    uint64_t last = all_keyframes.back().step;
+    for (uint64_t step : {uint64_t(0), uint64_t(1), kKeyframeInterval - 1,
+                          kKeyframeInterval, kKeyframeInterval + 7,
+                          3 * kKeyframeInterval + 13, last, last + 20}) {
+      Board seeked = Board(1000);
+      REQUIRE(rebuilt.Seek(seeked, step) < kKeyframeInterval);
+      Board simulated = Board(1000);
+      REQUIRE(without_keyframes.Seek(simulated, step) == step);
+      RequireSameState(seeked.Save(), simulated);
+      // recorded keyframes give the same board
+      Board recorded = Board(1000);
+      replay.Seek(recorded, step);
+      RequireSameState(recorded.Save(), simulated);
+    }
+  }
+  SECTION("seek to the end") {
+    uint64_t num_steps = replay.Play(board);
+    Board seeked = Board(1000);
+    replay.Seek(seeked, num_steps);
+    RequireSameBalls(seeked.GetPoolBalls(), played.GetPoolBalls());
+  }
+  SECTION("written and read back") {
+    std::stringstream stream;
+    REQUIRE(replay.Write(stream));
+    Replay read;
+    REQUIRE(read.Read(stream));
+    REQUIRE(read.GetInputs().size() == replay.GetInputs().size());
+    REQUIRE(read.GetKeyframes().size() == keyframes.size());
+    for (size_t i = 0; i < keyframes.size(); i++) {
+      Board read_board = Board(1000);
+      read_board.Restore(read.GetKeyframes()[i].state);
+      REQUIRE(read.GetKeyframes()[i].step == keyframes[i].step);
+      RequireSameState(keyframes[i].state, read_board);
+    }
+  }
+}
@@ -0,0 +1,199 @@
+#include <catch2/catch.hpp>
+
+#include <thread>
+
+#include "simulation_thread.h"
+using pool::Board;
+using pool::FixedTimestep;
+using pool::SimulationThread;
+using pool::SpscQueue;
+using pool::TripleBuffer;
+
+/**
+ * Testing strategy:
+ * Queue gives items back in order, refuses items when full and keeps working
+ * after its indices wrap around the storage
+ * Queue passes every item in order from one thread to another
+ * Triple buffer reader sees nothing new until published, then the latest
+ * value, and the reader's value doesn't change while the writer writes
+ * Triple buffer reader never sees values go backwards across threads
+ * Simulation applies commands, steps the board and publishes it, shots
+ * sent while a shot is rolling are ignored
+ * Simulation thread steps on its own once started and stops
+ */
+
+TEST_CASE("spsc queue") {
+  SpscQueue<int, 4> queue;
+  int item = 0;
+  SECTION("empty queue") {
+    REQUIRE_FALSE(queue.TryPop(item));
+  }
+  SECTION("items come out in order") {
+    REQUIRE(queue.TryPush(1));
+    REQUIRE(queue.TryPush(2));
+    REQUIRE(queue.TryPop(item));
+    REQUIRE(item == 1);
+    REQUIRE(queue.TryPop(item));
+    REQUIRE(item == 2);
+    REQUIRE(queue.GetSize() == 0);
+  }
+  SECTION("full queue") {
+    for (int i = 0; i < 4; i++) {
+      REQUIRE(queue.TryPush(i));
+    }
+    REQUIRE_FALSE(queue.TryPush(4));
+    REQUIRE(queue.GetSize() == 4);
+  }
+  SECTION("wrapping around") {
+    for (int i = 0; i < 10; i++) {
+      REQUIRE(queue.TryPush(i));
+      REQUIRE(queue.TryPush(i + 100));
+      REQUIRE(queue.TryPop(item));
+      REQUIRE(item == i);
+      REQUIRE(queue.TryPop(item));
+      REQUIRE(item == i + 100);
+    }
+  }
+}
+
+TEST_CASE("spsc queue between threads") {
+  SpscQueue<size_t, 64> queue;
+  size_t const kNumItems = 100000;
+  std::thread producer([&queue, kNumItems]() {
+    for (size_t i = 0; i < kNumItems; i++) {
+      while (!queue.TryPush(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  size_t expected = 0;
+  bool in_order = true;
+  while (expected < kNumItems) {
+    size_t item = 0;
+    if (queue.TryPop(item)) {
+      in_order = in_order && item == expected;
+      expected += 1;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  REQUIRE(in_order);
+}
+
+TEST_CASE("triple buffer") {
+  TripleBuffer<int> buffer(0);
+  SECTION("nothing published") {
+    REQUIRE_FALSE(buffer.Update());
+    REQUIRE(buffer.Read() == 0);
+  }
+  SECTION("latest value wins") {
+    buffer.GetWriteBuffer() = 1;
+    buffer.Publish();
+    buffer.GetWriteBuffer() = 2;
+    buffer.Publish();
+    REQUIRE(buffer.Update());
+    REQUIRE(buffer.Read() == 2);
+    REQUIRE_FALSE(buffer.Update());
+  }
+  SECTION("reader value kept while writing") {
+    buffer.GetWriteBuffer() = 1;
+    buffer.Publish();
+    buffer.Update();
+    for (int i = 2; i < 10; i++) {
+      buffer.GetWriteBuffer() = i;
+      buffer.Publish();
+      REQUIRE(buffer.Read() == 1);
+    }
+    buffer.Update();
+    REQUIRE(buffer.Read() == 9);
+  }
+}
+
+TEST_CASE("triple buffer between threads") {
+  TripleBuffer<size_t> buffer(0);
+  size_t const kLastValue = 100000;
+  std::thread writer([&buffer, kLastValue]() {
+    for (size_t i = 1; i <= kLastValue; i++) {
+      buffer.GetWriteBuffer() = i;
+      buffer.Publish();
+    }
+  });
+  size_t previous = 0;
+  bool in_order = true;
+  while (previous < kLastValue) {
+    if (buffer.Update()) {
+      in_order = in_order && buffer.Read() >= previous;
+      previous = buffer.Read();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  writer.join();
+  REQUIRE(in_order);
+}
+
+TEST_CASE("simulation applies commands and steps") {
+  Board board = Board(1000);
+  FixedTimestep timestep = FixedTimestep(100, 8);
+  SimulationThread simulation(board, timestep);
+  REQUIRE(simulation.GetLatestSnapshot().board.GetPoolBalls().empty());
+  simulation.Send(SimulationThread::reset);
+  SECTION("commands are published without a step") {
+    REQUIRE(simulation.RunOnce(0) == 0);
+    REQUIRE(simulation.GetLatestSnapshot().board.GetPoolBalls().size() == 16);
+  }
+  SECTION("hit and step") {
+    simulation.Send(SimulationThread::rotate_left);
+    simulation.Send(SimulationThread::hit);
+    REQUIRE(simulation.RunOnce(0.025) == 2);
+    const SimulationThread::Snapshot &snapshot =
+        simulation.GetLatestSnapshot();
+    REQUIRE(snapshot.step == 2);
+    REQUIRE_FALSE(snapshot.board.GetStickVisibility());
+    REQUIRE(snapshot.board.GetPoolBalls()[0].GetVelocity() != glm::dvec2(0, 0));
+  }
+  SECTION("shoot") {
+    simulation.SendShot(M_PI, Board::GetMaxShotPower());
+    // a second shot while the first is rolling is ignored
+    simulation.SendShot(0, Board::GetMaxShotPower());
+    simulation.RunOnce(0);
+    const SimulationThread::Snapshot &snapshot =
+        simulation.GetLatestSnapshot();
+    REQUIRE_FALSE(snapshot.board.GetStickVisibility());
+    glm::dvec2 velocity = snapshot.board.GetPoolBalls()[0].GetVelocity();
+    REQUIRE(velocity.x == Approx(Board::GetMaxShotPower()));
+    REQUIRE(velocity.y == Approx(0).margin(1e-9));
+  }
+  SECTION("nothing new is not published") {
+    simulation.RunOnce(0.01);
+    simulation.GetLatestSnapshot();
+    simulation.RunOnce(0.001);
+    REQUIRE(simulation.GetLatestSnapshot().step == 1);
+  }
+  SECTION("interpolation factor") {
+    simulation.RunOnce(0.01);
+    double factor =
+        simulation.GetInterpolationFactor(simulation.GetLatestSnapshot());
+    REQUIRE(factor >= 0);
+    REQUIRE(factor <= 1);
+  }
+}
+
+TEST_CASE("simulation thread runs on its own") {
+  Board board = Board(1000);
+  SimulationThread simulation(board, FixedTimestep(500, 8));
+  simulation.Send(SimulationThread::reset);
+  simulation.Send(SimulationThread::hit);
+  simulation.Start();
+  // give up after a few seconds so a broken thread fails instead of hanging
+  size_t const kMaxWaits = 3000;
+  size_t num_waits = 0;
+  while (simulation.GetLatestSnapshot().step < 10 && num_waits < kMaxWaits) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    num_waits += 1;
+  }
+  simulation.Stop();
+  REQUIRE(simulation.GetLatestSnapshot().step >= 10);
+  REQUIRE_FALSE(simulation.GetLatestSnapshot().board.GetStickVisibility());
+}
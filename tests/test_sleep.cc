@@ -0,0 +1,210 @@
+#include <catch2/catch.hpp>
+
+#include "board.h"
+using glm::dvec2;
+using pool::Ball;
+using pool::Board;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Shots come out exactly the same as stepping every ball every frame with
+ * either contact solver, for shots into the rack and for a chain of resting
+ * balls hit end on
+ * Once the other balls sleep only the moving ones are checked for
+ * collisions, and a ball reaching a resting chain wakes the whole chain
+ * A ball fast enough to go from more than a grid cell away to touching a
+ * sleeping ball in one frame wakes it the next frame
+ * Balls placed or hit from outside the physics wake up: a sleeping cue ball
+ * dragged into a hole is pocketed and a sleeping cue ball can be hit
+ */
+
+namespace {
+/**
+ * Frame stepping without sleeping for the sequential contact solver, the
+ * way every ball was stepped before balls could sleep, for balls that stay
+ * away from the holes.
+ */
+void StepEveryBallInOrder(const Board &board, vector<Ball> &balls) {
+  for (size_t i = 0; i < balls.size(); i++) {
+    balls[i].HandleBoardCollision(
+        board.GetRightXBoundary(), board.GetLeftXBoundary(),
+        board.GetTopYBoundary(), board.GetBottomYBoundary());
+    balls[i].DecreaseVelocity();
+    for (size_t j = i + 1; j < balls.size(); j++) {
+      Ball::HandlePoolBallsColliding(balls[i], balls[j]);
+    }
+    balls[i].Move();
+  }
+}
+
+/**
+ * Frame stepping without sleeping for the simultaneous contact solver, for
+ * balls in ball number order that stay away from the holes.
+ */
+void StepEveryBallTogether(const Board &board, vector<Ball> &balls) {
+  for (Ball &ball : balls) {
+    ball.HandleBoardCollision(
+        board.GetRightXBoundary(), board.GetLeftXBoundary(),
+        board.GetTopYBoundary(), board.GetBottomYBoundary());
+    ball.DecreaseVelocity();
+  }
+  for (size_t sweep = 0; sweep < Board::kMaxContactIterations; sweep++) {
+    bool resolved_any = false;
+    for (size_t i = 0; i < balls.size(); i++) {
+      for (size_t j = i + 1; j < balls.size(); j++) {
+        if (Ball::HandlePoolBallsColliding(balls[i], balls[j])) {
+          resolved_any = true;
+        }
+      }
+    }
+    if (!resolved_any) {
+      break;
+    }
+  }
+  for (Ball &ball : balls) {
+    ball.Move();
+  }
+}
+
+/**
+ * Runs a board until every ball stops and checks every frame against
+ * stepping every ball with the board's contact solver.
+ * @return number of frames run.
+ */
+size_t RequireSameAsSteppingEveryBall(Board &board) {
+  vector<Ball> expected = board.GetPoolBalls();
+  size_t frames = 0;
+  while (!board.GetStickVisibility() && frames < 10000) {
+    board.AdvanceOneFrame();
+    if (board.GetContactSolver() == Board::sequential) {
+      StepEveryBallInOrder(board, expected);
+    } else {
+      StepEveryBallTogether(board, expected);
+    }
+    frames += 1;
+    const vector<Ball> &balls = board.GetPoolBalls();
+    REQUIRE(balls.size() == expected.size());
+    for (size_t i = 0; i < balls.size(); i++) {
+      REQUIRE(balls[i].GetPosition() == expected[i].GetPosition());
+      REQUIRE(balls[i].GetVelocity() == expected[i].GetVelocity());
+    }
+  }
+  REQUIRE(board.GetStickVisibility());
+  return frames;
+}
+
+/**
+ * Cue ball with a line of resting balls to its right, each touching the
+ * next.
+ */
+vector<Ball> MakeChain(const Board &board, size_t chain_length) {
+  double diameter = Ball::GetDiameter();
+  double y = board.GetTopYBoundary() + 200;
+  double x = board.GetLeftXBoundary() + 300;
+  vector<Ball> balls = {
+      Ball(0, Ball::cue, {board.GetLeftXBoundary() + 100, y}, {0, 0})};
+  for (size_t i = 0; i < chain_length; i++) {
+    balls.push_back(Ball(i + 1, Ball::solid, {x + i * diameter, y}, {0, 0}));
+  }
+  return balls;
+}
+}  // namespace
+
+TEST_CASE("sleeping balls don't change shots") {
+  for (Board::ContactSolver solver : {Board::sequential, Board::simultaneous}) {
+    Board board = Board(1000);
+    board.SetSimulationMode(Board::frame_stepping);
+    board.SetContactSolver(solver);
+    board.CreatePoolBalls();
+    SECTION("soft break") {
+      board.HitCueBall(board.GetShotAngle(), Board::GetMinShotPower() * 2);
+      REQUIRE(RequireSameAsSteppingEveryBall(board) > 100);
+    }
+    SECTION("soft shot into the side of the rack") {
+      for (size_t i = 0; i < 10; i++) {
+        board.UpdateStickLeft();
+      }
+      board.HitCueBall(board.GetShotAngle(), Board::GetMinShotPower() * 2);
+      REQUIRE(RequireSameAsSteppingEveryBall(board) > 100);
+    }
+    SECTION("chain hit end on") {
+      board.SetPoolBalls(MakeChain(board, 5));
+      board.HitCueBall(M_PI, Board::GetMinShotPower());
+      RequireSameAsSteppingEveryBall(board);
+      // last ball of the chain was knocked away
+      REQUIRE(board.GetPoolBalls()[5].GetPosition().x >
+              MakeChain(board, 5)[5].GetPosition().x);
+    }
+  }
+}
+
+TEST_CASE("only moving balls are checked") {
+  Board board = Board(1000);
+  board.SetSimulationMode(Board::frame_stepping);
+  board.SetPoolBalls(MakeChain(board, 4));
+  board.HitCueBall(M_PI, Board::GetMinShotPower());
+  // every ball starts awake
+  board.AdvanceOneFrame();
+  REQUIRE(board.GetCandidatePairCount() == 10);
+  // then the chain sleeps and the cue ball has nothing to be checked with
+  // until it reaches the chain, which wakes together
+  board.AdvanceOneFrame();
+  REQUIRE(board.GetCandidatePairCount() == 0);
+  size_t frames = 0;
+  while (board.GetCandidatePairCount() == 0 && frames < 1000) {
+    board.AdvanceOneFrame();
+    frames += 1;
+  }
+  REQUIRE(frames > 1);
+  REQUIRE(board.GetCandidatePairCount() == 10);
+}
+
+TEST_CASE("fast ball wakes a sleeping ball it reaches in one frame") {
+  double diameter = Ball::GetDiameter();
+  for (Board::ContactSolver solver : {Board::sequential, Board::simultaneous}) {
+    Board board = Board(1000);
+    board.SetSimulationMode(Board::frame_stepping);
+    board.SetContactSolver(solver);
+    // the cue ball covers a ball and a half per frame, so it starts two
+    // grid cells away from the other ball and ends the first frame
+    // overlapping it
+    double y = board.GetTopYBoundary() + 200;
+    dvec2 target = {board.GetLeftXBoundary() + 400, y};
+    board.SetPoolBalls(
+        {Ball(0, Ball::cue, target - dvec2(2.2 * diameter, 0), {0, 0}),
+         Ball(1, Ball::solid, target, {0, 0})});
+    // resting balls fall asleep
+    board.AdvanceOneFrame();
+    board.HitCueBall(M_PI, 1.5 * diameter);
+    Board stepped = board;
+    board.AdvanceOneFrame();
+    REQUIRE(board.GetPoolBalls()[1].GetPosition() == target);
+    board.AdvanceOneFrame();
+    REQUIRE(board.GetPoolBalls()[1].GetPosition().x > target.x);
+    RequireSameAsSteppingEveryBall(stepped);
+  }
+}
+
+TEST_CASE("balls placed from outside wake up") {
+  Board board = Board(1000);
+  board.SetSimulationMode(Board::frame_stepping);
+  board.SetPoolBalls(MakeChain(board, 2));
+  // nothing is moving, every ball goes to sleep
+  board.AdvanceOneFrame();
+  board.AdvanceOneFrame();
+  REQUIRE(board.GetCandidatePairCount() == 0);
+  SECTION("cue ball dragged into a hole") {
+    board.SetCueBallPosition(
+        {board.GetLeftXBoundary(), board.GetTopYBoundary()});
+    board.AdvanceOneFrame();
+    REQUIRE(board.IsCueInHole());
+  }
+  SECTION("cue ball hit") {
+    dvec2 start = board.GetPoolBalls()[0].GetPosition();
+    // angle 0 hits it towards the left cushion, away from the chain
+    board.HitCueBall(0, Board::GetMinShotPower());
+    board.AdvanceOneFrame();
+    REQUIRE(board.GetPoolBalls()[0].GetPosition().x < start.x);
+  }
+}
@@ -0,0 +1,131 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+
+#include "board.h"
+using glm::dvec2;
+using pool::Ball;
+using pool::Board;
+using pool::SpatialGrid;
+using std::pair;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Grid pairs up touching balls and leaves out far away balls
+ * Balls off the board still get a cell
+ * Pairs come out in loop order
+ * Box query finds the balls in cells the box overlaps, including ones more
+ * than a cell away from its middle, and clamps boxes off the board
+ * Board with grid broad phase ends up in the same state as brute force
+ * after a break shot, while checking fewer pairs
+ */
+
+TEST_CASE("grid finds candidate pairs") {
+  Board board = Board(1000);
+  dvec2 top_left = {board.GetLeftXBoundary(), board.GetTopYBoundary()};
+  dvec2 bottom_right = {board.GetRightXBoundary(),
+                        board.GetBottomYBoundary()};
+  double diameter = Ball::GetDiameter();
+  SpatialGrid grid = SpatialGrid(top_left, bottom_right, diameter, 4);
+  vector<pair<size_t, size_t>> pairs;
+  SECTION("touching balls are paired") {
+    vector<Ball> balls = {
+        Ball(0, Ball::cue, {300, 400}, {0, 0}),
+        Ball(1, Ball::solid, {300 + diameter, 400}, {0, 0})};
+    grid.Build(balls);
+    grid.FindCandidatePairs(pairs);
+    REQUIRE(pairs.size() == 1);
+    REQUIRE(pairs[0] == std::make_pair<size_t, size_t>(0, 1));
+  }
+  SECTION("far away balls are not paired") {
+    vector<Ball> balls = {Ball(0, Ball::cue, {300, 400}, {0, 0}),
+                          Ball(1, Ball::solid, {600, 400}, {0, 0})};
+    grid.Build(balls);
+    grid.FindCandidatePairs(pairs);
+    REQUIRE(pairs.empty());
+  }
+  SECTION("balls off the board are put in edge cells") {
+    vector<Ball> balls = {Ball(0, Ball::cue, {-100, -100}, {0, 0}),
+                          Ball(1, Ball::solid, top_left, {0, 0})};
+    grid.Build(balls);
+    grid.FindCandidatePairs(pairs);
+    REQUIRE(pairs.size() == 1);
+  }
+  SECTION("pairs are in loop order") {
+    vector<Ball> balls = {Ball(0, Ball::cue, {300, 400}, {0, 0}),
+                          Ball(1, Ball::solid, {300, 400 + diameter}, {0, 0}),
+                          Ball(2, Ball::solid, {300 + diameter, 400}, {0, 0}),
+                          Ball(3, Ball::solid, {300, 400 - diameter}, {0, 0})};
+    grid.Build(balls);
+    grid.FindCandidatePairs(pairs);
+    for (size_t k = 1; k < pairs.size(); k++) {
+      REQUIRE(pairs[k - 1] < pairs[k]);
+    }
+  }
+}
+
+TEST_CASE("grid finds balls in a box") {
+  Board board = Board(1000);
+  dvec2 top_left = {board.GetLeftXBoundary(), board.GetTopYBoundary()};
+  dvec2 bottom_right = {board.GetRightXBoundary(),
+                        board.GetBottomYBoundary()};
+  double diameter = Ball::GetDiameter();
+  SpatialGrid grid = SpatialGrid(top_left, bottom_right, diameter, 4);
+  vector<Ball> balls = {
+      Ball(0, Ball::cue, {300, 400}, {0, 0}),
+      Ball(1, Ball::solid, {300 + 3 * diameter, 400}, {0, 0}),
+      Ball(2, Ball::solid, {600, 600}, {0, 0}),
+      Ball(3, Ball::solid, top_left, {0, 0})};
+  grid.Build(balls);
+  vector<size_t> found;
+  auto add_found = [&](size_t ball) { found.push_back(ball); };
+  SECTION("box over a few cells") {
+    dvec2 corner = {300 + diameter, 400 + diameter / 2};
+    grid.ForEachBallInBox({300, 400}, corner + dvec2(3 * diameter, 0),
+                          add_found);
+    std::sort(found.begin(), found.end());
+    REQUIRE(found == vector<size_t>({0, 1}));
+  }
+  SECTION("box with no balls") {
+    grid.ForEachBallInBox({450, 450}, {500, 500}, add_found);
+    REQUIRE(found.empty());
+  }
+  SECTION("box off the board") {
+    grid.ForEachBallInBox({-100, -100}, {0, 0}, add_found);
+    REQUIRE(found == vector<size_t>({3}));
+  }
+}
+
+TEST_CASE("grid broad phase matches brute force") {
+  Board brute_force_board = Board(1000);
+  Board grid_board = Board(1000);
+  // fixed_point mode checks every pair whatever the broad phase
+  brute_force_board.SetSimulationMode(Board::frame_stepping);
+  grid_board.SetSimulationMode(Board::frame_stepping);
+  grid_board.SetBroadPhase(Board::uniform_grid);
+  brute_force_board.CreatePoolBalls();
+  grid_board.CreatePoolBalls();
+  for (size_t i = 0; i < 4; i++) {
+    brute_force_board.PullStickBackForShot();
+    grid_board.PullStickBackForShot();
+  }
+  brute_force_board.HitCueBall();
+  grid_board.HitCueBall();
+  size_t brute_force_pairs = 0;
+  size_t grid_pairs = 0;
+  for (size_t frame = 0; frame < 200; frame++) {
+    brute_force_board.AdvanceOneFrame();
+    grid_board.AdvanceOneFrame();
+    brute_force_pairs += brute_force_board.GetCandidatePairCount();
+    grid_pairs += grid_board.GetCandidatePairCount();
+  }
+  vector<Ball> brute_force_balls = brute_force_board.GetPoolBalls();
+  vector<Ball> grid_balls = grid_board.GetPoolBalls();
+  REQUIRE(brute_force_balls.size() == grid_balls.size());
+  for (size_t i = 0; i < grid_balls.size(); i++) {
+    REQUIRE(grid_balls[i].GetPosition() == brute_force_balls[i].GetPosition());
+    REQUIRE(grid_balls[i].GetVelocity() == brute_force_balls[i].GetVelocity());
+  }
+  REQUIRE(grid_pairs < brute_force_pairs / 4);
+}
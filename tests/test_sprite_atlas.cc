@@ -0,0 +1,83 @@
+#include <catch2/catch.hpp>
+
+#include "sprite_atlas.h"
+using glm::ivec2;
+using glm::vec4;
+using pool::SpriteAtlas;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Empty atlas has no size
+ * Images of one size fill a square grid in order, padded on every side
+ * Images of different sizes get cells of the largest, none overlap
+ * Texture coordinates cover exactly the image's pixels
+ */
+
+namespace {
+/**
+ * Checks if two regions share a pixel.
+ */
+bool Overlap(const SpriteAtlas::Region &first,
+             const SpriteAtlas::Region &second) {
+  return first.position.x < second.position.x + second.size.x &&
+         second.position.x < first.position.x + first.size.x &&
+         first.position.y < second.position.y + second.size.y &&
+         second.position.y < first.position.y + first.size.y;
+}
+}  // namespace
+
+TEST_CASE("sprite atlas layout") {
+  SECTION("empty") {
+    SpriteAtlas atlas;
+    REQUIRE(atlas.GetImageCount() == 0);
+    REQUIRE(atlas.GetSize().x <= SpriteAtlas::kDefaultPadding);
+    REQUIRE(atlas.GetSize().y <= SpriteAtlas::kDefaultPadding);
+  }
+  SECTION("sixteen balls") {
+    SpriteAtlas atlas = SpriteAtlas(vector<ivec2>(16, ivec2(64, 64)), 2);
+    REQUIRE(atlas.GetImageCount() == 16);
+    // 4 by 4 cells of 64 pixels with 2 pixels before each and at the end
+    REQUIRE(atlas.GetSize() == ivec2(4 * 66 + 2, 4 * 66 + 2));
+    REQUIRE(atlas.GetRegion(0).position == ivec2(2, 2));
+    REQUIRE(atlas.GetRegion(1).position == ivec2(68, 2));
+    REQUIRE(atlas.GetRegion(4).position == ivec2(2, 68));
+    REQUIRE(atlas.GetRegion(15).position == ivec2(200, 200));
+    REQUIRE(atlas.GetRegion(15).size == ivec2(64, 64));
+  }
+  SECTION("different sizes") {
+    vector<ivec2> sizes = {{10, 40}, {30, 5}, {1, 1}, {25, 25}, {30, 40}};
+    SpriteAtlas atlas = SpriteAtlas(sizes, 3);
+    ivec2 size = atlas.GetSize();
+    for (size_t i = 0; i < sizes.size(); i++) {
+      const SpriteAtlas::Region &region = atlas.GetRegion(i);
+      REQUIRE(region.size == sizes[i]);
+      // padding to the edges of the atlas
+      REQUIRE(region.position.x >= 3);
+      REQUIRE(region.position.y >= 3);
+      REQUIRE(region.position.x + region.size.x <= size.x - 3);
+      REQUIRE(region.position.y + region.size.y <= size.y - 3);
+      for (size_t j = 0; j < i; j++) {
+        REQUIRE_FALSE(Overlap(region, atlas.GetRegion(j)));
+      }
+    }
+    // 3 columns in 2 rows of 30 by 40 cells
+    REQUIRE(size == ivec2(3 * 33 + 3, 2 * 43 + 3));
+  }
+}
+
+TEST_CASE("sprite atlas texture coordinates") {
+  SpriteAtlas atlas = SpriteAtlas({{64, 64}, {32, 16}}, 2);
+  // 2 columns of 66 pixels and one row
+  REQUIRE(atlas.GetSize() == ivec2(134, 68));
+  vec4 first = atlas.GetUvRect(0);
+  REQUIRE(first.x == Approx(2.0 / 134));
+  REQUIRE(first.y == Approx(2.0 / 68));
+  REQUIRE(first.z == Approx(66.0 / 134));
+  REQUIRE(first.w == Approx(66.0 / 68));
+  vec4 second = atlas.GetUvRect(1);
+  REQUIRE(second.x == Approx(68.0 / 134));
+  REQUIRE(second.y == Approx(2.0 / 68));
+  REQUIRE(second.z == Approx(100.0 / 134));
+  REQUIRE(second.w == Approx(18.0 / 68));
+}
@@ -0,0 +1,362 @@
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <fstream>
+
+#include "aim_preview.h"
+#include "board.h"
+#include "computer_player.h"
+#include "simulation_thread.h"
+#include "table_spec.h"
+using glm::dvec2;
+using pool::BasicAimPreview;
+using pool::BasicBoard;
+using pool::BasicComputerPlayer;
+using pool::BasicReplay;
+using pool::BasicReplayWriter;
+using pool::BasicSimulationThread;
+using pool::Ball;
+using pool::Board;
+using pool::BoardState;
+using pool::CaromTable;
+using pool::ClassicTable;
+using pool::EightFootTable;
+using pool::FixedTimestep;
+using pool::NineFootTable;
+using pool::SevenFootTable;
+using pool::SnookerTable;
+using std::vector;
+
+/**
+ * Testing strategy:
+ * Classic table keeps the board's outline, felt and pockets
+ * Pocket count and places come from the spec, corners of the felt and the
+ * middle of the long sides
+ * Longer tables keep the ball size and have real proportions
+ * Table geometry is in table units whatever the window, every table's
+ * outline fits the window once scaled by GetViewScale, which is 1 for the
+ * classic table
+ * A ball is in a pocket only while its center is closer than the pocket
+ * radius to the pocket's center
+ * Rack has every ball of the spec, each once, and none of them touch a
+ * cushion
+ * Carom table has nothing to pocket, a hard break leaves every ball on it
+ * Break on a 9 foot table comes to rest
+ * Snooker table racks all 21 object balls by type, they fit in a saved
+ * state and its break comes to rest in every simulation mode
+ * A table other than the classic one is simulated on its own thread,
+ * recorded, written, read back and played to the same balls, previewed and
+ * searched by the computer player
+ */
+
+namespace {
+/**
+ * Checks a table's outline fits a 1000 window with the board's view scale.
+ */
+template <typename Spec>
+void RequireFitsWindow() {
+  BasicBoard<Spec> board = BasicBoard<Spec>(1000);
+  double scale = board.GetViewScale();
+  REQUIRE(scale > 0);
+  REQUIRE(scale <= 1);
+  REQUIRE(board.GetOuterRectTopPosition().x * scale >= 0);
+  REQUIRE(board.GetOuterRectTopPosition().y * scale >= 0);
+  REQUIRE(board.GetOuterRectBottomPosition().x * scale <= 1000);
+  REQUIRE(board.GetOuterRectBottomPosition().y * scale <= 1000);
+}
+
+/**
+ * Runs a board until every ball stops.
+ */
+template <typename Spec>
+void RunUntilRest(BasicBoard<Spec> &board) {
+  size_t frames = 0;
+  while (!board.GetStickVisibility() && frames < 10000) {
+    board.AdvanceOneFrame();
+    frames += 1;
+  }
+}
+}  // namespace
+
+TEST_CASE("classic table") {
+  Board board = Board(1000);
+  REQUIRE(board.GetOuterRectTopPosition() == dvec2(50, 200));
+  REQUIRE(board.GetOuterRectBottomPosition() == dvec2(950, 800));
+  REQUIRE(board.GetLeftXBoundary() == 100);
+  REQUIRE(board.GetTopYBoundary() == 250);
+  REQUIRE(board.GetRightXBoundary() == 900);
+  REQUIRE(board.GetBottomYBoundary() == 750);
+  REQUIRE(board.GetHoleRadius() == 25);
+  REQUIRE(board.GetHolePositions().size() == 6);
+  REQUIRE(board.GetHolePositions()[0] == dvec2(100, 750));
+  REQUIRE(board.GetHolePositions()[2] == dvec2(900, 250));
+  REQUIRE(board.GetHolePositions()[4] == dvec2(500, 250));
+  REQUIRE(board.GetHolePositions()[5] == dvec2(500, 750));
+}
+
+TEST_CASE("pockets come from the spec") {
+  BasicBoard<NineFootTable> board = BasicBoard<NineFootTable>(1000);
+  const BasicBoard<NineFootTable>::HolePositions &holes =
+      board.GetHolePositions();
+  REQUIRE(holes.size() == NineFootTable::kNumPockets);
+  double left = board.GetLeftXBoundary();
+  double right = board.GetRightXBoundary();
+  double top = board.GetTopYBoundary();
+  double bottom = board.GetBottomYBoundary();
+  REQUIRE(holes[0] == dvec2(left, bottom));
+  REQUIRE(holes[1] == dvec2(left, top));
+  REQUIRE(holes[2] == dvec2(right, top));
+  REQUIRE(holes[3] == dvec2(right, bottom));
+  REQUIRE(holes[4] == dvec2((left + right) / 2, top));
+  REQUIRE(holes[5] == dvec2((left + right) / 2, bottom));
+  REQUIRE(BasicBoard<CaromTable>(1000).GetHolePositions().empty());
+}
+
+TEST_CASE("longer tables keep the ball size") {
+  BasicBoard<SevenFootTable> seven = BasicBoard<SevenFootTable>(1000);
+  BasicBoard<NineFootTable> nine = BasicBoard<NineFootTable>(1000);
+  double seven_length = seven.GetRightXBoundary() - seven.GetLeftXBoundary();
+  double nine_length = nine.GetRightXBoundary() - nine.GetLeftXBoundary();
+  // 78 and 100 inches with a 2.25 inch ball
+  REQUIRE(seven_length / Ball::GetDiameter() == Approx(78 / 2.25));
+  REQUIRE(nine_length / Ball::GetDiameter() == Approx(100 / 2.25));
+  // every table is twice as long as it is wide
+  REQUIRE(nine_length ==
+          Approx(2 * (nine.GetBottomYBoundary() - nine.GetTopYBoundary())));
+}
+
+TEST_CASE("every table fits the window") {
+  REQUIRE(Board(1000).GetViewScale() == 1);
+  RequireFitsWindow<ClassicTable>();
+  RequireFitsWindow<SevenFootTable>();
+  RequireFitsWindow<EightFootTable>();
+  RequireFitsWindow<NineFootTable>();
+  RequireFitsWindow<SnookerTable>();
+  RequireFitsWindow<CaromTable>();
+  // the table stays the same in table units, only the scale changes
+  Board small = Board(500);
+  REQUIRE(small.GetOuterRectBottomPosition() ==
+          Board(1000).GetOuterRectBottomPosition());
+  REQUIRE(small.GetViewScale() < 1);
+  REQUIRE(small.GetOuterRectBottomPosition().x * small.GetViewScale() <= 500);
+}
+
+TEST_CASE("ball in pocket") {
+  Board board = Board(1000);
+  double radius = Ball::GetDiameter() / 2;
+  dvec2 hole = board.GetHolePositions()[4];
+  double hole_radius = board.GetHoleRadius();
+  // positions are top left corners, centers are a radius further
+  dvec2 corner = hole - dvec2(radius, radius);
+  REQUIRE(board.CheckIfInHole(Ball(1, Ball::solid, corner, {0, 0})));
+  REQUIRE(board.CheckIfInHole(
+      Ball(1, Ball::solid, corner + dvec2(0, hole_radius - 0.01), {0, 0})));
+  REQUIRE_FALSE(board.CheckIfInHole(
+      Ball(1, Ball::solid, corner + dvec2(0, hole_radius), {0, 0})));
+  REQUIRE_FALSE(board.CheckIfInHole(
+      Ball(1, Ball::solid, corner + dvec2(hole_radius, hole_radius) * 0.75,
+           {0, 0})));
+  REQUIRE_FALSE(BasicBoard<CaromTable>(1000).CheckIfInHole(
+      Ball(1, Ball::solid, corner, {0, 0})));
+}
+
+TEST_CASE("rack has the spec's balls") {
+  SECTION("9 foot table") {
+    BasicBoard<NineFootTable> board = BasicBoard<NineFootTable>(1000);
+    board.CreatePoolBalls();
+    const vector<Ball> &balls = board.GetPoolBalls();
+    REQUIRE(balls.size() == NineFootTable::kNumberOfBalls + 1);
+    // every number once
+    vector<bool> seen(balls.size(), false);
+    for (const Ball &ball : balls) {
+      REQUIRE(ball.GetBallNumber() < balls.size());
+      REQUIRE_FALSE(seen[ball.GetBallNumber()]);
+      seen[ball.GetBallNumber()] = true;
+    }
+    double radius = Ball::GetDiameter() / 2;
+    for (const Ball &ball : balls) {
+      dvec2 position = ball.GetPosition();
+      REQUIRE(position.x - radius > board.GetLeftXBoundary());
+      REQUIRE(position.x + radius < board.GetRightXBoundary());
+      REQUIRE(position.y - radius > board.GetTopYBoundary());
+      REQUIRE(position.y + radius < board.GetBottomYBoundary());
+    }
+  }
+  SECTION("carom table") {
+    BasicBoard<CaromTable> board = BasicBoard<CaromTable>(1000);
+    board.CreatePoolBalls();
+    const vector<Ball> &balls = board.GetPoolBalls();
+    REQUIRE(balls.size() == 3);
+    REQUIRE(balls[1].GetBallType() == Ball::solid);
+    REQUIRE(balls[2].GetBallType() == Ball::eight);
+    // short rack, the second column only has the eight ball
+    REQUIRE(balls[2].GetPosition().x > balls[1].GetPosition().x);
+  }
+}
+
+TEST_CASE("carom table keeps every ball") {
+  BasicBoard<CaromTable> board = BasicBoard<CaromTable>(1000);
+  board.CreatePoolBalls();
+  board.HitCueBall(board.GetShotAngle(),
+                   BasicBoard<CaromTable>::GetMaxShotPower());
+  RunUntilRest(board);
+  REQUIRE(board.GetStickVisibility());
+  REQUIRE(board.GetPoolBalls().size() == 3);
+  REQUIRE_FALSE(board.IsCueInHole());
+  REQUIRE(board.GetPlayerState() == pool::Player::playing);
+}
+
+TEST_CASE("9 foot table break") {
+  BasicBoard<NineFootTable> board = BasicBoard<NineFootTable>(1000);
+  board.CreatePoolBalls();
+  board.HitCueBall(board.GetShotAngle(),
+                   BasicBoard<NineFootTable>::GetMaxShotPower());
+  RunUntilRest(board);
+  REQUIRE(board.GetStickVisibility());
+  for (const Ball &ball : board.GetPoolBalls()) {
+    dvec2 position = ball.GetPosition();
+    REQUIRE(position.x >= board.GetLeftXBoundary());
+    REQUIRE(position.x <= board.GetRightXBoundary());
+    REQUIRE(position.y >= board.GetTopYBoundary());
+    REQUIRE(position.y <= board.GetBottomYBoundary());
+  }
+}
+
+TEST_CASE("snooker table") {
+  typedef BasicBoard<SnookerTable> SnookerBoard;
+  SnookerBoard board = SnookerBoard(1000);
+  board.CreatePoolBalls();
+  const vector<Ball> &balls = board.GetPoolBalls();
+  REQUIRE(balls.size() == 22);
+  SECTION("rack") {
+    double length = board.GetRightXBoundary() - board.GetLeftXBoundary();
+    REQUIRE(length / Ball::GetDiameter() == Approx(140 / 2.0625));
+    vector<bool> seen(balls.size(), false);
+    for (const Ball &ball : balls) {
+      size_t number = ball.GetBallNumber();
+      REQUIRE(number < balls.size());
+      REQUIRE_FALSE(seen[number]);
+      seen[number] = true;
+      if (number == 0) {
+        REQUIRE(ball.GetBallType() == Ball::cue);
+      } else if (number <= 10) {
+        REQUIRE(ball.GetBallType() == Ball::solid);
+      } else if (number == 11) {
+        REQUIRE(ball.GetBallType() == Ball::eight);
+      } else {
+        REQUIRE(ball.GetBallType() == Ball::striped);
+      }
+    }
+    // none of the 21 overlap
+    for (size_t i = 0; i < balls.size(); i++) {
+      for (size_t j = i + 1; j < balls.size(); j++) {
+        double distance =
+            glm::distance(balls[i].GetPosition(), balls[j].GetPosition());
+        REQUIRE(distance >= Ball::GetDiameter() - 1e-9);
+      }
+    }
+  }
+  SECTION("save and restore") {
+    BoardState state = board.Save();
+    REQUIRE(state.num_balls == 22);
+    SnookerBoard restored = SnookerBoard(1000);
+    restored.Restore(state);
+    REQUIRE(restored.GetPoolBalls().size() == 22);
+    for (size_t i = 0; i < balls.size(); i++) {
+      REQUIRE(restored.GetPoolBalls()[i].GetBallNumber() ==
+              balls[i].GetBallNumber());
+      REQUIRE(restored.GetPoolBalls()[i].GetPosition() ==
+              balls[i].GetPosition());
+    }
+  }
+  SECTION("break") {
+    SnookerBoard::SimulationMode modes[] = {SnookerBoard::frame_stepping,
+                                            SnookerBoard::event_driven,
+                                            SnookerBoard::fixed_point};
+    for (SnookerBoard::SimulationMode mode : modes) {
+      SnookerBoard played = board;
+      played.SetSimulationMode(mode);
+      played.HitCueBall(played.GetShotAngle(), SnookerBoard::GetMaxShotPower());
+      RunUntilRest(played);
+      INFO("mode " << mode);
+      REQUIRE(played.GetStickVisibility());
+      for (const Ball &ball : played.GetPoolBalls()) {
+        REQUIRE(ball.GetVelocity() == dvec2(0, 0));
+        REQUIRE(ball.GetPosition().x >= played.GetLeftXBoundary());
+        REQUIRE(ball.GetPosition().x <= played.GetRightXBoundary());
+        REQUIRE(ball.GetPosition().y >= played.GetTopYBoundary());
+        REQUIRE(ball.GetPosition().y <= played.GetBottomYBoundary());
+      }
+    }
+  }
+}
+
+TEST_CASE("other tables go through every consumer") {
+  typedef BasicBoard<SnookerTable> SnookerBoard;
+  typedef BasicSimulationThread<SnookerTable> SnookerThread;
+  SnookerBoard board = SnookerBoard(1000);
+  board.CreatePoolBalls();
+  SECTION("recorded and played back") {
+    BasicReplayWriter<SnookerTable> writer("test_table_spec_game_");
+    writer.Start();
+    board.SetSimulationMode(SnookerBoard::event_driven);
+    FixedTimestep timestep = FixedTimestep(60, 8);
+    SnookerThread simulation(board, timestep);
+    simulation.SetReplayWriter(&writer);
+    simulation.SetKeyframeInterval(50);
+    simulation.Send(SnookerThread::reset);
+    simulation.RunOnce(0);
+    simulation.SendShot(board.GetShotAngle(), SnookerBoard::GetMaxShotPower());
+    bool stopped = false;
+    for (size_t i = 0; i < 10000 && !stopped; i++) {
+      simulation.RunOnce(timestep.GetStepSeconds());
+      stopped = simulation.GetLatestSnapshot().board.GetStickVisibility();
+    }
+    REQUIRE(stopped);
+    SnookerBoard played = simulation.GetLatestSnapshot().board;
+    writer.Stop();
+
+    std::ifstream file(writer.GetPath(0), std::ios::binary);
+    BasicReplay<SnookerTable> replay;
+    REQUIRE(replay.Read(file));
+    REQUIRE(replay.GetInitialBalls().size() == 22);
+    REQUIRE_FALSE(replay.GetKeyframes().empty());
+    SnookerBoard replayed = SnookerBoard(1000);
+    replay.Play(replayed);
+    REQUIRE(replayed.GetSimulationMode() == SnookerBoard::event_driven);
+    REQUIRE(replayed.GetPoolBalls().size() == played.GetPoolBalls().size());
+    for (size_t i = 0; i < played.GetPoolBalls().size(); i++) {
+      REQUIRE(replayed.GetPoolBalls()[i].GetBallNumber() ==
+              played.GetPoolBalls()[i].GetBallNumber());
+      REQUIRE(replayed.GetPoolBalls()[i].GetPosition() ==
+              played.GetPoolBalls()[i].GetPosition());
+    }
+    std::remove(writer.GetPath(0).c_str());
+  }
+  SECTION("previewed") {
+    // stick starts aimed at the apex of the rack
+    BasicAimPreview<SnookerTable> preview;
+    board.PullStickBackForShot();
+    const BasicAimPreview<SnookerTable>::Path &path = preview.Update(board);
+    REQUIRE(path.hits_ball);
+    REQUIRE(path.object_ball_number == SnookerTable::kRackOrder[0]);
+  }
+  SECTION("searched by the computer player") {
+    BasicComputerPlayer<SnookerTable>::Settings settings =
+        BasicComputerPlayer<SnookerTable>::GetDifficultySettings(
+            BasicComputerPlayer<SnookerTable>::easy);
+    settings.num_angles = 8;
+    settings.num_powers = 2;
+    settings.samples_per_shot = 1;
+    settings.time_budget_seconds = 60;
+    settings.num_threads = 2;
+    BasicComputerPlayer<SnookerTable> player(settings, 1);
+    BasicComputerPlayer<SnookerTable>::Shot shot = player.ChooseShot(board);
+    REQUIRE(shot.candidates_tried == 16);
+    REQUIRE(shot.power >= SnookerBoard::GetMinShotPower());
+    REQUIRE(shot.power <= SnookerBoard::GetMaxShotPower());
+    // the board isn't changed
+    REQUIRE(board.GetPoolBalls().size() == 22);
+    REQUIRE(board.GetStickVisibility());
+  }
+}